@@ -0,0 +1,103 @@
+// Packs a set of HUD icon sized images with buildAtlas and reports how full the pages
+// are and how many texture binds a frame of sprites takes with and without the atlas.
+// usage: bench_atlas [image count] [page size] [padding] [sprites per frame]
+//
+// Every image is checked to sit inside its page, clear of all the others and their padding.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "../common/atlaspacker.h"
+#include "benchmark.h"
+
+static unsigned int Seed = 12345;
+
+static int randomInt(int lo, int hi)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return lo + (int)((Seed >> 16) % (unsigned int)(hi - lo + 1));
+}
+
+static bool check(const AtlasLayout& layout, int padding)
+{
+	for(size_t i = 0; i < layout.Regions.size(); i++)
+	{
+		const AtlasRegion& a = layout.Regions[i];
+		const AtlasPage& page = layout.Pages[a.Page];
+		if(a.X - padding < 0 || a.Y - padding < 0 || a.X + a.Width + padding > page.Width || a.Y + a.Height + padding > page.Height)
+		{
+			printf("  %s is off its page\n", a.Name.c_str());
+			return false;
+		}
+		for(size_t j = i + 1; j < layout.Regions.size(); j++)
+		{
+			const AtlasRegion& b = layout.Regions[j];
+			if(a.Page == b.Page
+				&& a.X - padding < b.X + b.Width + padding && b.X - padding < a.X + a.Width + padding
+				&& a.Y - padding < b.Y + b.Height + padding && b.Y - padding < a.Y + a.Height + padding)
+			{
+				printf("  %s and %s overlap\n", a.Name.c_str(), b.Name.c_str());
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Texture changes drawing the sprites in order, when each image is its own texture or
+// when it is on an atlas page
+static void countBinds(const AtlasLayout& layout, int sprites)
+{
+	std::vector<unsigned int> draws(sprites);
+	for(int i = 0; i < sprites; i++)
+		draws[i] = randomInt(0, (int)layout.Regions.size() - 1);
+
+	int separate = 0, atlas = 0;
+	for(int i = 0; i < sprites; i++)
+	{
+		separate += i == 0 || draws[i] != draws[i - 1];
+		atlas += i == 0 || layout.Regions[ draws[i] ].Page != layout.Regions[ draws[i - 1] ].Page;
+	}
+	printf("  %d sprites: %d binds as separate textures, %d on the atlas in draw order, %u sorted by page\n",
+		sprites, separate, atlas, (unsigned)layout.Pages.size());
+}
+
+int main(int argc, const char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 500;
+	int pageSize = argc > 2 ? atoi(argv[2]) : 1024;
+	int padding = argc > 3 ? atoi(argv[3]) : 2;
+	int sprites = argc > 4 ? atoi(argv[4]) : 2000;
+
+	// icons 16 to 96 pixels a side, a few long thin bars among them
+	std::vector<std::vector<unsigned char> > pixels(count);
+	std::vector<AtlasSource> sources(count);
+	for(int i = 0; i < count; i++)
+	{
+		AtlasSource& s = sources[i];
+		char name[32];
+		snprintf(name, sizeof(name), "icon%d", i);
+		s.Name = name;
+		s.Width = randomInt(16, 96);
+		s.Height = i % 10 == 0 ? randomInt(4, 12) : randomInt(16, 96);
+		pixels[i].assign(s.Width * s.Height * 4, (unsigned char)i);
+		s.Pixels = &pixels[i][0];
+	}
+
+	AtlasLayout layout;
+	double t = now();
+	bool ok = buildAtlas(sources, pageSize, padding, layout);
+	t = now() - t;
+	if(!ok)
+		return 1;
+
+	printf("%d images into %dx%d pages with %d pixels padding, packed in %.1f ms\n", count, pageSize, pageSize, padding, t * 1000.0);
+	printAtlasReport(layout);
+	countBinds(layout, sprites);
+
+	ok = check(layout, padding);
+	printf("  %s\n", ok ? "check passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
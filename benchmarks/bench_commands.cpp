@@ -0,0 +1,223 @@
+// Frame time for a grid of models whose matrices are worked out every frame: all on the
+// GL thread, against a second thread recording frame N+1 into a CommandQueue while the GL
+// thread executes frame N.
+// usage: bench_commands [models] [frames]
+//
+// Each model gets the CPU side of tutorial08's PRECOMPUTED_MV variant: its model matrix,
+// MV, MVP and the inverse transpose normal matrix. The swap is in the frame time, keep the
+// frames slower than the display or both come out at its refresh.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+
+#include "../common/startScreen.h"
+#include "../common/LoadShaders.h"
+#include "../common/meshfile.h"
+#include "../common/meshloader.h"
+#include "../common/rendercommands.h"
+#include "../common/glstate.h"
+#include "variant_shaders.h"
+#include "benchmark.h"
+
+struct Scene
+{
+	int Models;
+	MeshBuffers Mesh;
+	VertexLayout Layout;
+	GfxProgram* Program;
+	GLuint Texture;
+	glm::mat4 Projection, View;
+	int MVP, MV, NormalMatrix, LightCamera, Sampler;
+};
+
+// One model's uniforms and draw, through whatever records or issues them
+template<class Target>
+static void drawModel(const Scene& s, Target& target, ProgramReflection* uniforms, int i, int frame)
+{
+	int side = (int)sqrt((double)s.Models) + 1;
+	glm::vec3 position(2.5f * (i % side - side / 2), 2.5f * (i / side - side / 2), -4.0f * side);
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), position) * glm::eulerAngleYXZ(0.01f * (frame + i), 0.0f, 0.0f);
+	glm::mat4 mv = s.View * model;
+	glm::mat4 mvp = s.Projection * mv;
+	glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(mv)));
+	target.SetMat4(uniforms, s.MVP, &mvp[0][0]);
+	target.SetMat4(uniforms, s.MV, &mv[0][0]);
+	target.SetMat3(uniforms, s.NormalMatrix, &normal[0][0]);
+	target.DrawElements(GL_TRIANGLES, s.Mesh.IndexCount, GL_UNSIGNED_SHORT, 0);
+}
+
+// Same calls as CommandBuffer, made on the spot
+struct Immediate
+{
+	void SetMat3(ProgramReflection* p, int u, const GLfloat* m) { p->SetMat3(u, m); }
+	void SetMat4(ProgramReflection* p, int u, const GLfloat* m) { p->SetMat4(u, m); }
+	void DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset)
+	{
+		glDrawElements(mode, count, type, (const void*)offset);
+	}
+};
+
+static void setup(Scene& s, ProgramReflection* uniforms, CommandBuffer* commands)
+{
+	glm::vec4 light = s.View * glm::vec4(4, 4, 4, 1);
+	if(commands)
+	{
+		commands->Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		commands->UseProgram(s.Program->GetId());
+		commands->EnableLayout(&s.Layout, s.Mesh.VertexBuffer);
+		commands->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.Mesh.ElementBuffer);
+		commands->BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, s.Texture);
+		commands->SetInt(uniforms, s.Sampler, 0);
+		commands->SetVec3(uniforms, s.LightCamera, light.x, light.y, light.z);
+		return;
+	}
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	GGLState.UseProgram(s.Program->GetId());
+	s.Layout.Enable(s.Mesh.VertexBuffer);
+	GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.Mesh.ElementBuffer);
+	GGLState.ActiveTexture(GL_TEXTURE0);
+	GGLState.BindTexture(GL_TEXTURE_2D, s.Texture);
+	uniforms->SetInt(s.Sampler, 0);
+	uniforms->SetVec3(s.LightCamera, light.x, light.y, light.z);
+}
+
+struct Recorder
+{
+	Scene* S;
+	CommandQueue* Queue;
+	int Frames;
+	double Time;           // spent recording
+	size_t Bytes;          // largest frame
+	unsigned int Commands;
+	unsigned int Grows;
+};
+
+static void* recordFrames(void* arg)
+{
+	Recorder* r = (Recorder*)arg;
+	ProgramReflection* uniforms = &r->S->Program->GetReflection();
+	for(int f = 0; f < r->Frames; f++)
+	{
+		CommandBuffer* commands = r->Queue->BeginRecord();
+		if(!commands)
+			break;
+		double start = now();
+		setup(*r->S, uniforms, commands);
+		for(int i = 0; i < r->S->Models; i++)
+			drawModel(*r->S, *commands, uniforms, i, f);
+		r->Time += now() - start;
+		if(commands->GetUsed() > r->Bytes)
+		{
+			r->Bytes = commands->GetUsed();
+			r->Commands = commands->GetCount();
+		}
+		r->Grows += commands->Grows;
+		commands->Grows = 0;
+		r->Queue->EndRecord();
+	}
+	r->Queue->Stop();
+	return NULL;
+}
+
+int main(int argc, const char **argv)
+{
+	int models = argc > 1 ? atoi(argv[1]) : 1000;
+	int frames = argc > 2 ? atoi(argv[2]) : 200;
+
+	InitGraphics();
+
+	Scene s;
+	s.Models = models;
+	const char* synthetic = "synthetic_sphere.obj";
+	if(!writeSphere(synthetic, 200) || !loadMeshBuffers(synthetic, s.Mesh))
+	{
+		printf("Could not make %s\n", synthetic);
+		return 1;
+	}
+	remove(synthetic);
+	remove(meshCachePath(synthetic).c_str());
+
+	ShaderVariants shaders;
+	unsigned int precomputedMV = shaders.AddFeature("PRECOMPUTED_MV");
+	shaders.Load(GEmbeddedShaders, "TransformVertexShader.glsl", "TextureFragmentShader.glsl");
+	s.Program = shaders.Get(precomputedMV);
+	if(!s.Program)
+		return 1;
+	ProgramReflection* uniforms = &s.Program->GetReflection();
+	s.MVP = uniforms->FindUniform("MVP");
+	s.MV = uniforms->FindUniform("MV");
+	s.NormalMatrix = uniforms->FindUniform("NormalMatrix");
+	s.LightCamera = uniforms->FindUniform("LightPosition_cameraspace");
+	s.Sampler = uniforms->FindUniform("myTextureSampler");
+	describeMeshVertex(s.Layout, "vertexPosition_modelspace", "vertexUV", "vertexNormal_modelspace");
+	s.Layout.Bind(s.Program->GetId());
+	s.Projection = glm::perspective(45.0f, (float)GScreenWidth / GScreenHeight, 0.1f, 1000.0f);
+	s.View = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+
+	static const unsigned char white[4] = { 255, 255, 255, 255 };
+	glGenTextures(1, &s.Texture);
+	GGLState.BindTexture(GL_TEXTURE_2D, s.Texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	GGLState.Enable(GL_DEPTH_TEST);
+
+	// everything on the GL thread
+	Immediate immediate;
+	double start = now();
+	for(int f = 0; f < frames; f++)
+	{
+		setup(s, uniforms, NULL);
+		for(int i = 0; i < models; i++)
+			drawModel(s, immediate, uniforms, i, f);
+		updateScreen();
+	}
+	glFinish();
+	double inlineTime = now() - start;
+
+	// recorded one frame ahead on another thread
+	CommandQueue queue;
+	Recorder recorder;
+	recorder.S = &s;
+	recorder.Queue = &queue;
+	recorder.Frames = frames;
+	recorder.Time = 0.0;
+	recorder.Bytes = 0;
+	recorder.Commands = 0;
+	recorder.Grows = 0;
+	double executeTime = 0.0;
+	start = now();
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, recordFrames, &recorder) != 0)
+	{
+		printf("Could not start the recording thread\n");
+		return 1;
+	}
+	while(CommandBuffer* commands = queue.BeginExecute())
+	{
+		double executeStart = now();
+		commands->Execute();
+		executeTime += now() - executeStart;
+		queue.EndExecute();
+		updateScreen();
+	}
+	glFinish();
+	double deferredTime = now() - start;
+	pthread_join(thread, NULL);
+
+	printf("\n%d models of %d triangles x %d frames:\n", models, s.Mesh.IndexCount / 3, frames);
+	printf("  on the GL thread       %5.2f ms per frame\n", inlineTime * 1000.0 / frames);
+	printf("  recorded a frame ahead %5.2f ms per frame, recording %.2f ms and executing %.2f ms of it\n",
+		deferredTime * 1000.0 / frames, recorder.Time * 1000.0 / frames, executeTime * 1000.0 / frames);
+	printf("  %u commands, %lu bytes per frame, the buffers grew %u times\n",
+		recorder.Commands, (unsigned long)recorder.Bytes, recorder.Grows);
+
+	GGLState.DeleteTextures(1, &s.Texture);
+	deleteMeshBuffers(s.Mesh);
+	shaders.Release();
+	return 0;
+}
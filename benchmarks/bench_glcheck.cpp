@@ -0,0 +1,146 @@
+// CPU time per frame spent in check(): a frame of textured quads with glGetError after
+// each GL call, as GL_CHECK_MODE 2 (and the assert before it) does, against the sampled
+// mode that checks one frame in GL_CHECK_INTERVAL and no checks at all.
+// usage: bench_glcheck [draws per frame] [frames]
+//
+// The times cover issuing the calls, glFinish is left out of them, so a glGetError that
+// waits for the driver shows up here and not in the GPU's time.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../common/startScreen.h"
+#include "../common/programreflect.h"
+#include "../common/glstate.h"
+#include "../common/glcheck.h"
+#include "benchmark.h"
+
+static const char* GVertexSource =
+	"attribute vec4 vertex;\n"
+	"uniform vec2 offset;\n"
+	"varying vec2 tcoord;\n"
+	"void main(void)\n"
+	"{\n"
+	"	tcoord = vertex.xy;\n"
+	"	gl_Position = vec4(vertex.xy * 0.02 + offset, vertex.zw);\n"
+	"}\n";
+
+static const char* GFragmentSource =
+	"varying mediump vec2 tcoord;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_FragColor = texture2D(tex, tcoord);\n"
+	"}\n";
+
+enum CheckMode
+{
+	CHECK_EVERY_CALL,
+	CHECK_SAMPLED,
+	CHECK_NONE
+};
+
+static GLuint compile(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+// what check() expands to in each mode
+static void checkAfter(CheckMode mode, int line)
+{
+	if(mode == CHECK_EVERY_CALL)
+		GGLCheck.Check(__FILE__, line, NULL);
+	else if(mode == CHECK_SAMPLED && GGLCheck.Sampling)
+		GGLCheck.Check(__FILE__, line, NULL);
+}
+
+static void drawFrame(CheckMode mode, int draws, GLuint buffer, GLuint texture, GLint vertex, ProgramReflection& reflection,
+	int offset)
+{
+	for(int i = 0; i < draws; i++)
+	{
+		// four checks per draw, DrawYUVTextureRect makes nine
+		reflection.SetVec2(offset, -1.0f + 2.0f * (i % 50) / 50, -1.0f + 2.0f * (i / 50 % 50) / 50);
+		checkAfter(mode, __LINE__);
+		GGLState.BindBuffer(GL_ARRAY_BUFFER, buffer);
+		GGLState.BindTexture(GL_TEXTURE_2D, texture);
+		checkAfter(mode, __LINE__);
+		glVertexAttribPointer(vertex, 4, GL_FLOAT, 0, 16, 0);
+		checkAfter(mode, __LINE__);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		checkAfter(mode, __LINE__);
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	int draws = argc > 1 ? atoi(argv[1]) : 200;
+	int frames = argc > 2 ? atoi(argv[2]) : 240;
+
+	InitGraphics();
+	GLuint program = glCreateProgram();
+	glAttachShader(program, compile(GL_VERTEX_SHADER, GVertexSource));
+	glAttachShader(program, compile(GL_FRAGMENT_SHADER, GFragmentSource));
+	glLinkProgram(program);
+	GLint linked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if(!linked)
+	{
+		printf("Could not link the benchmark program\n");
+		return 1;
+	}
+
+	static const GLfloat quad[] = { 0,0,1,1, 1,0,1,1, 0,1,1,1, 1,1,1,1 };
+	GLuint buffer, texture;
+	glGenBuffers(1, &buffer);
+	GGLState.BindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	static const unsigned char white[4] = { 255, 255, 255, 255 };
+	glGenTextures(1, &texture);
+	GGLState.BindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+	ProgramReflection reflection;
+	reflection.Reflect(program);
+	GLint vertex = reflection.FindAttrib("vertex");
+	int offset = reflection.FindUniform("offset");
+	GGLState.UseProgram(program);
+	reflection.SetInt(reflection.FindUniform("tex"), 0);
+	GGLState.EnableVertexAttribArray(vertex);
+
+	// the modes take turns frame by frame so they see the same clocks and temperature
+	const char* names[3] = { "every call", "sampled", "none" };
+	double times[3] = { 0.0, 0.0, 0.0 };
+	unsigned long long checks[3] = { 0, 0, 0 };
+	for(int f = 0; f < frames; f++)
+	{
+		for(int mode = 0; mode < 3; mode++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT);
+			unsigned long long before = GGLCheck.Checks;
+			double start = now();
+			drawFrame((CheckMode)mode, draws, buffer, texture, vertex, reflection, offset);
+			times[mode] += now() - start;
+			checks[mode] += GGLCheck.Checks - before;
+			glFinish();
+		}
+		updateScreen();
+	}
+
+	printf("\n%d draws, %d checks per frame x %d frames, sampled checks 1 frame in %u:\n",
+		draws, draws * 4, frames, GGLCheck.Interval);
+	for(int mode = 0; mode < 3; mode++)
+		printf("  %-10s  %7.3f ms per frame, %7.1f glGetError per frame, %6.3f ms saved against every call\n",
+			names[mode], times[mode] * 1000.0 / frames, (double)checks[mode] / frames,
+			(times[0] - times[mode]) * 1000.0 / frames);
+	if(checks[0])
+		printf("  one glGetError costs %.2f us\n", (times[0] - times[2]) * 1e6 / checks[0]);
+
+	GGLState.DeleteTextures(1, &texture);
+	GGLState.DeleteBuffers(1, &buffer);
+	GGLState.DeleteProgram(program);
+	return 0;
+}
@@ -0,0 +1,168 @@
+// CPU time per textured quad, with the state calls DrawTextureRect made before the state
+// cache (program, buffer and texture bound, blending toggled and everything unbound again
+// on every draw) against the same draws through GGLState.
+// usage: bench_glstate [draws per frame] [frames]
+//
+// Every quad uses the same program and texture, as a row of sprites from one atlas does.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../common/startScreen.h"
+#include "../common/programreflect.h"
+#include "../common/glstate.h"
+#include "benchmark.h"
+
+static const char* GVertexSource =
+	"attribute vec4 vertex;\n"
+	"uniform vec2 offset;\n"
+	"uniform vec2 scale;\n"
+	"varying vec2 tcoord;\n"
+	"void main(void)\n"
+	"{\n"
+	"	tcoord = vertex.xy;\n"
+	"	gl_Position = vec4(vertex.xy * scale + offset, vertex.zw);\n"
+	"}\n";
+
+static const char* GFragmentSource =
+	"varying mediump vec2 tcoord;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_FragColor = texture2D(tex, tcoord);\n"
+	"}\n";
+
+struct Quad
+{
+	GLuint Program;
+	GLuint Buffer;
+	GLuint Texture;
+	GLint Vertex;
+	int Offset;
+	ProgramReflection* Reflection;
+};
+
+static GLuint compile(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+static void quadOffset(int i, int draws, float& x, float& y)
+{
+	int side = (int)sqrt((double)draws) + 1;
+	x = -1.0f + 2.0f * (i % side) / side;
+	y = -1.0f + 2.0f * (i / side) / side;
+}
+
+// DrawTextureRect before the state cache
+static void drawDirect(Quad& q, int draws)
+{
+	for(int i = 0; i < draws; i++)
+	{
+		float x, y;
+		quadOffset(i, draws, x, y);
+		glUseProgram(q.Program);
+		q.Reflection->SetVec2(q.Offset, x, y);
+		glBindBuffer(GL_ARRAY_BUFFER, q.Buffer);
+		glBindTexture(GL_TEXTURE_2D, q.Texture);
+		glVertexAttribPointer(q.Vertex, 4, GL_FLOAT, 0, 16, 0);
+		glEnableVertexAttribArray(q.Vertex);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		glDisable(GL_BLEND);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+}
+
+// and now
+static void drawCached(Quad& q, int draws)
+{
+	for(int i = 0; i < draws; i++)
+	{
+		float x, y;
+		quadOffset(i, draws, x, y);
+		GGLState.UseProgram(q.Program);
+		q.Reflection->SetVec2(q.Offset, x, y);
+		GGLState.BindBuffer(GL_ARRAY_BUFFER, q.Buffer);
+		GGLState.ActiveTexture(GL_TEXTURE0);
+		GGLState.BindTexture(GL_TEXTURE_2D, q.Texture);
+		glVertexAttribPointer(q.Vertex, 4, GL_FLOAT, 0, 16, 0);
+		GGLState.EnableVertexAttribArray(q.Vertex);
+		GGLState.Enable(GL_BLEND);
+		GGLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	int draws = argc > 1 ? atoi(argv[1]) : 1000;
+	int frames = argc > 2 ? atoi(argv[2]) : 60;
+
+	InitGraphics();
+	Quad q;
+	q.Program = glCreateProgram();
+	glAttachShader(q.Program, compile(GL_VERTEX_SHADER, GVertexSource));
+	glAttachShader(q.Program, compile(GL_FRAGMENT_SHADER, GFragmentSource));
+	glLinkProgram(q.Program);
+	GLint linked = 0;
+	glGetProgramiv(q.Program, GL_LINK_STATUS, &linked);
+	if(!linked)
+	{
+		printf("Could not link the benchmark program\n");
+		return 1;
+	}
+
+	static const GLfloat quad[] = { 0,0,1,1, 1,0,1,1, 0,1,1,1, 1,1,1,1 };
+	glGenBuffers(1, &q.Buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, q.Buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	static const unsigned char white[4] = { 255, 255, 255, 255 };
+	glGenTextures(1, &q.Texture);
+	glBindTexture(GL_TEXTURE_2D, q.Texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+	ProgramReflection reflection;
+	reflection.Reflect(q.Program);
+	q.Reflection = &reflection;
+	q.Offset = reflection.FindUniform("offset");
+	q.Vertex = reflection.FindAttrib("vertex");
+	glUseProgram(q.Program);
+	reflection.SetVec2(reflection.FindUniform("scale"), 0.02f, 0.02f);
+	reflection.SetInt(reflection.FindUniform("tex"), 0);
+
+	double direct = 0.0, cached = 0.0;
+	unsigned long long issued = 0, elided = 0;
+	for(int f = 0; f < frames; f++)
+	{
+		// alternate so both see the same driver state and thermal conditions
+		glClear(GL_COLOR_BUFFER_BIT);
+		double start = now();
+		drawDirect(q, draws);
+		direct += now() - start;
+		glFinish();
+
+		// the direct path went around the cache
+		GGLState.Invalidate();
+		GGLState.BeginFrame();
+		start = now();
+		drawCached(q, draws);
+		cached += now() - start;
+		glFinish();
+		issued += GGLState.Issued;
+		elided += GGLState.Elided;
+		updateScreen();
+	}
+
+	double calls = (double)draws * frames;
+	printf("\n%d draws x %d frames:\n", draws, frames);
+	printf("  direct  %6.2f us per draw, 9 state calls per draw\n", direct * 1e6 / calls);
+	printf("  cached  %6.2f us per draw, %.2f state calls issued and %.2f elided per draw\n",
+		cached * 1e6 / calls, issued / calls, elided / calls);
+	return 0;
+}
@@ -0,0 +1,111 @@
+// More textures than fit the GPU memory budget, drawn a window at a time that slides
+// over them, so the least recently drawn are evicted and reloaded as the window comes back.
+// usage: bench_gpubudget [texture count] [textures drawn per frame] [budget MB] [image.bmp]
+//
+// Checks that usage never goes past the budget, that every texture drawn ends up ready
+// and that the accounting is back where it started once everything is released.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../common/startScreen.h"
+#include "../common/texturemanager.h"
+#include "../common/gpumemory.h"
+#include "../common/bmpfile.h"
+#include "../common/glstate.h"
+#include "benchmark.h"
+
+static bool writeCopies(const char* bmp, int count, std::vector<std::string>& out_paths)
+{
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(bmp, rgb, width, height))
+		return false;
+
+	for(int i = 0; i < count; i++)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "bench_budget_%d.bmp", i);
+		rgb[0] = (unsigned char)i;
+		if(!writeBMP(path, &rgb[0], width, height))
+			return false;
+		out_paths.push_back(path);
+	}
+	return true;
+}
+
+int main(int argc, const char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 48;
+	int window = argc > 2 ? atoi(argv[2]) : 8;
+	size_t budget = (size_t)(argc > 3 ? atof(argv[3]) : 16.0) * 1024 * 1024;
+	const char* bmp = argc > 4 ? argv[4] : "uvtemplate.bmp";
+
+	InitGraphics();
+	std::vector<std::string> paths;
+	if(!writeCopies(bmp, count, paths))
+	{
+		printf("Could not write copies of %s\n", bmp);
+		return 1;
+	}
+
+	size_t baseline = GGpuMemory.GetTotal();
+	GGpuMemory.SetBudget(baseline + budget);
+	GGpuMemory.ResetStats();
+
+	bool ok = true;
+	int frames = 0;
+	double worst = 0.0;
+	{
+		TextureManager manager;
+		std::vector<TextureHandle> textures;
+		for(size_t i = 0; i < paths.size(); i++)
+			textures.push_back(manager.LoadAsync(paths[i].c_str()));
+
+		// two passes of the window over every texture, then let the last ones finish
+		int steps = 2 * count;
+		for(int step = 0; step < steps || manager.GetPendingCount(); frames++)
+		{
+			double start = now();
+			glClear(GL_COLOR_BUFFER_BIT);
+			for(int i = 0; i < window; i++)
+			{
+				GGLState.BindTexture(GL_TEXTURE_2D, textures[(step + i) % count].Get());
+				glDrawArrays(GL_TRIANGLES, 0, 0);
+			}
+			manager.Update(512 * 1024, 4.0);
+			glFinish();
+			double t = now() - start;
+			if(t > worst)
+				worst = t;
+			updateScreen();
+
+			// move on once the window is all there
+			bool ready = true;
+			for(int i = 0; i < window; i++)
+				ready = ready && textures[(step + i) % count].IsReady();
+			if(ready && step < steps)
+				step++;
+		}
+
+		if(GGpuMemory.GetPeakTotal() > baseline + budget)
+		{
+			printf("Peak %.2f MB is over the budget\n", (GGpuMemory.GetPeakTotal() - baseline) / (1024.0 * 1024.0));
+			ok = false;
+		}
+		manager.PrintStats("textures");
+		GGpuMemory.PrintStats("GPU memory");
+	}
+	if(GGpuMemory.GetTotal() != baseline)
+	{
+		printf("%u bytes still accounted after release\n", (unsigned)(GGpuMemory.GetTotal() - baseline));
+		ok = false;
+	}
+	for(size_t i = 0; i < paths.size(); i++)
+		remove(paths[i].c_str());
+
+	printf("\n%d textures from %s, %d drawn per frame, %.1f MB budget: %d frames, worst %.2f ms\n  %s\n",
+		count, bmp, window, budget / (1024.0 * 1024.0), frames, worst * 1000.0, ok ? "check passed" : "CHECK FAILED");
+	return ok ? 0 : 1;
+}
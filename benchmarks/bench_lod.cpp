@@ -0,0 +1,77 @@
+// LOD chains from simplifyMesh and what selectMeshLOD picks for a field of instances
+// usage: bench_lod [model.obj] [synthetic triangle count] [grid size]
+//
+// The grid is the one tutorial08 draws with LOD_GRID, same camera and projection, so the
+// triangle counts here are what the GPU gets per frame there.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshfile.h"
+#include "../common/meshsimplify.h"
+#include "benchmark.h"
+
+static void report(const char* path, int grid)
+{
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+	if(!loadOBJIndexed(path, indices, vertices, uvs, normals))
+	{
+		printf("%s: failed to load\n", path);
+		return;
+	}
+
+	MeshLODChain lods;
+	std::vector<unsigned short> lod_indices;
+	double t = now();
+	buildMeshLODs(&indices[0], indices.size(), &vertices[0].x, vertices.size(), sizeof(glm::vec3), MAX_MESH_LODS, lods, lod_indices);
+	t = now() - t;
+
+	printMeshLODs(path, lods);
+	printf("  built in %.3f ms, %u indices for all levels (%u for LOD0)\n",
+		t * 1000.0, (unsigned)lod_indices.size(), lods.Levels[0].IndexCount);
+
+	glm::mat4 projection = glm::perspective(45.0f, 4.0f / 3.0f, 0.1f, 100.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(4, 1, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	unsigned int full = 0, selected = 0, per_level[MAX_MESH_LODS] = { 0 };
+	for(int z = 0; z < grid; z++)
+		for(int x = 0; x < grid; x++)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f * x, 0.0f, -3.0f * z));
+			int level = selectMeshLOD(lods, projection, view * model, 1080.0f);
+			per_level[level]++;
+			full += lods.Levels[0].IndexCount / 3;
+			selected += lods.Levels[level].IndexCount / 3;
+		}
+	printf("  %dx%d grid at 1080p: %u triangles instead of %u (%.1f%%), instances per LOD:",
+		grid, grid, selected, full, 100.0 * selected / full);
+	for(int level = 0; level < lods.NumLevels; level++)
+		printf(" %u", per_level[level]);
+	printf("\n");
+}
+
+int main(int argc, const char **argv)
+{
+	const char* model = argc > 1 ? argv[1] : "suzanne.obj";
+	int triangles = argc > 2 ? atoi(argv[2]) : 60000;
+	int grid = argc > 3 ? atoi(argv[3]) : 16;
+
+	report(model, grid);
+
+	const char* synthetic = "synthetic_sphere.obj";
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+	report(synthetic, grid);
+	remove(synthetic);
+	remove(meshCachePath(synthetic).c_str());
+	return 0;
+}
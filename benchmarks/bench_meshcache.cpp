@@ -0,0 +1,70 @@
+// Startup cost of a model: parsing the .obj versus mapping the .mesh cache
+// usage: bench_meshcache [model.obj] [synthetic triangle count]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshfile.h"
+#include "benchmark.h"
+
+static void measure(const char* path)
+{
+	std::string cache = meshCachePath(path);
+	remove(cache.c_str());
+
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+
+	// cold: parse, index and write the cache
+	double t = now();
+	bool ok = loadOBJIndexed(path, indices, vertices, uvs, normals);
+	double cold = now() - t;
+	if(!ok)
+	{
+		printf("%s: failed to load\n", path);
+		return;
+	}
+
+	// warm: the same call finds the cache
+	indices.clear(); vertices.clear(); uvs.clear(); normals.clear();
+	t = now();
+	loadOBJIndexed(path, indices, vertices, uvs, normals);
+	double warm = now() - t;
+
+	// what loadMeshBuffers does before glBufferData: just the mapping, no copies
+	MeshFile mesh;
+	t = now();
+	ok = openMeshCache(path, mesh);
+	double mapped = now() - t;
+
+	printf("%s: %u vertices, %u indices\n", path, (unsigned)vertices.size(), (unsigned)indices.size());
+	printf("  parse .obj + write cache %8.3f ms\n", cold * 1000.0);
+	printf("  cache into vectors       %8.3f ms\n", warm * 1000.0);
+	printf("  cache mapped             %8.3f ms%s\n", mapped * 1000.0, ok ? "" : " (FAILED)");
+	remove(cache.c_str());
+}
+
+int main(int argc, const char **argv)
+{
+	const char* model = argc > 1 ? argv[1] : "suzanne.obj";
+	// the cache holds 16 bit indices, stay under 65535 vertices
+	int triangles = argc > 2 ? atoi(argv[2]) : 120000;
+
+	measure(model);
+
+	const char* synthetic = "synthetic_sphere.obj";
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+	measure(synthetic);
+	remove(synthetic);
+
+	return 0;
+}
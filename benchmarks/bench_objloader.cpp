@@ -0,0 +1,188 @@
+// Compare the mmapped loadOBJ against the original fscanf loop, and time the opt-in cache
+// usage: bench_objloader [model.obj] [synthetic triangle count]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshfile.h"
+#include "../common/chunkfile.h"
+#include "benchmark.h"
+
+// The loader as it was, one fscanf per token
+static bool loadOBJ_fscanf(
+	const char * path,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+	std::vector<glm::vec3> temp_vertices;
+	std::vector<glm::vec2> temp_uvs;
+	std::vector<glm::vec3> temp_normals;
+
+	FILE * file = fopen(path, "r");
+	if( file == NULL )
+		return false;
+
+	while( 1 ){
+		char lineHeader[128];
+		int res = fscanf(file, "%127s", lineHeader);
+		if (res == EOF)
+			break;
+
+		if ( strcmp( lineHeader, "v" ) == 0 ){
+			glm::vec3 vertex;
+			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z );
+			temp_vertices.push_back(vertex);
+		}else if ( strcmp( lineHeader, "vt" ) == 0 ){
+			glm::vec2 uv;
+			fscanf(file, "%f %f\n", &uv.x, &uv.y );
+			uv.y = -uv.y;
+			temp_uvs.push_back(uv);
+		}else if ( strcmp( lineHeader, "vn" ) == 0 ){
+			glm::vec3 normal;
+			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z );
+			temp_normals.push_back(normal);
+		}else if ( strcmp( lineHeader, "f" ) == 0 ){
+			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
+			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
+			if (matches != 9){
+				fclose(file);
+				return false;
+			}
+			for( int i=0; i<3; i++ ){
+				vertexIndices.push_back(vertexIndex[i]);
+				uvIndices    .push_back(uvIndex[i]);
+				normalIndices.push_back(normalIndex[i]);
+			}
+		}else{
+			char stupidBuffer[1000];
+			fgets(stupidBuffer, 1000, file);
+		}
+	}
+	fclose(file);
+
+	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
+		out_vertices.push_back(temp_vertices[ vertexIndices[i]-1 ]);
+		out_uvs     .push_back(temp_uvs[ uvIndices[i]-1 ]);
+		out_normals .push_back(temp_normals[ normalIndices[i]-1 ]);
+	}
+	return true;
+}
+
+// Timed runs per loader, the best one counts
+#define RUNS 5
+
+struct Model
+{
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+	bool ok;
+};
+
+typedef bool (*OBJLoader)(const char*, std::vector<glm::vec3>&, std::vector<glm::vec2>&, std::vector<glm::vec3>&);
+
+// Best of RUNS, after a first run that warms the page cache and isn't counted. out gets
+// the last run's model. uncached removes the loadOBJ cache before each run, off the clock.
+static double timeLoad(OBJLoader load, const char* path, bool uncached, Model& out)
+{
+	double best = 1e30;
+	for(int run = 0; run <= RUNS; run++)
+	{
+		if(uncached)
+		{
+			remove(meshCachePath(path).c_str());
+			remove(chunkFilePath(path).c_str());
+		}
+		out.vertices.clear();
+		out.uvs.clear();
+		out.normals.clear();
+		double t = now();
+		out.ok = load(path, out.vertices, out.uvs, out.normals);
+		t = now() - t;
+		if(run > 0 && t < best)
+			best = t;
+	}
+	return best;
+}
+
+static void compare(const char* path)
+{
+	Model m0, m1;
+	double old_time = timeLoad(loadOBJ_fscanf, path, false, m0);
+	double new_time = timeLoad(loadOBJ, path, false, m1);
+
+	if(!m0.ok || !m1.ok)
+	{
+		printf("%s: failed to load (fscanf %d, mmap %d)\n", path, m0.ok, m1.ok);
+		return;
+	}
+
+	// the hand written float scanner may differ from strtof in the last bit
+	float max_err = 0;
+	bool same = m0.vertices.size() == m1.vertices.size();
+	for(size_t i = 0; same && i < m0.vertices.size(); i++)
+	{
+		for(int c = 0; c < 3; c++)
+		{
+			max_err = fmaxf(max_err, fabsf(m0.vertices[i][c] - m1.vertices[i][c]));
+			max_err = fmaxf(max_err, fabsf(m0.normals[i][c] - m1.normals[i][c]));
+		}
+		for(int c = 0; c < 2; c++)
+			max_err = fmaxf(max_err, fabsf(m0.uvs[i][c] - m1.uvs[i][c]));
+	}
+
+	printf("%s: %u vertices, best of %d\n", path, (unsigned)m1.vertices.size(), RUNS);
+	printf("  fscanf %8.3f ms\n", old_time * 1000.0);
+	printf("  mmap   %8.3f ms  (%.1fx)\n", new_time * 1000.0, old_time / new_time);
+	printf("  output %s, max difference %g\n", same ? "matches" : "DIFFERS", max_err);
+}
+
+// setOBJCache(true): the load that writes the cache and the one that reads it back
+// have to give the same triangles in the same order
+static void compareCache(const char* path)
+{
+	Model written, read;
+	setOBJCache(true);
+	double write_time = timeLoad(loadOBJ, path, true, written);
+	double read_time = timeLoad(loadOBJ, path, false, read);
+	setOBJCache(false);
+	remove(meshCachePath(path).c_str());
+	remove(chunkFilePath(path).c_str());
+
+	size_t count = written.vertices.size();
+	bool same = written.ok && read.ok && count && count == read.vertices.size() &&
+		memcmp(&written.vertices[0], &read.vertices[0], count * sizeof(glm::vec3)) == 0 &&
+		memcmp(&written.uvs[0], &read.uvs[0], count * sizeof(glm::vec2)) == 0 &&
+		memcmp(&written.normals[0], &read.normals[0], count * sizeof(glm::vec3)) == 0;
+	printf("  cached %8.3f ms to write, %8.3f ms to read back, %s\n",
+		write_time * 1000.0, read_time * 1000.0, same ? "same order" : "DIFFERS");
+}
+
+int main(int argc, const char **argv)
+{
+	const char* model = argc > 1 ? argv[1] : "suzanne.obj";
+	int triangles = argc > 2 ? atoi(argv[2]) : 2000000;
+
+	compare(model);
+	compareCache(model);
+
+	const char* synthetic = "synthetic_sphere.obj";
+	printf("Writing %s with ~%d triangles\n", synthetic, triangles);
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+	compare(synthetic);
+	compareCache(synthetic);
+	remove(synthetic);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+// Scaling of the chunked OBJ parser from 1 thread up to N
+// usage: bench_objthreads [max threads] [synthetic triangle count]
+//
+// Also checks that a comment line longer than a chunk loads the same at 1 and 4 threads.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "benchmark.h"
+
+// A sphere with a comment line near the start that runs past more than one split point
+static bool checkLongLine(int threads)
+{
+	const char* path = "long_line.obj";
+	if(!writeSphere(path, 20000))
+		return false;
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return false;
+	std::vector<char> sphere;
+	char buffer[65536];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		sphere.insert(sphere.end(), buffer, buffer + read);
+	fclose(f);
+
+	size_t cut = sphere.size() / 10;
+	while(cut < sphere.size() && sphere[cut - 1] != '\n')
+		cut++;
+	std::string comment(1536 * 1024, 'x');
+	comment[0] = '#';
+	comment += '\n';
+	f = fopen(path, "wb");
+	if(!f)
+		return false;
+	fwrite(&sphere[0], 1, cut, f);
+	fwrite(comment.data(), 1, comment.size(), f);
+	fwrite(&sphere[cut], 1, sphere.size() - cut, f);
+	fclose(f);
+
+	size_t triangles[2] = { 0, 0 };
+	int counts[2] = { 1, threads };
+	bool ok = true;
+	for(int i = 0; i < 2; i++)
+	{
+		std::vector<glm::vec3> vertices, normals;
+		std::vector<glm::vec2> uvs;
+		setOBJLoaderThreads(counts[i]);
+		ok = loadOBJ(path, vertices, uvs, normals) && ok;
+		triangles[i] = vertices.size() / 3;
+	}
+	remove(path);
+	ok = ok && triangles[0] == triangles[1];
+	printf("long line: %lu triangles at 1 thread, %lu at %d threads  %s\n",
+		(unsigned long)triangles[0], (unsigned long)triangles[1], threads, ok ? "identical" : "DIFFERS");
+	return ok;
+}
+
+int main(int argc, const char **argv)
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int max_threads = argc > 1 ? atoi(argv[1]) : (cores > 0 ? (int)cores : 1);
+	int triangles = argc > 2 ? atoi(argv[2]) : 4000000;
+
+	const char* synthetic = "synthetic_sphere.obj";
+	printf("Writing %s with ~%d triangles\n", synthetic, triangles);
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+
+	std::vector<glm::vec3> ref_vertices, ref_normals;
+	std::vector<glm::vec2> ref_uvs;
+	double base_time = 0;
+
+	for(int threads = 1; threads <= max_threads; threads++)
+	{
+		std::vector<glm::vec3> vertices, normals;
+		std::vector<glm::vec2> uvs;
+
+		setOBJLoaderThreads(threads);
+		double t = now();
+		if(!loadOBJ(synthetic, vertices, uvs, normals))
+		{
+			printf("failed to load with %d threads\n", threads);
+			break;
+		}
+		t = now() - t;
+
+		bool same = true;
+		if(threads == 1)
+		{
+			base_time = t;
+			ref_vertices.swap(vertices);
+			ref_uvs.swap(uvs);
+			ref_normals.swap(normals);
+		}
+		else
+		{
+			same = vertices.size() == ref_vertices.size() &&
+				memcmp(&vertices[0], &ref_vertices[0], vertices.size() * sizeof(glm::vec3)) == 0 &&
+				memcmp(&uvs[0], &ref_uvs[0], uvs.size() * sizeof(glm::vec2)) == 0 &&
+				memcmp(&normals[0], &ref_normals[0], normals.size() * sizeof(glm::vec3)) == 0;
+		}
+		printf("%2d threads %9.3f ms  %5.2fx  %s\n", threads, t * 1000.0, base_time / t, same ? "identical" : "DIFFERS");
+	}
+
+	remove(synthetic);
+	return checkLongLine(max_threads > 4 ? max_threads : 4) ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Splits a synthetic multi-million triangle mesh with partitionMesh and checks the result:
+// every chunk fits 16 bit indices, every triangle comes out exactly once, bounds hold.
+// usage: bench_partition [triangle count] [model.obj]
+//
+// The 32 bit loadOBJIndexed path is checked too, on the model or on a written sphere
+// that is past 65535 vertices.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshpartition.h"
+#include "benchmark.h"
+
+// A triangle rotated so its smallest vertex is first, the same triangle compares equal
+// whichever corner it starts from but a flipped winding does not
+static void sortedTriangle(const unsigned int* tri, unsigned long long* out)
+{
+	int first = tri[0] < tri[1] ? (tri[0] < tri[2] ? 0 : 2) : (tri[1] < tri[2] ? 1 : 2);
+	out[0] = tri[first];
+	out[1] = ((unsigned long long)tri[(first + 1) % 3] << 32) | tri[(first + 2) % 3];
+}
+
+static bool check(const char* label, const std::vector<unsigned int>& indices, const std::vector<glm::vec3>& positions)
+{
+	std::vector<MeshChunk> chunks;
+	double t = now();
+	partitionMesh(&indices[0], indices.size(), positions, MAX_CHUNK_VERTICES, chunks);
+	t = now() - t;
+
+	printf("%s: %u triangles, %u vertices, partitioned in %.1f ms\n  ",
+		label, (unsigned)(indices.size() / 3), (unsigned)positions.size(), t * 1000.0);
+	printPartitionReport(chunks, positions.size());
+
+	bool ok = true;
+	std::vector<unsigned long long> expected, found;
+	for(size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		unsigned long long key[2];
+		sortedTriangle(&indices[i], key);
+		expected.push_back(key[0]);
+		expected.push_back(key[1]);
+	}
+	for(size_t c = 0; c < chunks.size(); c++)
+	{
+		const MeshChunk& chunk = chunks[c];
+		if(chunk.Vertices.size() > MAX_CHUNK_VERTICES)
+		{
+			printf("  chunk %u has %u vertices\n", (unsigned)c, (unsigned)chunk.Vertices.size());
+			ok = false;
+		}
+		for(size_t v = 0; v < chunk.Vertices.size(); v++)
+		{
+			const glm::vec3& p = positions[ chunk.Vertices[v] ];
+			if(glm::min(p, chunk.BoundsMin) != chunk.BoundsMin || glm::max(p, chunk.BoundsMax) != chunk.BoundsMax)
+				ok = false;
+		}
+		for(size_t i = 0; i < chunk.Indices.size(); i += 3)
+		{
+			unsigned int tri[3];
+			for(int k = 0; k < 3; k++)
+			{
+				if(chunk.Indices[i + k] >= chunk.Vertices.size())
+				{
+					printf("  chunk %u index out of range\n", (unsigned)c);
+					return false;
+				}
+				tri[k] = chunk.Vertices[ chunk.Indices[i + k] ];
+			}
+			unsigned long long sorted[2];
+			sortedTriangle(tri, sorted);
+			found.push_back(sorted[0]);
+			found.push_back(sorted[1]);
+		}
+	}
+
+	// compare the triangle multisets
+	std::vector<std::pair<unsigned long long, unsigned long long> > a, b;
+	for(size_t i = 0; i < expected.size(); i += 2) a.push_back(std::make_pair(expected[i], expected[i + 1]));
+	for(size_t i = 0; i < found.size(); i += 2) b.push_back(std::make_pair(found[i], found[i + 1]));
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	if(a != b)
+	{
+		printf("  triangles differ (%u in, %u out)\n", (unsigned)a.size(), (unsigned)b.size());
+		ok = false;
+	}
+	printf("  %s\n", ok ? "check passed" : "CHECK FAILED");
+	return ok;
+}
+
+int main(int argc, const char **argv)
+{
+	int triangles = argc > 1 ? atoi(argv[1]) : 4000000;
+	bool ok = true;
+
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> positions, normals;
+	std::vector<glm::vec2> uvs;
+	buildSphere(triangles, indices, positions, uvs, normals);
+	ok = check("synthetic sphere", indices, positions) && ok;
+
+	const char* model = argc > 2 ? argv[2] : "synthetic_sphere.obj";
+	if(argc <= 2 && !writeSphere(model, 300000))
+	{
+		printf("Could not write %s\n", model);
+		return 1;
+	}
+	std::vector<unsigned int> obj_indices;
+	std::vector<glm::vec3> vertices, obj_normals;
+	std::vector<glm::vec2> obj_uvs;
+	bool loaded = loadOBJIndexed(model, obj_indices, vertices, obj_uvs, obj_normals);
+	if(argc <= 2)
+		remove(model);
+	if(!loaded)
+	{
+		printf("%s: failed to load\n", model);
+		return 1;
+	}
+	ok = check(model, obj_indices, vertices) && ok;
+	return ok ? 0 : 1;
+}
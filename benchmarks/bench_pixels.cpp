@@ -0,0 +1,95 @@
+// MB/s of each pixelconvert kernel, SIMD against scalar, and a check that they agree
+// usage: bench_pixels [width] [height]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "../common/pixelconvert.h"
+#include "benchmark.h"
+
+#define REPEATS 20
+
+// odd sizes on purpose, so the scalar tails get exercised too
+static void fill(std::vector<unsigned char>& data)
+{
+	unsigned int seed = 12345;
+	for(size_t i = 0; i < data.size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = (unsigned char)(seed >> 16);
+	}
+}
+
+static void report(const char* name, size_t bytes, double simd, double scalar, bool same)
+{
+	printf("  %-12s %8.1f MB/s  scalar %8.1f MB/s  (%.2fx)  %s\n", name,
+		bytes / simd / (1024.0 * 1024.0), bytes / scalar / (1024.0 * 1024.0), scalar / simd,
+		same ? "matches" : "DIFFERS");
+}
+
+int main(int argc, const char **argv)
+{
+	int width = argc > 1 ? atoi(argv[1]) : 1921;
+	int height = argc > 2 ? atoi(argv[2]) : 1081;
+	size_t pixels = (size_t)width * height;
+
+	std::vector<unsigned char> rgb(pixels * 3), rgba(pixels * 4);
+	std::vector<unsigned char> out3(pixels * 3), ref3(pixels * 3), out4(pixels * 4), ref4(pixels * 4);
+	std::vector<unsigned short> out565(pixels), ref565(pixels);
+	fill(rgb);
+	fill(rgba);
+
+	printf("%dx%d, %s, best of %d\n", width, height, pixelConvertBackend(), REPEATS);
+
+	double simd = 1e30, scalar = 1e30, t;
+	for(int r = 0; r < REPEATS; r++)
+	{
+		t = now(); convertBGRToRGB(&rgb[0], &out3[0], pixels); simd = std::min(simd, now() - t);
+		t = now(); convertBGRToRGB_scalar(&rgb[0], &ref3[0], pixels); scalar = std::min(scalar, now() - t);
+	}
+	report("BGR->RGB", pixels * 3, simd, scalar, out3 == ref3);
+
+	simd = scalar = 1e30;
+	for(int r = 0; r < REPEATS; r++)
+	{
+		t = now(); convertRGBToRGBA(&rgb[0], &out4[0], pixels, 255); simd = std::min(simd, now() - t);
+		t = now(); convertRGBToRGBA_scalar(&rgb[0], &ref4[0], pixels, 255); scalar = std::min(scalar, now() - t);
+	}
+	report("RGB->RGBA", pixels * 3, simd, scalar, out4 == ref4);
+
+	simd = scalar = 1e30;
+	for(int r = 0; r < REPEATS; r++)
+	{
+		t = now(); convertBGRToRGBA(&rgb[0], &out4[0], pixels, 255); simd = std::min(simd, now() - t);
+		t = now(); convertBGRToRGBA_scalar(&rgb[0], &ref4[0], pixels, 255); scalar = std::min(scalar, now() - t);
+	}
+	report("BGR->RGBA", pixels * 3, simd, scalar, out4 == ref4);
+
+	simd = scalar = 1e30;
+	for(int r = 0; r < REPEATS; r++)
+	{
+		t = now(); convertRGBAToRGB565(&rgba[0], &out565[0], pixels); simd = std::min(simd, now() - t);
+		t = now(); convertRGBAToRGB565_scalar(&rgba[0], &ref565[0], pixels); scalar = std::min(scalar, now() - t);
+	}
+	report("RGBA->565", pixels * 4, simd, scalar, out565 == ref565);
+
+	// in place, the way loadBMP_custom uses it
+	out3 = rgb;
+	convertBGRToRGB(&out3[0], &out3[0], pixels);
+	convertBGRToRGB_scalar(&rgb[0], &ref3[0], pixels);
+	printf("  BGR->RGB in place %s\n", out3 == ref3 ? "matches" : "DIFFERS");
+
+	// flipping twice must give the input back
+	double flip = 1e30;
+	for(int r = 0; r < REPEATS; r++)
+	{
+		t = now(); flipRows(&rgba[0], (size_t)width * 4, height); flip = std::min(flip, now() - t);
+	}
+	out4 = rgba;
+	flipRows(&out4[0], (size_t)width * 4, height);
+	flipRows(&out4[0], (size_t)width * 4, height);
+	printf("  %-12s %8.1f MB/s  %s\n", "flip rows", pixels * 4 / flip / (1024.0 * 1024.0), out4 == rgba ? "round trips" : "DIFFERS");
+	return 0;
+}
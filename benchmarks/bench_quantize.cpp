@@ -0,0 +1,53 @@
+// Round trip error and memory saved by quantizeMesh
+// usage: bench_quantize [model.obj] [synthetic triangle count]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshfile.h"
+#include "../common/meshquantize.h"
+#include "benchmark.h"
+
+static void report(const char* path)
+{
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+	if(!loadOBJIndexed(path, indices, vertices, uvs, normals))
+	{
+		printf("%s: failed to load\n", path);
+		return;
+	}
+
+	std::vector<QuantizedVertex> quantized;
+	MeshQuantization quantization;
+	double t = now();
+	quantizeMesh(vertices, uvs, normals, quantized, quantization);
+	t = now() - t;
+
+	printf("%s (%.3f ms)\n", path, t * 1000.0);
+	printQuantizationReport(vertices, uvs, normals, quantized, quantization);
+}
+
+int main(int argc, const char **argv)
+{
+	const char* model = argc > 1 ? argv[1] : "suzanne.obj";
+	int triangles = argc > 2 ? atoi(argv[2]) : 120000;
+
+	report(model);
+
+	const char* synthetic = "synthetic_sphere.obj";
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+	report(synthetic);
+	remove(synthetic);
+	remove(meshCachePath(synthetic).c_str());
+	return 0;
+}
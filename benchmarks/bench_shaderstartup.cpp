@@ -0,0 +1,83 @@
+// Time from reading a program's shader files to its first finished draw: cold (compile,
+// link and save the binary), warm (the binary loaded from the cache) and with the
+// cache turned off.
+// usage: bench_shaderstartup [runs] [vertex.glsl fragment.glsl]
+//
+// Without GL_OES_get_program_binary every run compiles, the warm column then shows the
+// fallback costs nothing over the uncached path.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../common/startScreen.h"
+#include "../common/LoadShaders.h"
+#include "../common/programcache.h"
+#include "../common/glstate.h"
+#include "benchmark.h"
+
+// Some drivers finish compiling on the first draw, so that is part of the time
+static double startProgram(const char* vertex_path, const char* fragment_path, bool remove_binary)
+{
+	double start = now();
+	GfxShader vs, fs;
+	GfxProgram program;
+	vs.LoadVertexShader(vertex_path);
+	fs.LoadFragmentShader(fragment_path);
+	if(remove_binary)
+	{
+		// outside the timing
+		double t = now();
+		GProgramCache.Remove(GProgramCache.Key(vs.GetSource(), fs.GetSource()));
+		start += now() - t;
+	}
+	program.Create(&vs, &fs);
+	GGLState.UseProgram(program.GetId());
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glFinish();
+	double t = now() - start;
+
+	GGLState.DeleteProgram(program.GetId());
+	if(vs.GetId())
+		glDeleteShader(vs.GetId());
+	if(fs.GetId())
+		glDeleteShader(fs.GetId());
+	return t;
+}
+
+struct Timing
+{
+	double Total, Best;
+};
+
+static void add(Timing& timing, double t)
+{
+	timing.Total += t;
+	if(timing.Best == 0.0 || t < timing.Best)
+		timing.Best = t;
+}
+
+int main(int argc, const char **argv)
+{
+	int runs = argc > 1 ? atoi(argv[1]) : 10;
+	const char* vertex_path = argc > 3 ? argv[2] : "TransformVertexShader.glsl";
+	const char* fragment_path = argc > 3 ? argv[3] : "TextureFragmentShader.glsl";
+
+	InitGraphics();
+
+	Timing cold = { 0, 0 }, warm = { 0, 0 }, uncached = { 0, 0 };
+	for(int i = 0; i < runs; i++)
+	{
+		GProgramCache.SetDirectory("bench_shadercache");
+		add(cold, startProgram(vertex_path, fragment_path, true));
+		add(warm, startProgram(vertex_path, fragment_path, false));
+		GProgramCache.SetDirectory("");
+		add(uncached, startProgram(vertex_path, fragment_path, false));
+	}
+	GProgramCache.PrintStats("cache");
+
+	printf("\n%s + %s, %d runs, read to first draw:\n", vertex_path, fragment_path, runs);
+	printf("  cold      %7.2f ms (best %.2f)\n", cold.Total * 1000.0 / runs, cold.Best * 1000.0);
+	printf("  warm      %7.2f ms (best %.2f)\n", warm.Total * 1000.0 / runs, warm.Best * 1000.0);
+	printf("  no cache  %7.2f ms (best %.2f)\n", uncached.Total * 1000.0 / runs, uncached.Best * 1000.0);
+	return 0;
+}
@@ -0,0 +1,248 @@
+// Frame time for a screen of small textured rects: one draw per rect the way
+// DrawTextureRect drew before GSpriteBatch, against SpriteBatch with the rects sorted by
+// texture and with all the images in one atlas page.
+// usage: bench_sprites [rects] [frames]
+//
+// 16 images of 32 x 32, the rects cycle through them in screen order. The times cover
+// issuing the frame and glFinish, so they hold what the GPU spent on the draws too.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "../common/startScreen.h"
+#include "../common/programreflect.h"
+#include "../common/glstate.h"
+#include "../common/spritebatch.h"
+#include "../common/textureatlas.h"
+#include "benchmark.h"
+
+static const int GImages = 16;
+static const int GImageSize = 32;
+
+static const char* GVertexSource =
+	"attribute vec4 vertex;\n"
+	"uniform vec2 offset;\n"
+	"uniform vec2 scale;\n"
+	"varying vec2 tcoord;\n"
+	"void main(void)\n"
+	"{\n"
+	"	tcoord = vertex.xy;\n"
+	"	gl_Position = vec4(vertex.xy * scale + offset, vertex.zw);\n"
+	"}\n";
+
+static const char* GFragmentSource =
+	"varying mediump vec2 tcoord;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_FragColor = texture2D(tex, tcoord);\n"
+	"}\n";
+
+struct Rect
+{
+	float X0, Y0, X1, Y1;
+	int Image;
+};
+
+struct PerRect
+{
+	GLuint Program;
+	GLuint Buffer;
+	GLint Vertex;
+	int Offset, Scale;
+	ProgramReflection Reflection;
+};
+
+static GLuint compile(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+static bool createPerRect(PerRect& p)
+{
+	p.Program = glCreateProgram();
+	glAttachShader(p.Program, compile(GL_VERTEX_SHADER, GVertexSource));
+	glAttachShader(p.Program, compile(GL_FRAGMENT_SHADER, GFragmentSource));
+	glLinkProgram(p.Program);
+	GLint linked = 0;
+	glGetProgramiv(p.Program, GL_LINK_STATUS, &linked);
+	if(!linked)
+		return false;
+	static const GLfloat quad[] = { 0,0,1,1, 1,0,1,1, 0,1,1,1, 1,1,1,1 };
+	glGenBuffers(1, &p.Buffer);
+	GGLState.BindBuffer(GL_ARRAY_BUFFER, p.Buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	p.Reflection.Reflect(p.Program);
+	p.Offset = p.Reflection.FindUniform("offset");
+	p.Scale = p.Reflection.FindUniform("scale");
+	p.Vertex = p.Reflection.FindAttrib("vertex");
+	GGLState.UseProgram(p.Program);
+	p.Reflection.SetInt(p.Reflection.FindUniform("tex"), 0);
+	return true;
+}
+
+// what DrawTextureRect did for each rect before the batch
+static void drawPerRect(PerRect& p, const std::vector<Rect>& rects, const GLuint* textures)
+{
+	for(size_t i = 0; i < rects.size(); i++)
+	{
+		const Rect& r = rects[i];
+		GGLState.UseProgram(p.Program);
+		p.Reflection.SetVec2(p.Offset, r.X0, r.Y0);
+		p.Reflection.SetVec2(p.Scale, r.X1 - r.X0, r.Y1 - r.Y0);
+		GGLState.BindBuffer(GL_ARRAY_BUFFER, p.Buffer);
+		GGLState.ActiveTexture(GL_TEXTURE0);
+		GGLState.BindTexture(GL_TEXTURE_2D, textures[r.Image]);
+		glVertexAttribPointer(p.Vertex, 4, GL_FLOAT, 0, 16, 0);
+		GGLState.EnableVertexAttribArray(p.Vertex);
+		GGLState.Enable(GL_BLEND);
+		GGLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+}
+
+// a texture per image, the rects go out image by image so each one is a single flush
+static void drawSorted(SpriteBatch& batch, const std::vector<Rect>& rects, const GLuint* textures)
+{
+	batch.Begin();
+	for(int image = 0; image < GImages; image++)
+		for(size_t i = image; i < rects.size(); i += GImages)
+			batch.Draw(textures[image], rects[i].X0, rects[i].Y0, rects[i].X1, rects[i].Y1);
+	batch.End();
+}
+
+// one atlas page, screen order is kept
+static void drawAtlas(SpriteBatch& batch, const std::vector<Rect>& rects, const TextureAtlas& atlas,
+	const std::vector<AtlasRegion>& regions)
+{
+	batch.Begin();
+	for(size_t i = 0; i < rects.size(); i++)
+		batch.Draw(atlas, regions[rects[i].Image], rects[i].X0, rects[i].Y0, rects[i].X1, rects[i].Y1);
+	batch.End();
+}
+
+int main(int argc, const char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 10000;
+	int frames = argc > 2 ? atoi(argv[2]) : 60;
+
+	InitGraphics();
+
+	std::vector<Rect> rects(count);
+	int side = (int)sqrt((double)count) + 1;
+	float size = 2.0f / side;
+	for(int i = 0; i < count; i++)
+	{
+		Rect& r = rects[i];
+		r.X0 = -1.0f + size * (i % side);
+		r.Y0 = -1.0f + size * (i / side);
+		r.X1 = r.X0 + size;
+		r.Y1 = r.Y0 + size;
+		r.Image = i % GImages;
+	}
+
+	// each image a flat colour with a transparent border, enough to see them all drawn
+	std::vector<std::vector<unsigned char> > pixels(GImages);
+	std::vector<AtlasSource> sources(GImages);
+	GLuint textures[GImages];
+	glGenTextures(GImages, textures);
+	for(int image = 0; image < GImages; image++)
+	{
+		std::vector<unsigned char>& p = pixels[image];
+		p.resize(GImageSize * GImageSize * 4);
+		for(int y = 0; y < GImageSize; y++)
+		{
+			for(int x = 0; x < GImageSize; x++)
+			{
+				unsigned char* c = &p[(y * GImageSize + x) * 4];
+				bool border = x == 0 || y == 0 || x == GImageSize - 1 || y == GImageSize - 1;
+				c[0] = (unsigned char)(image * 16);
+				c[1] = (unsigned char)(255 - image * 16);
+				c[2] = (unsigned char)(image & 1 ? 255 : 0);
+				c[3] = border ? 0 : 255;
+			}
+		}
+		char name[16];
+		sprintf(name, "image%02d", image);
+		sources[image].Name = name;
+		sources[image].Width = GImageSize;
+		sources[image].Height = GImageSize;
+		sources[image].Pixels = &p[0];
+
+		GGLState.BindTexture(GL_TEXTURE_2D, textures[image]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GImageSize, GImageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, &p[0]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	TextureAtlas atlas;
+	PerRect perRect;
+	SpriteBatch batch;
+	if(!atlas.Create(sources, 256, 1) || atlas.GetRegions().size() != (size_t)GImages)
+	{
+		printf("Could not build the atlas\n");
+		return 1;
+	}
+	// regions come back in packing order, put them back in image order
+	std::vector<AtlasRegion> byImage(GImages);
+	for(int image = 0; image < GImages; image++)
+		byImage[image] = *atlas.Find(sources[image].Name.c_str());
+	if(!createPerRect(perRect) || !batch.Create(4096))
+	{
+		printf("Could not create the programs\n");
+		return 1;
+	}
+
+	// alternated every frame so all three see the same clocks and temperature
+	double perRectTime = 0.0, sortedTime = 0.0, atlasTime = 0.0;
+	unsigned long long sortedFlushes = 0, atlasFlushes = 0;
+	for(int f = 0; f < frames; f++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+		glFinish();
+		double start = now();
+		drawPerRect(perRect, rects, textures);
+		glFinish();
+		perRectTime += now() - start;
+
+		glClear(GL_COLOR_BUFFER_BIT);
+		glFinish();
+		unsigned long long flushes = batch.Flushes;
+		start = now();
+		drawSorted(batch, rects, textures);
+		glFinish();
+		sortedTime += now() - start;
+		sortedFlushes += batch.Flushes - flushes;
+
+		glClear(GL_COLOR_BUFFER_BIT);
+		glFinish();
+		flushes = batch.Flushes;
+		start = now();
+		drawAtlas(batch, rects, atlas, byImage);
+		glFinish();
+		atlasTime += now() - start;
+		atlasFlushes += batch.Flushes - flushes;
+		updateScreen();
+	}
+
+	printf("\n%d rects of %d images x %d frames:\n", count, GImages, frames);
+	printf("  one draw per rect   %7.2f ms per frame, %d draws per frame\n",
+		perRectTime * 1000.0 / frames, count);
+	printf("  batch, sorted       %7.2f ms per frame, %.0f draws per frame\n",
+		sortedTime * 1000.0 / frames, (double)sortedFlushes / frames);
+	printf("  batch, atlas        %7.2f ms per frame, %.0f draws per frame\n",
+		atlasTime * 1000.0 / frames, (double)atlasFlushes / frames);
+
+	batch.Release();
+	atlas.Release();
+	GGLState.DeleteTextures(GImages, textures);
+	GGLState.DeleteBuffers(1, &perRect.Buffer);
+	GGLState.DeleteProgram(perRect.Program);
+	return 0;
+}
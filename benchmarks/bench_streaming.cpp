@@ -0,0 +1,102 @@
+// Residency of a chunk file under a memory budget while a camera skims over a big model
+// usage: bench_streaming [triangle count] [budget MB] [frames]
+//
+// Runs the same selection as StreamingMesh::Draw (sortVisibleChunks, ResidencyManager)
+// but "uploads" by reading the chunk from disk, so it runs without a GL context.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/meshpartition.h"
+#include "../common/chunkfile.h"
+#include "../common/residency.h"
+#include "benchmark.h"
+
+#define UPLOADS_PER_FRAME 4
+
+static void run(const char* path, size_t budget, int frames)
+{
+	ChunkFile file;
+	if(!file.Open(path))
+		return;
+
+	ResidencyManager residency;
+	residency.Init(file.GetChunkCount(), budget);
+	std::vector<unsigned int> wanted, evicted;
+	std::vector<unsigned char> staging;
+	glm::mat4 projection = glm::perspective(45.0f, 4.0f / 3.0f, 0.01f, 100.0f);
+	unsigned int drawn = 0, deferred = 0;
+	double worst = 0.0, t0 = now();
+
+	for(int frame = 0; frame < frames; frame++)
+	{
+		// low orbit just above the surface, looking ahead along the path
+		float angle = 2.0f * (float)M_PI * frame / frames;
+		glm::vec3 eye(1.15f * cosf(angle), 0.3f * sinf(3.0f * angle), 1.15f * sinf(angle));
+		glm::vec3 ahead(cosf(angle + 0.3f), 0.0f, sinf(angle + 0.3f));
+		glm::mat4 mvp = projection * glm::lookAt(eye, ahead, glm::vec3(0, 1, 0));
+
+		double t = now();
+		residency.BeginFrame();
+		sortVisibleChunks(file, mvp, eye, 1.0f, wanted);
+		int uploads = 0;
+		for(size_t i = 0; i < wanted.size(); i++)
+		{
+			unsigned int chunk = wanted[i];
+			if(!residency.Touch(chunk))
+			{
+				evicted.clear();
+				if(uploads >= UPLOADS_PER_FRAME || !residency.Reserve(file.GetChunkDataSize(chunk), evicted) || !file.ReadChunk(chunk, staging))
+				{
+					deferred++;
+					continue;
+				}
+				residency.MarkResident(chunk, staging.size());
+				uploads++;
+			}
+			drawn++;
+		}
+		worst = std::max(worst, now() - t);
+	}
+
+	char label[64];
+	snprintf(label, sizeof(label), "budget %5.1f MB", budget / (1024.0 * 1024.0));
+	residency.PrintStats(label);
+	printf("  %d frames in %.1f ms, worst frame %.2f ms, %.1f chunks drawn and %.1f deferred per frame\n",
+		frames, (now() - t0) * 1000.0, worst * 1000.0, (double)drawn / frames, (double)deferred / frames);
+}
+
+int main(int argc, const char **argv)
+{
+	int triangles = argc > 1 ? atoi(argv[1]) : 4000000;
+	double budget_mb = argc > 2 ? atof(argv[2]) : 16.0;
+	int frames = argc > 3 ? atoi(argv[3]) : 1000;
+
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> positions, normals;
+	std::vector<glm::vec2> uvs;
+	buildSphere(triangles, indices, positions, uvs, normals);
+
+	std::vector<MeshChunk> chunks;
+	partitionMesh(&indices[0], indices.size(), positions, 16384, chunks);
+	printPartitionReport(chunks, positions.size());
+
+	const char* path = "synthetic_sphere.chunks";
+	double t = now();
+	if(!writeChunkFile(path, chunks, positions, uvs, normals))
+	{
+		printf("Could not write %s\n", path);
+		return 1;
+	}
+	printf("Wrote %s in %.1f ms\n", path, (now() - t) * 1000.0);
+
+	run(path, (size_t)(budget_mb / 4 * 1024 * 1024), frames);
+	run(path, (size_t)(budget_mb * 1024 * 1024), frames);
+	run(path, (size_t)(budget_mb * 4 * 1024 * 1024), frames);
+	remove(path);
+	return 0;
+}
@@ -0,0 +1,129 @@
+// Worst frame time while a batch of textures comes in: loading them all with
+// TextureManager::Load in one frame, against LoadAsync with a per-frame upload budget.
+// usage: bench_texasync [texture count] [upload KB per frame] [upload ms per frame] [image.bmp]
+//
+// The textures are copies of the image, each a little different so none are shared.
+// Frame times cover the CPU work and glFinish, not the wait for the swap.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../common/startScreen.h"
+#include "../common/texturemanager.h"
+#include "../common/bmpfile.h"
+#include "benchmark.h"
+
+struct FrameStats
+{
+	int Frames;
+	double Worst, Total;
+	double Wall;   // first frame start to everything uploaded, swaps included
+};
+
+static bool writeCopies(const char* bmp, int count, std::vector<std::string>& out_paths)
+{
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(bmp, rgb, width, height))
+		return false;
+
+	for(int i = 0; i < count; i++)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "bench_async_%d.bmp", i);
+		rgb[0] = (unsigned char)i;
+		if(!writeBMP(path, &rgb[0], width, height))
+			return false;
+		out_paths.push_back(path);
+	}
+	return true;
+}
+
+static void frameDone(double start, FrameStats& stats)
+{
+	glFinish();
+	double t = now() - start;
+	stats.Frames++;
+	stats.Total += t;
+	if(t > stats.Worst)
+		stats.Worst = t;
+	updateScreen();
+}
+
+static FrameStats loadSync(const std::vector<std::string>& paths)
+{
+	FrameStats stats = { 0, 0.0, 0.0, 0.0 };
+	TextureManager manager;
+	std::vector<TextureHandle> textures;
+
+	double begin = now();
+	double start = now();
+	glClear(GL_COLOR_BUFFER_BIT);
+	for(size_t i = 0; i < paths.size(); i++)
+		textures.push_back(manager.Load(paths[i].c_str()));
+	frameDone(start, stats);
+	stats.Wall = now() - begin;
+
+	manager.PrintStats("  sync");
+	textures.clear();
+	return stats;
+}
+
+static FrameStats loadAsync(const std::vector<std::string>& paths, size_t budget_bytes, double budget_ms)
+{
+	FrameStats stats = { 0, 0.0, 0.0, 0.0 };
+	TextureManager manager;
+	std::vector<TextureHandle> textures;
+
+	double begin = now();
+	do
+	{
+		double start = now();
+		glClear(GL_COLOR_BUFFER_BIT);
+		if(textures.empty())
+			for(size_t i = 0; i < paths.size(); i++)
+				textures.push_back(manager.LoadAsync(paths[i].c_str()));
+		manager.Update(budget_bytes, budget_ms);
+		frameDone(start, stats);
+	}
+	while(manager.GetPendingCount());
+	stats.Wall = now() - begin;
+
+	manager.PrintStats("  async");
+	textures.clear();
+	return stats;
+}
+
+static void report(const char* label, const FrameStats& stats)
+{
+	printf("  %-6s %4d frames, worst %7.2f ms, mean %6.2f ms, all loaded after %7.1f ms\n", label,
+		stats.Frames, stats.Worst * 1000.0, stats.Total * 1000.0 / stats.Frames, stats.Wall * 1000.0);
+}
+
+int main(int argc, const char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 32;
+	size_t budget = (argc > 2 ? atoi(argv[2]) : 512) * 1024;
+	double budget_ms = argc > 3 ? atof(argv[3]) : 4.0;
+	const char* bmp = argc > 4 ? argv[4] : "uvtemplate.bmp";
+
+	InitGraphics();
+	std::vector<std::string> paths;
+	if(!writeCopies(bmp, count, paths))
+	{
+		printf("Could not write copies of %s\n", bmp);
+		return 1;
+	}
+
+	// the files are in the page cache for both runs
+	FrameStats sync = loadSync(paths);
+	FrameStats async = loadAsync(paths, budget, budget_ms);
+	for(size_t i = 0; i < paths.size(); i++)
+		remove(paths[i].c_str());
+
+	printf("\n%d textures from %s, async budget %u KB / %.1f ms per frame:\n", count, bmp, (unsigned)(budget / 1024), budget_ms);
+	report("sync", sync);
+	report("async", async);
+	return 0;
+}
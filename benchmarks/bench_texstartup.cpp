@@ -0,0 +1,129 @@
+// Startup cost of loading many textures: glGenerateMipmap at load time (loadBMP_custom)
+// against uploading a mip chain baked offline (loadKTX, and loadETC1 when the GPU has it),
+// and against asking a TextureManager, which loads the shared image only once.
+// usage: bench_texstartup [texture count] [image.bmp]
+//
+// The .ktx files are written first from the .bmp, the way tools/mipconvert and
+// tools/etc1convert make them, and the time that takes is reported as the offline cost.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../common/startScreen.h"
+#include "../common/texture.h"
+#include "../common/texturemanager.h"
+#include "../common/bmpfile.h"
+#include "../common/ktxfile.h"
+#include "../common/mipchain.h"
+#include "../common/etc1.h"
+#include "../common/glstate.h"
+#include "benchmark.h"
+
+#define MIPS_KTX "bench_mips.ktx"
+#define ETC1_KTX "bench_etc1.ktx"
+
+static bool bakeTextures(const char* bmp)
+{
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(bmp, rgb, width, height))
+		return false;
+
+	double t = now();
+	std::vector<MipLevel> mips;
+	buildMipChain(&rgb[0], width, height, 3, MIP_FILTER_KAISER, mips);
+	double filterTime = now() - t;
+
+	TextureImage plain, etc1;
+	plain.InternalFormat = plain.Format = KTX_RGB;
+	plain.Type = KTX_UNSIGNED_BYTE;
+	etc1.InternalFormat = KTX_ETC1_RGB8_OES;
+	etc1.Format = etc1.Type = 0;
+	plain.Levels.resize(mips.size());
+	etc1.Levels.resize(mips.size());
+	t = now();
+	for(size_t i = 0; i < mips.size(); i++)
+	{
+		setLevelPixels(plain.Levels[i], &mips[i].Pixels[0], mips[i].Width, mips[i].Height, 3);
+		etc1.Levels[i].Width = mips[i].Width;
+		etc1.Levels[i].Height = mips[i].Height;
+		encodeETC1Image(&mips[i].Pixels[0], mips[i].Width, mips[i].Height, ETC1_QUALITY_FAST, 0, etc1.Levels[i].Data);
+	}
+	double encodeTime = now() - t;
+
+	printf("offline, once per texture: %u levels Kaiser filtered in %.1f ms (%s), ETC1 (fast) in %.1f ms\n",
+		(unsigned)mips.size(), filterTime * 1000.0, mipChainBackend(), encodeTime * 1000.0);
+	return writeKTX(MIPS_KTX, plain) && writeKTX(ETC1_KTX, etc1);
+}
+
+// Loads count textures with load(), returns the seconds until the GPU is done with them
+static double loadAll(GLuint (*load)(const char*, TextureInfo*), const char* path, int count)
+{
+	std::vector<GLuint> textures(count);
+	glFinish();
+	double t = now();
+	for(int i = 0; i < count; i++)
+		textures[i] = load(path, NULL);
+	glFinish();
+	t = now() - t;
+
+	bool ok = true;
+	for(int i = 0; i < count; i++)
+		ok = ok && textures[i] != 0;
+	GGLState.DeleteTextures(count, &textures[0]);
+	return ok ? t : -1.0;
+}
+
+// The same through a TextureManager, the way scenes share textures
+static double loadShared(const char* path, int count)
+{
+	TextureManager manager;
+	std::vector<TextureHandle> textures(count);
+	glFinish();
+	double t = now();
+	for(int i = 0; i < count; i++)
+		textures[i] = manager.Load(path);
+	glFinish();
+	t = now() - t;
+
+	bool ok = textures[0].IsValid();
+	manager.PrintStats("  TextureManager");
+	textures.clear();
+	return ok ? t : -1.0;
+}
+
+static void report(const char* label, double t, int count, double baseline)
+{
+	if(t < 0.0)
+		printf("  %-34s not available\n", label);
+	else
+		printf("  %-34s %8.1f ms  %6.2f ms/texture  (%.2fx)\n", label, t * 1000.0, t * 1000.0 / count, baseline / t);
+}
+
+int main(int argc, const char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 64;
+	const char* bmp = argc > 2 ? argv[2] : "uvtemplate.bmp";
+
+	InitGraphics();
+	if(!bakeTextures(bmp))
+	{
+		printf("Could not bake %s\n", bmp);
+		return 1;
+	}
+
+	double runtime = loadAll(loadBMP_custom, bmp, count);
+	double prebuilt = loadAll(loadKTX, MIPS_KTX, count);
+	double compressed = loadAll(loadETC1, ETC1_KTX, count);
+	double shared = loadShared(MIPS_KTX, count);
+	remove(MIPS_KTX);
+	remove(ETC1_KTX);
+
+	printf("\n%d textures from %s:\n", count, bmp);
+	report("glGenerateMipmap at load", runtime, count, runtime);
+	report("pre-built RGB mip chain (loadKTX)", prebuilt, count, runtime);
+	report("pre-built ETC1 mip chain", compressed, count, runtime);
+	report("pre-built RGB, TextureManager", shared, count, runtime);
+	return 0;
+}
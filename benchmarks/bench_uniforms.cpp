@@ -0,0 +1,144 @@
+// CPU time per textured quad draw, the way DrawTextureRect used to set up its uniforms
+// (glGetUniformLocation and glGetAttribLocation by name every draw) against the
+// reflected program (indices looked up once, setters that skip unchanged values).
+// usage: bench_uniforms [draws per frame] [frames]
+//
+// Every quad has its own offset, scale and sampler stay the same, as for a row of sprites.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../common/startScreen.h"
+#include "../common/programreflect.h"
+#include "benchmark.h"
+
+static const char* GVertexSource =
+	"attribute vec4 vertex;\n"
+	"uniform vec2 offset;\n"
+	"uniform vec2 scale;\n"
+	"varying vec2 tcoord;\n"
+	"void main(void)\n"
+	"{\n"
+	"	tcoord = vertex.xy;\n"
+	"	gl_Position = vec4(vertex.xy * scale + offset, vertex.zw);\n"
+	"}\n";
+
+static const char* GFragmentSource =
+	"varying mediump vec2 tcoord;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_FragColor = texture2D(tex, tcoord);\n"
+	"}\n";
+
+static GLuint compile(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	return shader;
+}
+
+static void quadOffset(int i, int draws, float& x, float& y)
+{
+	int side = (int)sqrt((double)draws) + 1;
+	x = -1.0f + 2.0f * (i % side) / side;
+	y = -1.0f + 2.0f * (i / side) / side;
+}
+
+// DrawTextureRect before the reflection
+static void drawByName(GLuint program, int draws)
+{
+	for(int i = 0; i < draws; i++)
+	{
+		float x, y;
+		quadOffset(i, draws, x, y);
+		glUniform2f(glGetUniformLocation(program, "offset"), x, y);
+		glUniform2f(glGetUniformLocation(program, "scale"), 0.02f, 0.02f);
+		glUniform1i(glGetUniformLocation(program, "tex"), 0);
+		GLuint loc = glGetAttribLocation(program, "vertex");
+		glVertexAttribPointer(loc, 4, GL_FLOAT, 0, 16, 0);
+		glEnableVertexAttribArray(loc);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+}
+
+static void drawReflected(ProgramReflection& program, int offset, int scale, int tex, GLint vertex, int draws)
+{
+	for(int i = 0; i < draws; i++)
+	{
+		float x, y;
+		quadOffset(i, draws, x, y);
+		program.SetVec2(offset, x, y);
+		program.SetVec2(scale, 0.02f, 0.02f);
+		program.SetInt(tex, 0);
+		glVertexAttribPointer(vertex, 4, GL_FLOAT, 0, 16, 0);
+		glEnableVertexAttribArray(vertex);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	int draws = argc > 1 ? atoi(argv[1]) : 1000;
+	int frames = argc > 2 ? atoi(argv[2]) : 60;
+
+	InitGraphics();
+	GLuint program = glCreateProgram();
+	glAttachShader(program, compile(GL_VERTEX_SHADER, GVertexSource));
+	glAttachShader(program, compile(GL_FRAGMENT_SHADER, GFragmentSource));
+	glLinkProgram(program);
+	GLint linked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if(!linked)
+	{
+		printf("Could not link the benchmark program\n");
+		return 1;
+	}
+	glUseProgram(program);
+
+	static const GLfloat quad[] = { 0,0,1,1, 1,0,1,1, 0,1,1,1, 1,1,1,1 };
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	static const unsigned char white[4] = { 255, 255, 255, 255 };
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+	ProgramReflection reflection;
+	reflection.Reflect(program);
+	reflection.Print("program");
+	int offset = reflection.FindUniform("offset");
+	int scale = reflection.FindUniform("scale");
+	int tex = reflection.FindUniform("tex");
+	GLint vertex = reflection.FindAttrib("vertex");
+
+	double byName = 0.0, reflected = 0.0;
+	for(int f = 0; f < frames; f++)
+	{
+		// alternate so both see the same driver state and thermal conditions
+		glClear(GL_COLOR_BUFFER_BIT);
+		double start = now();
+		drawByName(program, draws);
+		byName += now() - start;
+		glFinish();
+
+		// the by name path changed the uniforms behind the cache's back
+		reflection.Forget();
+		start = now();
+		drawReflected(reflection, offset, scale, tex, vertex, draws);
+		reflected += now() - start;
+		glFinish();
+		updateScreen();
+	}
+
+	double calls = (double)draws * frames;
+	printf("\n%d draws x %d frames:\n", draws, frames);
+	printf("  by name    %6.2f us per draw\n", byName * 1e6 / calls);
+	printf("  reflected  %6.2f us per draw (%llu uniform uploads, %llu skipped)\n",
+		reflected * 1e6 / calls, reflection.Uploads, reflection.Skipped);
+	return 0;
+}
@@ -0,0 +1,140 @@
+// Post-transform cache efficiency before and after optimizeVertexCache/optimizeVertexFetch
+// usage: bench_vertexcache [model.obj] [synthetic triangle count] [cache size]
+//
+// The vertex work is the tutorial08 shader run on the CPU once per cache miss, which is
+// what the GPU pays for; the count does not depend on the host.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshoptimize.h"
+#include "benchmark.h"
+
+struct Vertex
+{
+	glm::vec3 Position;
+	glm::vec2 UV;
+	glm::vec3 Normal;
+};
+
+// Indexes the unrolled loadOBJ output in file order, the way an unoptimised exporter would
+static void indexInFileOrder(const char* path, std::vector<unsigned int>& indices, std::vector<Vertex>& vertices)
+{
+	std::vector<glm::vec3> v, n;
+	std::vector<glm::vec2> t;
+	loadOBJ(path, v, t, n);
+
+	std::map<std::vector<float>, unsigned int> seen;
+	for(size_t i = 0; i < v.size(); i++)
+	{
+		float key_data[8] = { v[i].x, v[i].y, v[i].z, t[i].x, t[i].y, n[i].x, n[i].y, n[i].z };
+		std::vector<float> key(key_data, key_data + 8);
+		std::map<std::vector<float>, unsigned int>::iterator it = seen.find(key);
+		if(it == seen.end())
+		{
+			Vertex vertex = { v[i], t[i], n[i] };
+			it = seen.insert(std::make_pair(key, (unsigned int)vertices.size())).first;
+			vertices.push_back(vertex);
+		}
+		indices.push_back(it->second);
+	}
+}
+
+// tutorial08's StandardShading.vertexshader, run for every vertex the FIFO misses
+static double shade(const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, unsigned int cache_size, float& checksum)
+{
+	glm::mat4 MVP(1.0f), V(1.0f), M(1.0f);
+	glm::vec3 light(4, 4, 4);
+	std::vector<unsigned int> entered(vertices.size(), 0);
+	unsigned int clock = cache_size + 1;
+	glm::vec4 sum(0.0f);
+
+	double t = now();
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		unsigned int& e = entered[indices[i]];
+		if(clock - e <= cache_size)
+			continue;
+		e = clock++;
+
+		const Vertex& vertex = vertices[indices[i]];
+		glm::vec4 position = MVP * glm::vec4(vertex.Position, 1);
+		glm::vec3 world = glm::vec3(M * glm::vec4(vertex.Position, 1));
+		glm::vec3 eye_position = glm::vec3(V * M * glm::vec4(vertex.Position, 1));
+		glm::vec3 eye_direction = glm::vec3(0, 0, 0) - eye_position;
+		glm::vec3 light_direction = glm::vec3(V * glm::vec4(light, 1)) + eye_direction;
+		glm::vec3 normal = glm::vec3(V * M * glm::vec4(vertex.Normal, 0));
+		sum += position + glm::vec4(world + light_direction + normal, vertex.UV.x + vertex.UV.y);
+	}
+	double elapsed = now() - t;
+	checksum = sum.x + sum.y + sum.z + sum.w;
+	return elapsed;
+}
+
+static void run(const char* label, std::vector<unsigned int> indices, std::vector<Vertex> vertices, unsigned int cache_size)
+{
+	float checksum;
+	VertexCacheStats before = analyzeVertexCache(&indices[0], indices.size(), vertices.size(), cache_size);
+	double shade_before = shade(indices, vertices, cache_size, checksum);
+
+	double t = now();
+	optimizeVertexCache(&indices[0], indices.size(), vertices.size());
+	std::vector<unsigned int> remap;
+	optimizeVertexFetch(&indices[0], indices.size(), vertices.size(), remap);
+	remapVertices(vertices, remap);
+	double optimize_time = now() - t;
+
+	VertexCacheStats after = analyzeVertexCache(&indices[0], indices.size(), vertices.size(), cache_size);
+	double shade_after = shade(indices, vertices, cache_size, checksum);
+
+	printf("%s\n", label);
+	printVertexCacheStats("  before", before);
+	printVertexCacheStats("  after ", after);
+	printf("  optimise %.3f ms, vertex shading %.3f ms -> %.3f ms (%.2fx fewer invocations)\n",
+		optimize_time * 1000.0, shade_before * 1000.0, shade_after * 1000.0,
+		(double)before.Transformed / after.Transformed);
+}
+
+int main(int argc, const char **argv)
+{
+	const char* model = argc > 1 ? argv[1] : "suzanne.obj";
+	int triangles = argc > 2 ? atoi(argv[2]) : 500000;
+	unsigned int cache_size = argc > 3 ? atoi(argv[3]) : 16;
+
+	std::vector<unsigned int> indices;
+	std::vector<Vertex> vertices;
+	indexInFileOrder(model, indices, vertices);
+	run(model, indices, vertices, cache_size);
+
+	const char* synthetic = "synthetic_sphere.obj";
+	if(!writeSphere(synthetic, triangles))
+	{
+		printf("Could not write %s\n", synthetic);
+		return 1;
+	}
+	indices.clear();
+	vertices.clear();
+	indexInFileOrder(synthetic, indices, vertices);
+	remove(synthetic);
+	run("sphere, ring order", indices, vertices, cache_size);
+
+	// triangle soup order, what a lot of exporters and merged meshes look like
+	std::vector<unsigned int> order(indices.size() / 3);
+	for(size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	srand(1);
+	std::random_shuffle(order.begin(), order.end());
+	std::vector<unsigned int> shuffled(indices.size());
+	for(size_t i = 0; i < order.size(); i++)
+		memcpy(&shuffled[i * 3], &indices[order[i] * 3], 3 * sizeof(unsigned int));
+	run("sphere, shuffled", shuffled, vertices, cache_size);
+
+	return 0;
+}
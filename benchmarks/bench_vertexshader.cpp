@@ -0,0 +1,122 @@
+// Vertex throughput of tutorial08's TransformVertexShader.glsl with V * M and the normal
+// transform done per vertex, against the PRECOMPUTED_MV variant that gets MV, the normal
+// matrix and the camera space light as uniforms.
+// usage: bench_vertexshader [triangles] [draws]
+//
+// The mesh is drawn into an 8 x 8 pixel viewport so the fragment shader costs next to
+// nothing and the times are the vertex shader's.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/startScreen.h"
+#include "../common/LoadShaders.h"
+#include "../common/meshfile.h"
+#include "../common/meshloader.h"
+#include "../common/glstate.h"
+#include "variant_shaders.h"
+#include "benchmark.h"
+
+// Same uniforms tutorial08 sets, each variant ignores the ones it lacks
+static void setUniforms(GfxProgram* program)
+{
+	glm::mat4 projection = glm::perspective(45.0f, 1.0f, 0.1f, 100.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+	glm::mat4 model = glm::mat4(1.0f);
+	glm::mat4 mvp = projection * view * model;
+	glm::mat4 mv = view * model;
+	glm::mat3 normal = glm::transpose(glm::inverse(glm::mat3(mv)));
+	glm::vec4 light = view * glm::vec4(4, 4, 4, 1);
+
+	program->SetMat4(program->GetUniform("MVP"), &mvp[0][0]);
+	program->SetMat4(program->GetUniform("M"), &model[0][0]);
+	program->SetMat4(program->GetUniform("V"), &view[0][0]);
+	program->SetMat4(program->GetUniform("MV"), &mv[0][0]);
+	program->SetMat3(program->GetUniform("NormalMatrix"), &normal[0][0]);
+	program->SetVec3(program->GetUniform("LightPosition_worldspace"), 4, 4, 4);
+	program->SetVec3(program->GetUniform("LightPosition_cameraspace"), light.x, light.y, light.z);
+	program->SetInt(program->GetUniform("myTextureSampler"), 0);
+}
+
+static double drawAll(GfxProgram* program, const MeshBuffers& mesh, int draws)
+{
+	VertexLayout layout;
+	describeMeshVertex(layout, "vertexPosition_modelspace", "vertexUV", "vertexNormal_modelspace");
+	layout.Bind(program->GetId());
+	GGLState.UseProgram(program->GetId());
+	setUniforms(program);
+	layout.Enable(mesh.VertexBuffer);
+	GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ElementBuffer);
+
+	// one draw outside the timing, some drivers finish the program on first use
+	glDrawElements(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_SHORT, 0);
+	glFinish();
+
+	double start = now();
+	for(int i = 0; i < draws; i++)
+		glDrawElements(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_SHORT, 0);
+	glFinish();
+	double t = now() - start;
+	layout.Disable();
+	return t;
+}
+
+int main(int argc, const char **argv)
+{
+	int triangles = argc > 1 ? atoi(argv[1]) : 60000;
+	int draws = argc > 2 ? atoi(argv[2]) : 100;
+
+	InitGraphics();
+
+	const char* synthetic = "synthetic_sphere.obj";
+	MeshBuffers mesh;
+	if(!writeSphere(synthetic, triangles) || !loadMeshBuffers(synthetic, mesh))
+	{
+		printf("Could not make %s\n", synthetic);
+		return 1;
+	}
+	remove(synthetic);
+	remove(meshCachePath(synthetic).c_str());
+
+	ShaderVariants shaders;
+	unsigned int precomputedMV = shaders.AddFeature("PRECOMPUTED_MV");
+	shaders.Load(GEmbeddedShaders, "TransformVertexShader.glsl", "TextureFragmentShader.glsl");
+	GfxProgram* perVertex = shaders.Get(0);
+	GfxProgram* precomputed = shaders.Get(precomputedMV);
+	if(!perVertex || !precomputed)
+		return 1;
+
+	static const unsigned char white[4] = { 255, 255, 255, 255 };
+	GLuint texture;
+	glGenTextures(1, &texture);
+	GGLState.BindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	GGLState.Enable(GL_DEPTH_TEST);
+	GGLState.Viewport(0, 0, 8, 8);
+
+	// alternated in rounds so both see the same clocks and temperature
+	const int rounds = 5;
+	double a = 0.0, b = 0.0;
+	for(int r = 0; r < rounds; r++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		a += drawAll(perVertex, mesh, draws);
+		b += drawAll(precomputed, mesh, draws);
+		updateScreen();
+	}
+
+	double vertices = (double)mesh.IndexCount * draws * rounds;
+	printf("\n%d vertices, %d indices, %d draws x %d rounds:\n", mesh.VertexCount, mesh.IndexCount, draws, rounds);
+	printf("  V * M per vertex  %7.3f ms per draw, %6.2f M indexed vertices/s\n",
+		a * 1000.0 / (draws * rounds), vertices / a * 1e-6);
+	printf("  PRECOMPUTED_MV    %7.3f ms per draw, %6.2f M indexed vertices/s\n",
+		b * 1000.0 / (draws * rounds), vertices / b * 1e-6);
+
+	GGLState.DeleteTextures(1, &texture);
+	deleteMeshBuffers(mesh);
+	shaders.Release();
+	return 0;
+}
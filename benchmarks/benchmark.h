@@ -0,0 +1,79 @@
+#pragma once
+
+// Bits shared by the benchmarks
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+inline double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Writes a UV sphere with roughly the requested number of triangles
+inline bool writeSphere(const char* path, int triangles)
+{
+	FILE* f = fopen(path, "w");
+	if(!f)
+		return false;
+
+	int rings = (int)sqrt(triangles / 2.0);
+	if(rings < 3) rings = 3;
+	int segments = rings;
+
+	fprintf(f, "# synthetic sphere, %d rings %d segments\n", rings, segments);
+	for(int r = 0; r <= rings; r++)
+	{
+		float phi = (float)M_PI * r / rings;
+		for(int s = 0; s <= segments; s++)
+		{
+			float theta = 2.0f * (float)M_PI * s / segments;
+			float x = sinf(phi) * cosf(theta), y = cosf(phi), z = sinf(phi) * sinf(theta);
+			fprintf(f, "v %f %f %f\n", x, y, z);
+			fprintf(f, "vt %f %f\n", (float)s / segments, (float)r / rings);
+			fprintf(f, "vn %f %f %f\n", x, y, z);
+		}
+	}
+	for(int r = 0; r < rings; r++)
+	{
+		for(int s = 0; s < segments; s++)
+		{
+			int a = r * (segments + 1) + s + 1, b = a + segments + 1;
+			fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+			fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+// Same UV sphere as writeSphere, built in memory so millions of triangles don't need an .obj
+inline void buildSphere(int triangles, std::vector<unsigned int>& indices, std::vector<glm::vec3>& positions,
+	std::vector<glm::vec2>& uvs, std::vector<glm::vec3>& normals)
+{
+	int rings = (int)sqrt(triangles / 2.0);
+	if(rings < 3) rings = 3;
+	int segments = rings;
+	for(int r = 0; r <= rings; r++)
+		for(int s = 0; s <= segments; s++)
+		{
+			float phi = (float)M_PI * r / rings, theta = 2.0f * (float)M_PI * s / segments;
+			glm::vec3 p(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+			positions.push_back(p);
+			normals.push_back(p);
+			uvs.push_back(glm::vec2((float)s / segments, -(float)r / rings));
+		}
+	for(int r = 0; r < rings; r++)
+		for(int s = 0; s < segments; s++)
+		{
+			unsigned int a = r * (segments + 1) + s, b = a + segments + 1;
+			unsigned int quad[6] = { a, b, a + 1, a + 1, b, b + 1 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+}
@@ -11,8 +11,9 @@
 #include <assert.h>
 
 #include "LoadShaders.h"
-
-#define check() assert(glGetError() == 0)
+#include "programcache.h"
+#include "glstate.h"
+#include "glcheck.h"
 
 GfxShader GSimpleVS;
 GfxShader GSimpleFS;
@@ -24,7 +25,20 @@ GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path
         GSimpleFS.LoadFragmentShader(fragment_file_path); //"simplefragshader.glsl");
         GSimpleProg.Create(&GSimpleVS,&GSimpleFS);
         check();
-        glUseProgram(GSimpleProg.GetId());
+        GGLState.UseProgram(GSimpleProg.GetId());
+        check();
+        return GSimpleProg.GetId();
+}
+
+GLuint LoadShaders(const EmbeddedShader* shaders, const char* vertex_name, const char* fragment_name){
+        std::string vertex_source, fragment_source;
+        if(!findShaderSource(shaders, vertex_name, vertex_source) || !findShaderSource(shaders, fragment_name, fragment_source))
+                return 0;
+        GSimpleVS.SetVertexSource(vertex_source.c_str());
+        GSimpleFS.SetFragmentSource(fragment_source.c_str());
+        GSimpleProg.Create(&GSimpleVS,&GSimpleFS);
+        check();
+        GGLState.UseProgram(GSimpleProg.GetId());
         check();
         return GSimpleProg.GetId();
 }
@@ -43,16 +57,7 @@ bool GfxShader::LoadFragmentShader(const char* filename)
         Src[sz] = 0; //null terminate it!
         fclose(f);
 
-        //now create and compile the shader
-//      GlShaderType = GL_FRAGMENT_SHADER;
-        Id = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(Id, 1, (const GLchar**)&Src, 0);
-        glCompileShader(Id);
-        check();
-
-        //compilation check
-//      GLint compiled;
-
+        GlShaderType = GL_FRAGMENT_SHADER;
         return true;
 }
 
@@ -71,8 +76,36 @@ bool GfxShader::LoadVertexShader(const char* filename)
         Src[sz] = 0; //null terminate it!
         fclose(f);
 
-        //now create and compile the shader
         GlShaderType = GL_VERTEX_SHADER;
+        return true;
+}
+
+bool GfxShader::SetFragmentSource(const char* source)
+{
+        assert(!Src);
+        size_t sz = strlen(source);
+        Src = new GLchar[sz+1];
+        memcpy(Src, source, sz+1);
+        GlShaderType = GL_FRAGMENT_SHADER;
+        return true;
+}
+
+bool GfxShader::SetVertexSource(const char* source)
+{
+        assert(!Src);
+        size_t sz = strlen(source);
+        Src = new GLchar[sz+1];
+        memcpy(Src, source, sz+1);
+        GlShaderType = GL_VERTEX_SHADER;
+        return true;
+}
+
+bool GfxShader::Compile()
+{
+        if(Id)
+                return true;
+
+        //now create and compile the shader
         Id = glCreateShader(GlShaderType);
         glShaderSource(Id, 1, (const GLchar**)&Src, 0);
         glCompileShader(Id);
@@ -85,13 +118,121 @@ bool GfxProgram::Create(GfxShader* vertex_shader, GfxShader* fragment_shader)
 {
         VertexShader = vertex_shader;
         FragmentShader = fragment_shader;
+
+        // a binary saved by an earlier run skips compiling and linking altogether
+        unsigned long long key = GProgramCache.Key(VertexShader->GetSource(), FragmentShader->GetSource());
+        Id = GProgramCache.Load(key);
+        if(Id)
+        {
+                Reflection.Reflect(Id);
+                return true;
+        }
+
+        VertexShader->Compile();
+        FragmentShader->Compile();
         Id = glCreateProgram();
         glAttachShader(Id, VertexShader->GetId());
         glAttachShader(Id, FragmentShader->GetId());
         glLinkProgram(Id);
         check();
+        Reflection.Reflect(Id);
+        GProgramCache.Save(key, Id);
 
         return true;    
 }
 
 
+
+struct ShaderVariant
+{
+        unsigned int Features;
+        bool Linked;
+        GfxShader VertexShader;
+        GfxShader FragmentShader;
+        GfxProgram Program;
+};
+
+// The defines go first, after #version when there is one since that has to stay first
+static std::string withDefines(const std::string& source, const std::string& defines)
+{
+        if(source.compare(0, 8, "#version") != 0)
+                return defines + source;
+        size_t end = source.find('\n');
+        if(end == std::string::npos)
+                return source + "\n" + defines;
+        return source.substr(0, end + 1) + defines + source.substr(end + 1);
+}
+
+unsigned int ShaderVariants::AddFeature(const char* name)
+{
+        assert(FeatureNames.size() < 32);
+        FeatureNames.push_back(name);
+        return 1u << (FeatureNames.size() - 1);
+}
+
+bool ShaderVariants::Load(const char* vertex_path, const char* fragment_path)
+{
+        Release();
+        if(!readShaderFile(vertex_path, VertexSource) || !readShaderFile(fragment_path, FragmentSource))
+        {
+                printf("Could not read %s or %s\n", vertex_path, fragment_path);
+                return false;
+        }
+        return true;
+}
+
+bool ShaderVariants::Load(const EmbeddedShader* shaders, const char* vertex_name, const char* fragment_name)
+{
+        Release();
+        return findShaderSource(shaders, vertex_name, VertexSource) && findShaderSource(shaders, fragment_name, FragmentSource);
+}
+
+GfxProgram* ShaderVariants::Get(unsigned int features)
+{
+        for(size_t i = 0; i < Variants.size(); i++)
+                if(Variants[i]->Features == features)
+                        return Variants[i]->Linked ? &Variants[i]->Program : NULL;
+
+        std::string defines;
+        for(size_t i = 0; i < FeatureNames.size(); i++)
+                if(features & (1u << i))
+                        defines += "#define " + FeatureNames[i] + " 1\n";
+
+        // kept even when it fails, so a broken combination is only reported once
+        ShaderVariant* variant = new ShaderVariant;
+        variant->Features = features;
+        Variants.push_back(variant);
+        variant->VertexShader.SetVertexSource(withDefines(VertexSource, defines).c_str());
+        variant->FragmentShader.SetFragmentSource(withDefines(FragmentSource, defines).c_str());
+        variant->Program.Create(&variant->VertexShader, &variant->FragmentShader);
+        Compiled++;
+
+        GLint linked = 0;
+        glGetProgramiv(variant->Program.GetId(), GL_LINK_STATUS, &linked);
+        variant->Linked = linked != 0;
+        if(!linked)
+        {
+                char log[512];
+                glGetProgramInfoLog(variant->Program.GetId(), sizeof(log), NULL, log);
+                printf("Shader variant 0x%x did not link:\n%s\n", features, log);
+                return NULL;
+        }
+        return &variant->Program;
+}
+
+void ShaderVariants::Release()
+{
+        for(size_t i = 0; i < Variants.size(); i++)
+        {
+                ShaderVariant* variant = Variants[i];
+                if(variant->Program.GetId())
+                        GGLState.DeleteProgram(variant->Program.GetId());
+                if(variant->VertexShader.GetId())
+                        glDeleteShader(variant->VertexShader.GetId());
+                if(variant->FragmentShader.GetId())
+                        glDeleteShader(variant->FragmentShader.GetId());
+                delete variant;
+        }
+        Variants.clear();
+        Compiled = 0;
+}
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "GLES2/gl2.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
+#include "programreflect.h"
+#include "shadersource.h"
 
 GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
+// The same from a table made by the embed_shaders CMake function, no files read unless
+// SHADER_DIR is set (see shadersource.h)
+GLuint LoadShaders(const EmbeddedShader* shaders, const char* vertex_name, const char* fragment_name);
 
 class GfxShader
 {
@@ -17,8 +25,16 @@ public:
 	GfxShader() : Src(NULL), Id(0), GlShaderType(0) {}
 	~GfxShader() { if(Src) delete[] Src; }
 
+	// Read the source, it is compiled later by Compile
 	bool LoadVertexShader(const char* filename);
 	bool LoadFragmentShader(const char* filename);
+	// Or take a source already in memory, it is copied
+	bool SetVertexSource(const char* source);
+	bool SetFragmentSource(const char* source);
+	// Compiles once, GfxProgram::Create calls it when the program isn't in the binary cache
+	// (programcache.h). GetId() is 0 until then.
+	bool Compile();
+	const GLchar* GetSource() { return Src; }
 	GLuint GetId() { return Id; }
 };
 
@@ -27,12 +43,66 @@ class GfxProgram
 	GfxShader* VertexShader;
 	GfxShader* FragmentShader;
 	GLuint Id;
+	ProgramReflection Reflection;
 
 public:
 
-	GfxProgram() {}
+	GfxProgram() : VertexShader(NULL), FragmentShader(NULL), Id(0) {}
 	~GfxProgram() {}
 
 	bool Create(GfxShader* vertex_shader, GfxShader* fragment_shader);
 	GLuint GetId() { return Id; }
+
+	// Active uniforms and attributes, enumerated once by Create (see programreflect.h).
+	// Look the indices up at init, not per draw.
+	int GetUniform(const char* name) const { return Reflection.FindUniform(name); }
+	GLint GetAttrib(const char* name) const { return Reflection.FindAttrib(name); }
+	ProgramReflection& GetReflection() { return Reflection; }
+
+	// Upload only what changed, with the program in use
+	void SetInt(int uniform, GLint value) { Reflection.SetInt(uniform, value); }
+	void SetFloat(int uniform, GLfloat value) { Reflection.SetFloat(uniform, value); }
+	void SetVec2(int uniform, GLfloat x, GLfloat y) { Reflection.SetVec2(uniform, x, y); }
+	void SetVec3(int uniform, GLfloat x, GLfloat y, GLfloat z) { Reflection.SetVec3(uniform, x, y, z); }
+	void SetVec4(int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w) { Reflection.SetVec4(uniform, x, y, z, w); }
+	void SetMat3(int uniform, const GLfloat* m) { Reflection.SetMat3(uniform, m); }
+	void SetMat4(int uniform, const GLfloat* m) { Reflection.SetMat4(uniform, m); }
+};
+
+struct ShaderVariant;
+
+// One pair of shader sources built several ways with #define switches. Bit i of a feature
+// mask defines the i-th name added as 1 at the top of both shaders; each mask is compiled
+// the first time it is asked for and kept (and its binary goes to GProgramCache).
+//   ShaderVariants shaders;
+//   unsigned int fog = shaders.AddFeature("FOG");
+//   shaders.Load(GEmbeddedShaders, "vert.glsl", "frag.glsl");
+//   GfxProgram* program = shaders.Get(fog);
+class ShaderVariants
+{
+	std::string VertexSource;
+	std::string FragmentSource;
+	std::vector<std::string> FeatureNames;
+	std::vector<ShaderVariant*> Variants;
+	int Compiled;
+
+public:
+
+	ShaderVariants() : Compiled(0) {}
+	~ShaderVariants() { Release(); }
+
+	// The mask bit for a new feature, at most 32 of them
+	unsigned int AddFeature(const char* name);
+
+	bool Load(const char* vertex_path, const char* fragment_path);
+	bool Load(const EmbeddedShader* shaders, const char* vertex_name, const char* fragment_name);
+
+	// NULL when that combination doesn't compile or link
+	GfxProgram* Get(unsigned int features);
+
+	// Deletes every variant's program and shaders, the next Get builds them again
+	void Release();
+
+	// Variants built since the last Release
+	int GetCompiled() const { return Compiled; }
 };
@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "atlaspacker.h"
+#include "ktxfile.h"
+
+#define ATLAS_VERSION 1
+
+void AtlasPacker::Init(int width, int height)
+{
+	Width = width;
+	Height = height;
+	UsedArea = 0;
+	Rect all = { 0, 0, width, height };
+	Free.assign(1, all);
+}
+
+bool AtlasPacker::Insert(int width, int height, int& out_x, int& out_y)
+{
+	// best short side fit: the free rectangle that leaves the least on its tighter side
+	int best = -1, bestShort = 0, bestLong = 0;
+	for(size_t i = 0; i < Free.size(); i++)
+	{
+		const Rect& r = Free[i];
+		if(r.Width < width || r.Height < height)
+			continue;
+		int leftW = r.Width - width, leftH = r.Height - height;
+		int shortSide = std::min(leftW, leftH), longSide = std::max(leftW, leftH);
+		if(best < 0 || shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+		{
+			best = (int)i;
+			bestShort = shortSide;
+			bestLong = longSide;
+		}
+	}
+	if(best < 0)
+		return false;
+
+	Rect used = { Free[best].X, Free[best].Y, width, height };
+	Split(used);
+	Prune();
+	UsedArea += (size_t)width * height;
+	out_x = used.X;
+	out_y = used.Y;
+	return true;
+}
+
+// Every free rectangle the new one overlaps is replaced by the up to four pieces left around it
+void AtlasPacker::Split(const Rect& used)
+{
+	std::vector<Rect> next;
+	next.reserve(Free.size() + 4);
+	for(size_t i = 0; i < Free.size(); i++)
+	{
+		const Rect& r = Free[i];
+		if(used.X >= r.X + r.Width || used.X + used.Width <= r.X || used.Y >= r.Y + r.Height || used.Y + used.Height <= r.Y)
+		{
+			next.push_back(r);
+			continue;
+		}
+
+		if(used.X > r.X)
+		{
+			Rect left = { r.X, r.Y, used.X - r.X, r.Height };
+			next.push_back(left);
+		}
+		if(used.X + used.Width < r.X + r.Width)
+		{
+			Rect right = { used.X + used.Width, r.Y, r.X + r.Width - (used.X + used.Width), r.Height };
+			next.push_back(right);
+		}
+		if(used.Y > r.Y)
+		{
+			Rect below = { r.X, r.Y, r.Width, used.Y - r.Y };
+			next.push_back(below);
+		}
+		if(used.Y + used.Height < r.Y + r.Height)
+		{
+			Rect above = { r.X, used.Y + used.Height, r.Width, r.Y + r.Height - (used.Y + used.Height) };
+			next.push_back(above);
+		}
+	}
+	Free.swap(next);
+}
+
+// Drops free rectangles that sit wholly inside another
+void AtlasPacker::Prune()
+{
+	for(size_t i = 0; i < Free.size(); i++)
+	{
+		for(size_t j = i + 1; j < Free.size(); j++)
+		{
+			const Rect& a = Free[i];
+			const Rect& b = Free[j];
+			if(a.X >= b.X && a.Y >= b.Y && a.X + a.Width <= b.X + b.Width && a.Y + a.Height <= b.Y + b.Height)
+			{
+				Free.erase(Free.begin() + i);
+				i--;
+				break;
+			}
+			if(b.X >= a.X && b.Y >= a.Y && b.X + b.Width <= a.X + a.Width && b.Y + b.Height <= a.Y + a.Height)
+			{
+				Free.erase(Free.begin() + j);
+				j--;
+			}
+		}
+	}
+}
+
+// Biggest first packs tighter, ties go to the larger area
+struct SourceOrder
+{
+	const std::vector<AtlasSource>* Sources;
+
+	bool operator()(size_t a, size_t b) const
+	{
+		const AtlasSource& sa = (*Sources)[a];
+		const AtlasSource& sb = (*Sources)[b];
+		int ma = std::max(sa.Width, sa.Height), mb = std::max(sb.Width, sb.Height);
+		if(ma != mb)
+			return ma > mb;
+		return sa.Width * sa.Height > sb.Width * sb.Height;
+	}
+};
+
+// Copies the image in with its border pixels repeated out over the padding
+static void blitPadded(const AtlasSource& source, int padding, int x, int y, AtlasPage& page)
+{
+	for(int py = -padding; py < source.Height + padding; py++)
+	{
+		int sy = std::min(std::max(py, 0), source.Height - 1);
+		unsigned char* dst = &page.Pixels[((size_t)(y + py) * page.Width + x - padding) * 4];
+		for(int px = -padding; px < source.Width + padding; px++, dst += 4)
+		{
+			int sx = std::min(std::max(px, 0), source.Width - 1);
+			memcpy(dst, source.Pixels + ((size_t)sy * source.Width + sx) * 4, 4);
+		}
+	}
+}
+
+static int nextPowerOfTwo(int v)
+{
+	int p = 1;
+	while(p < v)
+		p *= 2;
+	return p;
+}
+
+void setAtlasUVs(AtlasRegion& region, int page_width, int page_height)
+{
+	region.U0 = (float)region.X / page_width;
+	region.V0 = (float)region.Y / page_height;
+	region.U1 = (float)(region.X + region.Width) / page_width;
+	region.V1 = (float)(region.Y + region.Height) / page_height;
+}
+
+bool buildAtlas(const std::vector<AtlasSource>& sources, int page_size, int padding, AtlasLayout& out_layout)
+{
+	out_layout.Pages.clear();
+	out_layout.Regions.assign(sources.size(), AtlasRegion());
+
+	std::vector<size_t> order(sources.size());
+	for(size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	SourceOrder compare = { &sources };
+	std::sort(order.begin(), order.end(), compare);
+
+	// packers for the pages still open, the images go in the first that has room
+	std::vector<AtlasPacker> packers;
+	std::vector<int> usedHeight;
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		const AtlasSource& source = sources[ order[i] ];
+		int w = source.Width + padding * 2, h = source.Height + padding * 2;
+		if(w > page_size || h > page_size)
+		{
+			printf("%s (%dx%d) does not fit a %d atlas page\n", source.Name.c_str(), source.Width, source.Height, page_size);
+			return false;
+		}
+
+		int x = 0, y = 0;
+		size_t page = 0;
+		while(page < packers.size() && !packers[page].Insert(w, h, x, y))
+			page++;
+		if(page == packers.size())
+		{
+			packers.push_back(AtlasPacker());
+			packers.back().Init(page_size, page_size);
+			packers.back().Insert(w, h, x, y);
+			usedHeight.push_back(0);
+		}
+		usedHeight[page] = std::max(usedHeight[page], y + h);
+
+		AtlasRegion& region = out_layout.Regions[ order[i] ];
+		region.Name = source.Name;
+		region.Page = page;
+		region.X = x + padding;
+		region.Y = y + padding;
+		region.Width = source.Width;
+		region.Height = source.Height;
+	}
+
+	// the last page is usually part empty, pack it again into the shortest page that holds it
+	if(!packers.empty())
+	{
+		unsigned int last = packers.size() - 1;
+		for(int height = page_size / 2; height >= 1; height /= 2)
+		{
+			AtlasPacker packer;
+			packer.Init(page_size, height);
+			std::vector<int> xs, ys;
+			bool fits = true;
+			for(size_t i = 0; i < order.size() && fits; i++)
+			{
+				const AtlasRegion& region = out_layout.Regions[ order[i] ];
+				if(region.Page != last)
+					continue;
+				int x, y;
+				fits = packer.Insert(region.Width + padding * 2, region.Height + padding * 2, x, y);
+				xs.push_back(x);
+				ys.push_back(y);
+			}
+			if(!fits)
+				break;
+
+			usedHeight[last] = 0;
+			for(size_t i = 0, n = 0; i < order.size(); i++)
+			{
+				AtlasRegion& region = out_layout.Regions[ order[i] ];
+				if(region.Page != last)
+					continue;
+				region.X = xs[n] + padding;
+				region.Y = ys[n] + padding;
+				usedHeight[last] = std::max(usedHeight[last], ys[n] + region.Height + padding * 2);
+				n++;
+			}
+		}
+	}
+
+	out_layout.Pages.resize(packers.size());
+	for(size_t p = 0; p < packers.size(); p++)
+	{
+		AtlasPage& page = out_layout.Pages[p];
+		page.Width = page_size;
+		page.Height = std::min(nextPowerOfTwo(usedHeight[p]), page_size);
+		page.Pixels.assign((size_t)page.Width * page.Height * 4, 0);
+		page.UsedPixels = 0;
+	}
+	for(size_t i = 0; i < sources.size(); i++)
+	{
+		AtlasRegion& region = out_layout.Regions[i];
+		AtlasPage& page = out_layout.Pages[region.Page];
+		blitPadded(sources[i], padding, region.X, region.Y, page);
+		page.UsedPixels += (size_t)region.Width * region.Height;
+		setAtlasUVs(region, page.Width, page.Height);
+	}
+	return true;
+}
+
+static std::string pagePath(const char* path, size_t page)
+{
+	std::string base = path;
+	size_t dot = base.rfind('.');
+	if(dot != std::string::npos && base.find('/', dot) == std::string::npos)
+		base.erase(dot);
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), "_%u.ktx", (unsigned)page);
+	return base + suffix;
+}
+
+bool writeAtlas(const char* path, const AtlasLayout& layout)
+{
+	FILE* f = fopen(path, "w");
+	if(!f)
+		return false;
+
+	fprintf(f, "atlas %d\n", ATLAS_VERSION);
+	bool ok = true;
+	for(size_t p = 0; p < layout.Pages.size() && ok; p++)
+	{
+		const AtlasPage& page = layout.Pages[p];
+		std::string file = pagePath(path, p);
+		// the .atlas names its pages relative to itself
+		size_t slash = file.rfind('/');
+		fprintf(f, "page %u %s %d %d\n", (unsigned)p, file.c_str() + (slash == std::string::npos ? 0 : slash + 1), page.Width, page.Height);
+
+		TextureImage image;
+		image.InternalFormat = KTX_RGBA;
+		image.Format = KTX_RGBA;
+		image.Type = KTX_UNSIGNED_BYTE;
+		image.Levels.resize(1);
+		setLevelPixels(image.Levels[0], &page.Pixels[0], page.Width, page.Height, 4);
+		ok = writeKTX(file.c_str(), image);
+	}
+	for(size_t i = 0; i < layout.Regions.size(); i++)
+	{
+		const AtlasRegion& r = layout.Regions[i];
+		fprintf(f, "region %s %u %d %d %d %d\n", r.Name.c_str(), r.Page, r.X, r.Y, r.Width, r.Height);
+	}
+	return fclose(f) == 0 && ok;
+}
+
+bool readAtlas(const char* path, std::vector<std::string>& out_pages, std::vector<AtlasRegion>& out_regions)
+{
+	FILE* f = fopen(path, "r");
+	if(!f)
+	{
+		printf("%s could not be opened\n", path);
+		return false;
+	}
+
+	std::string dir = path;
+	size_t slash = dir.rfind('/');
+	dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+	int version = 0;
+	if(fscanf(f, "atlas %d\n", &version) != 1 || version != ATLAS_VERSION)
+	{
+		printf("%s is not a version %d atlas\n", path, ATLAS_VERSION);
+		fclose(f);
+		return false;
+	}
+
+	out_pages.clear();
+	out_regions.clear();
+	std::vector<int> widths, heights;
+	char kind[16], name[256];
+	bool ok = true;
+	while(ok && fscanf(f, "%15s", kind) == 1)
+	{
+		if(strcmp(kind, "page") == 0)
+		{
+			unsigned int index;
+			int width, height;
+			ok = fscanf(f, "%u %255s %d %d", &index, name, &width, &height) == 4 && index == out_pages.size();
+			out_pages.push_back(dir + name);
+			widths.push_back(width);
+			heights.push_back(height);
+		}
+		else if(strcmp(kind, "region") == 0)
+		{
+			AtlasRegion r;
+			ok = fscanf(f, "%255s %u %d %d %d %d", name, &r.Page, &r.X, &r.Y, &r.Width, &r.Height) == 6 && r.Page < out_pages.size();
+			if(ok)
+			{
+				r.Name = name;
+				setAtlasUVs(r, widths[r.Page], heights[r.Page]);
+				out_regions.push_back(r);
+			}
+		}
+		else
+			ok = false;
+	}
+	fclose(f);
+	if(!ok)
+		printf("%s is corrupt\n", path);
+	return ok;
+}
+
+void printAtlasReport(const AtlasLayout& layout)
+{
+	size_t used = 0, total = 0;
+	for(size_t p = 0; p < layout.Pages.size(); p++)
+	{
+		const AtlasPage& page = layout.Pages[p];
+		size_t area = (size_t)page.Width * page.Height;
+		printf("  page %u: %dx%d, %.1f%% filled\n", (unsigned)p, page.Width, page.Height, 100.0 * page.UsedPixels / area);
+		used += page.UsedPixels;
+		total += area;
+	}
+	printf("  %u images on %u pages, %.1f%% filled overall\n", (unsigned)layout.Regions.size(),
+		(unsigned)layout.Pages.size(), total ? 100.0 * used / total : 0.0);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Packs many small images into a few big pages so sprites and HUD icons can share one
+// texture bind. MaxRects with the best short side fit, no rotation. Each image gets
+// `padding` pixels of its own edge repeated around it so linear filtering doesn't pick
+// up the neighbours. No GL here, tools/atlaspack runs it offline and TextureAtlas at runtime.
+
+// Rectangle bin packer for one page
+class AtlasPacker
+{
+	struct Rect
+	{
+		int X, Y, Width, Height;
+	};
+
+	int Width, Height;
+	std::vector<Rect> Free;
+	size_t UsedArea;
+
+	void Split(const Rect& used);
+	void Prune();
+
+public:
+
+	AtlasPacker() : Width(0), Height(0), UsedArea(0) {}
+
+	void Init(int width, int height);
+	// Finds room for a width x height rectangle, false when the page is too full
+	bool Insert(int width, int height, int& out_x, int& out_y);
+	// Fraction of the page taken so far
+	float GetOccupancy() { return (float)UsedArea / ((float)Width * Height); }
+};
+
+// An RGBA image to go into an atlas, the pixels must stay alive until buildAtlas returns
+struct AtlasSource
+{
+	std::string Name;
+	int Width, Height;
+	const unsigned char* Pixels;
+};
+
+// Where an image ended up. The UVs cover the image without its padding, rows in upload order.
+struct AtlasRegion
+{
+	std::string Name;
+	unsigned int Page;
+	int X, Y, Width, Height;
+	float U0, V0, U1, V1;
+};
+
+struct AtlasPage
+{
+	int Width, Height;
+	std::vector<unsigned char> Pixels;   // RGBA
+	size_t UsedPixels;                   // by images, not counting padding
+};
+
+struct AtlasLayout
+{
+	std::vector<AtlasPage> Pages;
+	std::vector<AtlasRegion> Regions;    // in the order of the sources
+};
+
+// Packs every source into pages of at most page_size x page_size, starting a new page when
+// one fills up. The last page is then repacked into the smallest power of two height that holds it.
+// False when an image is bigger than a page.
+bool buildAtlas(const std::vector<AtlasSource>& sources, int page_size, int padding, AtlasLayout& out_layout);
+
+// Fills in a region's UVs from its page size
+void setAtlasUVs(AtlasRegion& region, int page_width, int page_height);
+
+// "name.atlas" lists the regions, the pages go next to it as name_0.ktx, name_1.ktx...
+bool writeAtlas(const char* path, const AtlasLayout& layout);
+// Reads the list back, out_pages gets the page file paths
+bool readAtlas(const char* path, std::vector<std::string>& out_pages, std::vector<AtlasRegion>& out_regions);
+
+// Pages, sizes and how full they are
+void printAtlasReport(const AtlasLayout& layout);
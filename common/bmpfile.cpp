@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bmpfile.h"
+#include "pixelconvert.h"
+
+// Largest width or height readBMP takes, past what GLES2 on the Pi can upload anyway
+#define BMP_MAX_SIZE 16384
+
+// Header fields are little endian and not aligned for int loads
+static unsigned int getField(const unsigned char * p, int bytes){
+	unsigned int value = 0;
+	for (int i=0; i<bytes; i++)
+		value |= (unsigned int)p[i] << (i*8);
+	return value;
+}
+
+bool readBMP(const char * imagepath, std::vector<unsigned char> & out_rgb, unsigned int & out_width, unsigned int & out_height){
+
+	printf("Reading image %s\n", imagepath);
+
+	// Data read from the header of the BMP file
+	unsigned char header[54];
+	unsigned int dataPos;
+	unsigned int imageSize;
+	unsigned int width, height;
+
+	// Open the file
+	FILE * file = fopen(imagepath,"rb");
+	if (!file){
+		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
+		return false;
+	}
+
+	// Read the header, i.e. the 54 first bytes
+
+	// If less than 54 bytes are read, problem
+	if ( fread(header, 1, 54, file)!=54 ){
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return false;
+	}
+	// A BMP files always begins with "BM"
+	if ( header[0]!='B' || header[1]!='M' ){
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return false;
+	}
+	// Make sure this is a 24bpp file
+	if ( getField(&header[0x1E], 4)!=0 || getField(&header[0x1C], 2)!=24 ){
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return false;
+	}
+
+	// Read the information about the image
+	dataPos    = getField(&header[0x0A], 4);
+	imageSize  = getField(&header[0x22], 4);
+	width      = getField(&header[0x12], 4);
+	height     = getField(&header[0x16], 4);
+
+	// A negative height means the rows are stored top-down
+	bool topDown = (int)height < 0;
+	if (topDown)         height = 0u - height;
+	if (width==0 || height==0 || width>BMP_MAX_SIZE || height>BMP_MAX_SIZE){
+		printf("%s is %u x %u, not between 1 and %d pixels a side\n", imagepath, width, height, BMP_MAX_SIZE);
+		fclose(file);
+		return false;
+	}
+	// 3 : one byte for each Blue, Green and Red component, rows padded to 4 bytes
+	size_t rowSize = ((size_t)width*3 + 3) & ~(size_t)3;
+	size_t dataSize = rowSize*height;
+
+	// Some BMP files are misformatted, guess missing information
+	if (imageSize==0)    imageSize=(unsigned int)dataSize;
+	if (dataPos==0)      dataPos=54; // The BMP header is done that way
+	if (imageSize<dataSize){
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return false;
+	}
+
+	// Read the actual data from the file, the padding after it isn't needed
+	std::vector<unsigned char> data(dataSize);
+	fseek(file, dataPos, SEEK_SET);
+	bool ok = fread(&data[0],1,dataSize,file) == dataSize;
+
+	// Everything is in memory now, the file can be closed
+	fclose (file);
+	if (!ok){
+		printf("%s is truncated\n", imagepath);
+		return false;
+	}
+
+	// GLES2 has no GL_BGR, swap to RGB while dropping the row padding
+	out_rgb.resize((size_t)width*height*3);
+	for (unsigned int y=0; y<height; y++)
+		convertBGRToRGB(&data[y*rowSize], &out_rgb[(size_t)y*width*3], width);
+	if (topDown)
+		flipRows(&out_rgb[0], (size_t)width*3, height);
+
+	out_width = width;
+	out_height = height;
+	return true;
+}
+
+// Little endian field at any alignment, the header's ints are not 4 byte aligned
+static void putField(unsigned char * p, unsigned int value, int bytes){
+	for (int i=0; i<bytes; i++)
+		p[i] = (unsigned char)(value >> (i*8));
+}
+
+bool writeBMP(const char * imagepath, const unsigned char * rgb, unsigned int width, unsigned int height){
+
+	unsigned int rowSize = (width*3 + 3) & ~3u;
+	unsigned char header[54];
+	memset(header, 0, sizeof(header));
+	header[0] = 'B';
+	header[1] = 'M';
+	putField(&header[0x02], 54 + rowSize*height, 4);
+	putField(&header[0x0A], 54, 4);
+	putField(&header[0x0E], 40, 4);
+	putField(&header[0x12], width, 4);
+	putField(&header[0x16], height, 4);
+	putField(&header[0x1A], 1, 2);
+	putField(&header[0x1C], 24, 2);
+	putField(&header[0x22], rowSize*height, 4);
+
+	FILE * file = fopen(imagepath,"wb");
+	if (!file)
+		return false;
+
+	std::vector<unsigned char> row(rowSize, 0);
+	bool ok = fwrite(header, 1, 54, file) == 54;
+	for (unsigned int y=0; ok && y<height; y++){
+		// the swap is its own inverse
+		convertBGRToRGB(rgb + y*width*3, &row[0], width);
+		ok = fwrite(&row[0], 1, rowSize, file) == rowSize;
+	}
+	return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+// Reads an uncompressed 24 bit .BMP into tightly packed RGB rows, bottom row first
+// (the order glTexImage2D wants). No GL needed, the offline tools use it too. Fails for
+// a width or height of 0 or past 16384.
+bool readBMP(const char * imagepath, std::vector<unsigned char> & out_rgb, unsigned int & out_width, unsigned int & out_height);
+
+// Writes tightly packed RGB rows, bottom row first, as a 24 bit .BMP
+bool writeBMP(const char * imagepath, const unsigned char * rgb, unsigned int width, unsigned int height);
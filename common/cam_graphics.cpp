@@ -8,8 +8,10 @@
 #include <iostream>
 #include "bcm_host.h"
 #include "graphics.h"
-
-#define check() assert(glGetError() == 0)
+#include "gpumemory.h"
+#include "programcache.h"
+#include "glstate.h"
+#include "glcheck.h"
 
 uint32_t GScreenWidth;
 uint32_t GScreenHeight;
@@ -18,11 +20,14 @@ EGLSurface GSurface;
 EGLContext GContext;
 
 GfxShader GSimpleVS;
-GfxShader GSimpleFS;
 GfxShader GYUVFS;
-GfxProgram GSimpleProg;
 GfxProgram GYUVProg;
 GLuint GQuadVertexBuffer;
+SpriteBatch GSpriteBatch;
+
+// Looked up once the programs are linked, the draws don't go to the driver by name
+static int GYUVOffset, GYUVScale, GYUVTex[3];
+static GLint GYUVVertex;
 
 void InitGraphics()
 {
@@ -124,11 +129,15 @@ void InitGraphics()
 
 	//load the test shaders
 	GSimpleVS.LoadVertexShader("simplevertshader.glsl");
-	GSimpleFS.LoadFragmentShader("simplefragshader.glsl");
 	GYUVFS.LoadFragmentShader("yuvfragshader.glsl");
-	GSimpleProg.Create(&GSimpleVS,&GSimpleFS);
 	GYUVProg.Create(&GSimpleVS,&GYUVFS);
         check();
+	GYUVOffset = GYUVProg.GetUniform("offset");
+	GYUVScale = GYUVProg.GetUniform("scale");
+	GYUVTex[0] = GYUVProg.GetUniform("tex0");
+	GYUVTex[1] = GYUVProg.GetUniform("tex1");
+	GYUVTex[2] = GYUVProg.GetUniform("tex2");
+	GYUVVertex = GYUVProg.GetAttrib("vertex");
 
 	//create an ickle vertex buffer
 	static const GLfloat quad_vertex_positions[] = {
@@ -141,18 +150,25 @@ void InitGraphics()
 
 	glGenBuffers(1, &GQuadVertexBuffer);
 	check();
-	glBindBuffer(GL_ARRAY_BUFFER, GQuadVertexBuffer);
+	GGLState.BindBuffer(GL_ARRAY_BUFFER, GQuadVertexBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertex_positions), quad_vertex_positions, GL_STATIC_DRAW);
 	check();
+	GGpuMemory.Track(GPU_OBJECT_BUFFER, GQuadVertexBuffer, GPU_VERTEX_BUFFERS, sizeof(quad_vertex_positions));
 
+	GSpriteBatch.Create();
+	check();
 
 
 }
 
 void BeginFrame()
 {
+	GGpuMemory.BeginFrame();
+	GGLState.BeginFrame();
+	GGLCheck.BeginFrame();
+
 	// Prepare viewport
-	glViewport ( 0, 0, GScreenWidth, GScreenHeight );
+	GGLState.Viewport ( 0, 0, GScreenWidth, GScreenHeight );
 	check();
 
 	// Clear the background
@@ -206,28 +222,7 @@ bool GfxShader::LoadVertexShader(const char* filename)
 	Src[sz] = 0; //null terminate it!
 	fclose(f);
 
-	//now create and compile the shader
 	GlShaderType = GL_VERTEX_SHADER;
-	Id = glCreateShader(GlShaderType);
-	glShaderSource(Id, 1, (const GLchar**)&Src, 0);
-	glCompileShader(Id);
-	check();
-
-	//compilation check
-	GLint compiled;
-	glGetShaderiv(Id, GL_COMPILE_STATUS, &compiled);
-	if(compiled==0)
-	{
-		printf("Failed to compile vertex shader %s:\n%s\n", filename, Src);
-		printShaderInfoLog(Id);
-		glDeleteShader(Id);
-		return false;
-	}
-	else
-	{
-		printf("Compiled vertex shader %s:\n%s\n", filename, Src);
-	}
-
 	return true;
 }
 
@@ -245,8 +240,17 @@ bool GfxShader::LoadFragmentShader(const char* filename)
 	Src[sz] = 0; //null terminate it!
 	fclose(f);
 
-	//now create and compile the shader
 	GlShaderType = GL_FRAGMENT_SHADER;
+	return true;
+}
+
+bool GfxShader::Compile()
+{
+	if(Id)
+		return true;
+	const char* kind = GlShaderType == GL_VERTEX_SHADER ? "vertex" : "fragment";
+
+	//now create and compile the shader
 	Id = glCreateShader(GlShaderType);
 	glShaderSource(Id, 1, (const GLchar**)&Src, 0);
 	glCompileShader(Id);
@@ -257,14 +261,15 @@ bool GfxShader::LoadFragmentShader(const char* filename)
 	glGetShaderiv(Id, GL_COMPILE_STATUS, &compiled);
 	if(compiled==0)
 	{
-		printf("Failed to compile fragment shader %s:\n%s\n", filename, Src);
+		printf("Failed to compile %s shader:\n%s\n", kind, Src);
 		printShaderInfoLog(Id);
 		glDeleteShader(Id);
+		Id = 0;
 		return false;
 	}
 	else
 	{
-		printf("Compiled fragment shader %s:\n%s\n", filename, Src);
+		printf("Compiled %s shader:\n%s\n", kind, Src);
 	}
 
 	return true;
@@ -274,11 +279,25 @@ bool GfxProgram::Create(GfxShader* vertex_shader, GfxShader* fragment_shader)
 {
 	VertexShader = vertex_shader;
 	FragmentShader = fragment_shader;
+
+	// a binary saved by an earlier run skips compiling and linking altogether
+	unsigned long long key = GProgramCache.Key(VertexShader->GetSource(), FragmentShader->GetSource());
+	Id = GProgramCache.Load(key);
+	if(Id)
+	{
+		Reflection.Reflect(Id);
+		printf("Loaded program id %d from the binary cache\n", GetId());
+		return true;
+	}
+
+	if(!VertexShader->Compile() || !FragmentShader->Compile())
+		return false;
 	Id = glCreateProgram();
 	glAttachShader(Id, VertexShader->GetId());
 	glAttachShader(Id, FragmentShader->GetId());
 	glLinkProgram(Id);
 	check();
+	Reflection.Reflect(Id);
 	printf("Created program id %d from vs %d and fs %d\n", GetId(), VertexShader->GetId(), FragmentShader->GetId());
 
 	// Prints the information log for a program object
@@ -286,50 +305,32 @@ bool GfxProgram::Create(GfxShader* vertex_shader, GfxShader* fragment_shader)
 	glGetProgramInfoLog(Id,sizeof log,NULL,log);
 	printf("%d:program:\n%s\n", Id, log);
 
+	GProgramCache.Save(key, Id);
 	return true;	
 }
 
-void DrawTextureRect(GfxTexture* texture, float x0, float y0, float x1, float y1, GfxTexture* render_target, int whichTexture, float x, float y)
+void DrawTextureRect(GfxTexture* texture, float x0, float y0, float x1, float y1, GfxTexture* render_target, int /*whichTexture*/, float x, float y)
 {
 //float x = 0.11;
 //float y = 0.11;
 	if(render_target)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER,render_target->GetFramebufferId());
-		glViewport ( 0, 0, render_target->GetWidth(), render_target->GetHeight() );
+		GGLState.BindFramebuffer(GL_FRAMEBUFFER,render_target->GetFramebufferId());
+		GGLState.Viewport ( 0, 0, render_target->GetWidth(), render_target->GetHeight() );
 		check();
 	}
 
-	glUseProgram(GSimpleProg.GetId());	check();
-
-	glUniform2f(glGetUniformLocation(GSimpleProg.GetId(),"offset"),x0,y0);
-	glUniform2f(glGetUniformLocation(GSimpleProg.GetId(),"scale"),x1-x0,y1-y0);
-	glUniform1i(glGetUniformLocation(GSimpleProg.GetId(),"tex"), 0);
+	// a batch of one, many rects in a frame should go through GSpriteBatch themselves
+	GSpriteBatch.Begin();
+	GSpriteBatch.Draw(texture->GetId(),x0,y0,x1,y1);
+	GSpriteBatch.End();
 	check();
-
-        if(whichTexture == 0)
-        {
-            glBindBuffer(GL_ARRAY_BUFFER, GQuadVertexBuffer);       check();
-        } else {
-
-        }
-	glBindTexture(GL_TEXTURE_2D,texture->GetId());	check();
-
-	GLuint loc = glGetAttribLocation(GSimpleProg.GetId(),"vertex");
-	glVertexAttribPointer(loc, 4, GL_FLOAT, 0, 16, 0);	check();
-	glEnableVertexAttribArray(loc);	check();
-glEnable(GL_BLEND);
-glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDrawArrays ( GL_TRIANGLE_STRIP, 0, 4 ); check();
-glDisable(GL_BLEND);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	if(render_target)
 	{
 		//glFinish();	check();
 		//glFlush(); check();
-		glBindFramebuffer(GL_FRAMEBUFFER,0);
-		glViewport ( 0, 0, GScreenWidth, GScreenHeight );
+		GGLState.BindFramebuffer(GL_FRAMEBUFFER,0);
+		GGLState.Viewport ( 0, 0, GScreenWidth, GScreenHeight );
 	}
 
 }
@@ -338,47 +339,41 @@ void DrawYUVTextureRect(GfxTexture* ytexture, GfxTexture* utexture, GfxTexture*
 {
 	if(render_target)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER,render_target->GetFramebufferId());
-		glViewport ( 0, 0, render_target->GetWidth(), render_target->GetHeight() );
+		GGLState.BindFramebuffer(GL_FRAMEBUFFER,render_target->GetFramebufferId());
+		GGLState.Viewport ( 0, 0, render_target->GetWidth(), render_target->GetHeight() );
 		check();
 	}
 
-	glUseProgram(GYUVProg.GetId());	check();
+	GL_CHECK(GGLState.UseProgram(GYUVProg.GetId()));
 
-	glUniform2f(glGetUniformLocation(GYUVProg.GetId(),"offset"),x0,y0);
-	glUniform2f(glGetUniformLocation(GYUVProg.GetId(),"scale"),x1-x0,y1-y0);
-	glUniform1i(glGetUniformLocation(GYUVProg.GetId(),"tex0"), 0);
-	glUniform1i(glGetUniformLocation(GYUVProg.GetId(),"tex1"), 1);
-	glUniform1i(glGetUniformLocation(GYUVProg.GetId(),"tex2"), 2);
+	GYUVProg.SetVec2(GYUVOffset,x0,y0);
+	GYUVProg.SetVec2(GYUVScale,x1-x0,y1-y0);
+	GYUVProg.SetInt(GYUVTex[0], 0);
+	GYUVProg.SetInt(GYUVTex[1], 1);
+	GYUVProg.SetInt(GYUVTex[2], 2);
 	check();
-        if(whichTexture == 0)
-        {
-            glBindBuffer(GL_ARRAY_BUFFER, GQuadVertexBuffer);       check();
-        } else {
-        }
-
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D,ytexture->GetId());	check();
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D,utexture->GetId());	check();
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D,vtexture->GetId());	check();
-	glActiveTexture(GL_TEXTURE0);
-
-	GLuint loc = glGetAttribLocation(GYUVProg.GetId(),"vertex");
-	glVertexAttribPointer(loc, 4, GL_FLOAT, 0, 16, 0);	check();
-	glEnableVertexAttribArray(loc);	check();
-	glDrawArrays ( GL_TRIANGLE_STRIP, 0, 4 ); check();
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+        GL_CHECK(GGLState.BindBuffer(GL_ARRAY_BUFFER, whichTexture == 0 ? GQuadVertexBuffer : 0));
+
+	// the units keep their textures, the same camera planes next frame bind nothing
+	GGLState.ActiveTexture(GL_TEXTURE0);
+	GL_CHECK(GGLState.BindTexture(GL_TEXTURE_2D,ytexture->GetId()));
+	GGLState.ActiveTexture(GL_TEXTURE1);
+	GL_CHECK(GGLState.BindTexture(GL_TEXTURE_2D,utexture->GetId()));
+	GGLState.ActiveTexture(GL_TEXTURE2);
+	GL_CHECK(GGLState.BindTexture(GL_TEXTURE_2D,vtexture->GetId()));
+	GGLState.ActiveTexture(GL_TEXTURE0);
+
+	GL_CHECK(glVertexAttribPointer(GYUVVertex, 4, GL_FLOAT, 0, 16, 0));
+	GL_CHECK(GGLState.EnableVertexAttribArray(GYUVVertex));
+	GGLState.Disable(GL_BLEND);
+	GL_CHECK(glDrawArrays ( GL_TRIANGLE_STRIP, 0, 4 ));
 
 	if(render_target)
 	{
 		//glFinish();	check();
 		//glFlush(); check();
-		glBindFramebuffer(GL_FRAMEBUFFER,0);
-		glViewport ( 0, 0, GScreenWidth, GScreenHeight );
+		GGLState.BindFramebuffer(GL_FRAMEBUFFER,0);
+		GGLState.Viewport ( 0, 0, GScreenWidth, GScreenHeight );
 	}
 }
 
@@ -388,17 +383,41 @@ bool GfxTexture::CreateRGBA(int width, int height, const void* data)
 	Width = width;
 	Height = height;
         printf("Width: %d, Height: %d\n",Width,Height);
+	GGpuMemory.Reserve(Width*Height*4);
 	glGenTextures(1, &Id);
 	check();
-	glBindTexture(GL_TEXTURE_2D, Id);
+	GGLState.BindTexture(GL_TEXTURE_2D, Id);
 	check();
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	check();
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, Id, GPU_TEXTURES, Width*Height*4);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLfloat)GL_NEAREST);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLfloat)GL_NEAREST);
 	check();
-	glBindTexture(GL_TEXTURE_2D, 0);
 	IsRGBA = true;
+	IsRGB565 = false;
+	return true;
+}
+
+bool GfxTexture::CreateRGB565(int width, int height, const void* rgba_data)
+{
+	Width = width;
+	Height = height;
+	GGpuMemory.Reserve(Width*Height*2);
+	glGenTextures(1, &Id);
+	check();
+	GGLState.BindTexture(GL_TEXTURE_2D, Id);
+	check();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, Width, Height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, NULL);
+	check();
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, Id, GPU_TEXTURES, Width*Height*2);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLfloat)GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLfloat)GL_NEAREST);
+	check();
+	IsRGBA = false;
+	IsRGB565 = true;
+	if(rgba_data)
+		SetPixels(rgba_data, PIXELS_RGBA);
 	return true;
 }
 
@@ -406,17 +425,19 @@ bool GfxTexture::CreateGreyScale(int width, int height, const void* data)
 {
         Width = width;
         Height = height;
+        GGpuMemory.Reserve(Width*Height);
         glGenTextures(1, &Id);
         check();
-        glBindTexture(GL_TEXTURE_2D, Id);
+        GGLState.BindTexture(GL_TEXTURE_2D, Id);
         check();
         glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, Width, Height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
         check();
+        GGpuMemory.Track(GPU_OBJECT_TEXTURE, Id, GPU_TEXTURES, Width*Height);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLfloat)GL_LINEAR);
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLfloat)GL_LINEAR);
         check();
-        glBindTexture(GL_TEXTURE_2D, 0);
         IsRGBA = false;
+        IsRGB565 = false;
         return true;
 }
 
@@ -425,26 +446,67 @@ bool GfxTexture::GenerateFrameBuffer()
 	//Create a frame buffer that points to this texture
 	glGenFramebuffers(1,&FramebufferId);
 	check();
-	glBindFramebuffer(GL_FRAMEBUFFER,FramebufferId);
+	GGLState.BindFramebuffer(GL_FRAMEBUFFER,FramebufferId);
 	check();
 	glFramebufferTexture2D(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_TEXTURE_2D,Id,0);
 	check();
-	glBindFramebuffer(GL_FRAMEBUFFER,0);
+	GGLState.BindFramebuffer(GL_FRAMEBUFFER,0);
 	check();
+	// the texture is counted as a render target from now on
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, Id, GPU_RENDER_TARGETS, Width*Height*(IsRGBA ? 4 : IsRGB565 ? 2 : 1));
 	return true;
 }
 
+void GfxTexture::Release()
+{
+	if(FramebufferId)
+	{
+		GGLState.DeleteFramebuffers(1, &FramebufferId);
+		FramebufferId = 0;
+	}
+	if(Id)
+	{
+		GGpuMemory.Untrack(GPU_OBJECT_TEXTURE, Id);
+		GGLState.DeleteTextures(1, &Id);
+		Id = 0;
+	}
+}
+
 void GfxTexture::SetPixels(const void* data)
 {
-	glBindTexture(GL_TEXTURE_2D, Id);
+	GGLState.BindTexture(GL_TEXTURE_2D, Id);
 	check();
 // this defines the part of the data that gets displayed
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Width, Height, IsRGBA ? GL_RGBA : GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
-	check();
-	glBindTexture(GL_TEXTURE_2D, 0);
+	if(IsRGB565)
+	{
+		// 565 rows are only 2 byte aligned when the width is odd
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Width, Height, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Width, Height, IsRGBA ? GL_RGBA : GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
 	check();
 }
 
+void GfxTexture::SetPixels(const void* data, PixelLayout layout, bool flip_rows)
+{
+	// luminance textures take their bytes as they come
+	if(!IsRGBA && !IsRGB565)
+	{
+		SetPixels(data);
+		return;
+	}
+
+	size_t pixels = (size_t)Width * Height;
+	Converted.resize(pixels * 4);
+	convertToRGBA(data, layout, &Converted[0], Width, Height, flip_rows);
+	// in place, the 565 pixels end up in the first half of the buffer
+	if(IsRGB565)
+		convertRGBAToRGB565(&Converted[0], (unsigned short*)&Converted[0], pixels);
+	SetPixels(&Converted[0]);
+}
+
 /*
 
 void GfxTexture::Save(const char* fname)
@@ -0,0 +1,197 @@
+// chunk files can be bigger than 2GB, even on the Pi's 32 bit userland
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "chunkfile.h"
+
+static bool readAt(int fd, void* out, size_t size, unsigned long long offset)
+{
+	char* p = (char*)out;
+	while(size > 0)
+	{
+		ssize_t n = pread(fd, p, size, (off_t)offset);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			return false;
+		p += n;
+		size -= n;
+		offset += n;
+	}
+	return true;
+}
+
+bool ChunkFile::Open(const char* filename)
+{
+	Close();
+	File = open(filename, O_RDONLY);
+	if(File < 0)
+		return false;
+
+	off_t size = lseek(File, 0, SEEK_END);
+	bool ok = readAt(File, &Header, sizeof(Header), 0) &&
+		Header.Magic == CHUNKFILE_MAGIC &&
+		Header.Version == CHUNKFILE_VERSION &&
+		Header.VertexStride == sizeof(MeshVertex) &&
+		Header.TableOffset + (unsigned long long)Header.ChunkCount * sizeof(ChunkFileEntry) <= (unsigned long long)size;
+	if(ok)
+	{
+		Entries.resize(Header.ChunkCount);
+		ok = Header.ChunkCount == 0 || readAt(File, &Entries[0], Entries.size() * sizeof(ChunkFileEntry), Header.TableOffset);
+	}
+	for(unsigned int i = 0; ok && i < Entries.size(); i++)
+		ok = Entries[i].VertexCount <= MAX_CHUNK_VERTICES &&
+			Entries[i].DataOffset % 4 == 0 &&
+			Entries[i].DataOffset + GetChunkDataSize(i) <= (unsigned long long)size;
+
+	if(!ok)
+	{
+		printf("%s is not a valid version %d chunk file\n", filename, CHUNKFILE_VERSION);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void ChunkFile::Close()
+{
+	if(File >= 0)
+		close(File);
+	File = -1;
+	Entries.clear();
+	memset(&Header, 0, sizeof(Header));
+}
+
+bool ChunkFile::ReadChunk(unsigned int chunk, std::vector<unsigned char>& out)
+{
+	out.resize(GetChunkDataSize(chunk));
+	if(out.empty())
+		return true;
+	if(!readAt(File, &out[0], out.size(), Entries[chunk].DataOffset))
+	{
+		printf("Failed to read chunk %u\n", chunk);
+		return false;
+	}
+	// the table was checked by Open, the indices only arrive here
+	const ChunkFileEntry& entry = Entries[chunk];
+	if(!checkMeshIndices((const unsigned short*)&out[GetChunkVertexSize(chunk)], entry.IndexCount, entry.VertexCount))
+	{
+		printf("Chunk %u has indices past its %u vertices\n", chunk, entry.VertexCount);
+		out.clear();
+		return false;
+	}
+	return true;
+}
+
+bool writeChunkFile(
+	const char * path,
+	const std::vector<MeshChunk> & chunks,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+){
+	ChunkFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = CHUNKFILE_MAGIC;
+	header.Version = CHUNKFILE_VERSION;
+	header.ChunkCount = chunks.size();
+	header.VertexStride = sizeof(MeshVertex);
+	header.TableOffset = sizeof(ChunkFileHeader);
+
+	std::vector<ChunkFileEntry> entries(chunks.size());
+	unsigned long long offset = header.TableOffset + entries.size() * sizeof(ChunkFileEntry);
+	for(size_t i = 0; i < chunks.size(); i++)
+	{
+		const MeshChunk& chunk = chunks[i];
+		ChunkFileEntry& entry = entries[i];
+		memcpy(entry.BoundsMin, &chunk.BoundsMin.x, sizeof(entry.BoundsMin));
+		memcpy(entry.BoundsMax, &chunk.BoundsMax.x, sizeof(entry.BoundsMax));
+		entry.VertexCount = chunk.Vertices.size();
+		entry.IndexCount = chunk.Indices.size();
+		offset = (offset + 3) & ~3ull;
+		entry.DataOffset = offset;
+		offset += entry.VertexCount * sizeof(MeshVertex) + entry.IndexCount * sizeof(unsigned short);
+
+		glm::vec3 bmin = i ? glm::min(glm::vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]), chunk.BoundsMin) : chunk.BoundsMin;
+		glm::vec3 bmax = i ? glm::max(glm::vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]), chunk.BoundsMax) : chunk.BoundsMax;
+		memcpy(header.BoundsMin, &bmin.x, sizeof(header.BoundsMin));
+		memcpy(header.BoundsMax, &bmax.x, sizeof(header.BoundsMax));
+	}
+
+	// same as writeMeshFile, never leave half a file under the real name
+	std::string tmp = std::string(path) + ".tmp";
+	FILE* f = fopen(tmp.c_str(), "wb");
+	if(!f)
+		return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+		(entries.empty() || fwrite(&entries[0], sizeof(ChunkFileEntry), entries.size(), f) == entries.size());
+
+	std::vector<MeshVertex> interleaved;
+	for(size_t i = 0; ok && i < chunks.size(); i++)
+	{
+		const MeshChunk& chunk = chunks[i];
+		static const char padding[4] = { 0 };
+		size_t pad = entries[i].DataOffset - (unsigned long long)ftello(f);
+		ok = pad < 4 && fwrite(padding, 1, pad, f) == pad;
+
+		interleaved.resize(chunk.Vertices.size());
+		for(size_t v = 0; v < chunk.Vertices.size(); v++)
+		{
+			unsigned int src = chunk.Vertices[v];
+			memcpy(interleaved[v].Position, &vertices[src].x, sizeof(interleaved[v].Position));
+			memcpy(interleaved[v].UV, &uvs[src].x, sizeof(interleaved[v].UV));
+			memcpy(interleaved[v].Normal, &normals[src].x, sizeof(interleaved[v].Normal));
+		}
+		ok = ok && (interleaved.empty() || fwrite(&interleaved[0], sizeof(MeshVertex), interleaved.size(), f) == interleaved.size()) &&
+			(chunk.Indices.empty() || fwrite(&chunk.Indices[0], sizeof(unsigned short), chunk.Indices.size(), f) == chunk.Indices.size());
+	}
+	ok = fclose(f) == 0 && ok;
+
+	if(!ok || rename(tmp.c_str(), path) != 0)
+	{
+		remove(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+std::string chunkFilePath(const char* objpath)
+{
+	return std::string(objpath) + ".chunks";
+}
+
+static float boxDistance(const ChunkFileEntry& entry, const glm::vec3& p)
+{
+	glm::vec3 bmin(entry.BoundsMin[0], entry.BoundsMin[1], entry.BoundsMin[2]);
+	glm::vec3 bmax(entry.BoundsMax[0], entry.BoundsMax[1], entry.BoundsMax[2]);
+	glm::vec3 nearest = glm::min(glm::max(p, bmin), bmax);
+	return glm::length(nearest - p);
+}
+
+void sortVisibleChunks(ChunkFile& file, const glm::mat4& mvp, const glm::vec3& camera, float max_distance, std::vector<unsigned int>& out)
+{
+	std::vector<std::pair<float, unsigned int> > visible;
+	for(unsigned int i = 0; i < file.GetChunkCount(); i++)
+	{
+		const ChunkFileEntry& entry = file.GetChunk(i);
+		float distance = boxDistance(entry, camera);
+		if(distance > max_distance)
+			continue;
+		glm::vec3 bmin(entry.BoundsMin[0], entry.BoundsMin[1], entry.BoundsMin[2]);
+		glm::vec3 bmax(entry.BoundsMax[0], entry.BoundsMax[1], entry.BoundsMax[2]);
+		if(isBoxVisible(mvp, bmin, bmax))
+			visible.push_back(std::make_pair(distance, i));
+	}
+	std::sort(visible.begin(), visible.end());
+
+	out.clear();
+	for(size_t i = 0; i < visible.size(); i++)
+		out.push_back(visible[i].second);
+}
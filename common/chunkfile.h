@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "meshfile.h"
+#include "meshpartition.h"
+
+// Chunked model file for streaming models bigger than memory (see meshstream.h).
+//
+//   ChunkFileHeader
+//   ChunkFileEntry[ChunkCount]            at TableOffset
+//   per chunk, at its DataOffset (4 byte aligned):
+//     MeshVertex[VertexCount]
+//     unsigned short[IndexCount]
+//
+// Chunks come from partitionMesh, so each one is drawable on its own with 16 bit indices.
+// Offsets are 64 bit and chunks are read with pread, nothing needs the whole file mapped.
+
+#define CHUNKFILE_MAGIC   0x4B4E4843 // "CHNK"
+#define CHUNKFILE_VERSION 1
+
+// Smaller chunks stream and cull at a finer grain, but cost more draw calls
+#define DEFAULT_CHUNK_VERTICES 16384
+
+struct ChunkFileHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int ChunkCount;
+	unsigned int VertexStride;
+	unsigned int TableOffset;
+	unsigned int Flags;       // always 0 for now
+	float BoundsMin[3];
+	float BoundsMax[3];
+};
+
+struct ChunkFileEntry
+{
+	float BoundsMin[3];
+	float BoundsMax[3];
+	unsigned int VertexCount;
+	unsigned int IndexCount;
+	unsigned long long DataOffset;
+};
+
+class ChunkFile
+{
+	int File;
+	ChunkFileHeader Header;
+	std::vector<ChunkFileEntry> Entries;
+
+public:
+
+	ChunkFile() : File(-1) {}
+	~ChunkFile() { Close(); }
+
+	// Reads the header and chunk table, the chunks themselves stay on disk
+	bool Open(const char* filename);
+	void Close();
+	const ChunkFileHeader& GetHeader() { return Header; }
+	unsigned int GetChunkCount() { return Entries.size(); }
+	const ChunkFileEntry& GetChunk(unsigned int chunk) { return Entries[chunk]; }
+	size_t GetChunkVertexSize(unsigned int chunk) { return (size_t)Entries[chunk].VertexCount * Header.VertexStride; }
+	size_t GetChunkDataSize(unsigned int chunk) { return GetChunkVertexSize(chunk) + Entries[chunk].IndexCount * sizeof(unsigned short); }
+
+	// Reads one chunk's vertices followed by its indices into out (resized to GetChunkDataSize),
+	// false on a short read or an index past the chunk's VertexCount
+	bool ReadChunk(unsigned int chunk, std::vector<unsigned char>& out);
+};
+
+// Writes the chunks of a partitioned mesh, one at a time
+bool writeChunkFile(
+	const char * path,
+	const std::vector<MeshChunk> & chunks,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+);
+
+// Where objconvert puts the chunk file for an .obj
+std::string chunkFilePath(const char* objpath);
+
+// Chunks whose bounds touch the view volume of mvp and lie within max_distance of camera
+// (both in model space), nearest first
+void sortVisibleChunks(ChunkFile& file, const glm::mat4& mvp, const glm::vec3& camera, float max_distance, std::vector<unsigned int>& out);
@@ -0,0 +1,389 @@
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "etc1.h"
+
+// Intensity modifiers, codeword by codeword. A pixel index picks +a, +b, -a or -b.
+static const int ETC1Modifiers[8][2] =
+{
+	{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 },
+};
+
+static inline int clamp255(int v)
+{
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline int expand4(int c) { return (c << 4) | c; }
+static inline int expand5(int c) { return (c << 3) | (c >> 2); }
+
+// Best codeword and pixel indices for 8 pixels around one base colour
+struct SubBlockFit
+{
+	unsigned int Error;
+	int Table;
+	unsigned char Indices[8];
+};
+
+static void fitSubBlock(const unsigned char* pixels[8], const int base[3], SubBlockFit& fit)
+{
+	fit.Error = 0xFFFFFFFF;
+	for(int t = 0; t < 8; t++)
+	{
+		int mods[4] = { ETC1Modifiers[t][0], ETC1Modifiers[t][1], -ETC1Modifiers[t][0], -ETC1Modifiers[t][1] };
+		int colours[4][3];
+		for(int m = 0; m < 4; m++)
+			for(int c = 0; c < 3; c++)
+				colours[m][c] = clamp255(base[c] + mods[m]);
+
+		unsigned int error = 0;
+		unsigned char indices[8];
+		for(int i = 0; i < 8 && error < fit.Error; i++)
+		{
+			unsigned int best = 0xFFFFFFFF;
+			for(int m = 0; m < 4; m++)
+			{
+				int dr = colours[m][0] - pixels[i][0], dg = colours[m][1] - pixels[i][1], db = colours[m][2] - pixels[i][2];
+				unsigned int e = dr * dr + dg * dg + db * db;
+				if(e < best)
+				{
+					best = e;
+					indices[i] = (unsigned char)m;
+				}
+			}
+			error += best;
+		}
+		if(error < fit.Error)
+		{
+			fit.Error = error;
+			fit.Table = t;
+			memcpy(fit.Indices, indices, sizeof(indices));
+		}
+	}
+}
+
+// Quantized base colours worth trying for a sub-block: the rounded average, and with
+// ETC1_QUALITY_HIGH every colour one step away from it on each channel
+static int baseCandidates(const unsigned char* pixels[8], int levels, ETC1Quality quality, int candidates[27][3])
+{
+	int centre[3];
+	for(int c = 0; c < 3; c++)
+	{
+		int sum = 0;
+		for(int i = 0; i < 8; i++)
+			sum += pixels[i][c];
+		centre[c] = (int)floorf(sum * levels / (8.0f * 255.0f) + 0.5f);
+	}
+
+	int range = quality == ETC1_QUALITY_HIGH ? 1 : 0;
+	int count = 0;
+	for(int r = -range; r <= range; r++)
+		for(int g = -range; g <= range; g++)
+			for(int b = -range; b <= range; b++)
+			{
+				int q[3] = { centre[0] + r, centre[1] + g, centre[2] + b };
+				if(q[0] < 0 || q[1] < 0 || q[2] < 0 || q[0] > levels || q[1] > levels || q[2] > levels)
+					continue;
+				memcpy(candidates[count++], q, sizeof(q));
+			}
+	return count;
+}
+
+// One way of coding the block, the best found so far
+struct BlockCode
+{
+	unsigned int Error;
+	bool Diff, Flip;
+	int Base[2][3];         // quantized, 4 or 5 bits
+	SubBlockFit Fit[2];
+};
+
+static void tryIndividual(const unsigned char* sub[2][8], bool flip, ETC1Quality quality, BlockCode& best)
+{
+	BlockCode code;
+	code.Error = 0;
+	code.Diff = false;
+	code.Flip = flip;
+	for(int s = 0; s < 2; s++)
+	{
+		int candidates[27][3];
+		int count = baseCandidates(sub[s], 15, quality, candidates);
+		code.Fit[s].Error = 0xFFFFFFFF;
+		for(int i = 0; i < count; i++)
+		{
+			int base[3] = { expand4(candidates[i][0]), expand4(candidates[i][1]), expand4(candidates[i][2]) };
+			SubBlockFit fit;
+			fitSubBlock(sub[s], base, fit);
+			if(fit.Error < code.Fit[s].Error)
+			{
+				code.Fit[s] = fit;
+				memcpy(code.Base[s], candidates[i], sizeof(code.Base[s]));
+			}
+		}
+		code.Error += code.Fit[s].Error;
+	}
+	if(code.Error < best.Error)
+		best = code;
+}
+
+static void tryDifferential(const unsigned char* sub[2][8], bool flip, ETC1Quality quality, BlockCode& best)
+{
+	// fit every candidate on its own, then take the best pair whose difference fits in 3 bits
+	int candidates[2][27][3];
+	SubBlockFit fits[2][27];
+	int counts[2];
+	for(int s = 0; s < 2; s++)
+	{
+		counts[s] = baseCandidates(sub[s], 31, quality, candidates[s]);
+		for(int i = 0; i < counts[s]; i++)
+		{
+			int base[3] = { expand5(candidates[s][i][0]), expand5(candidates[s][i][1]), expand5(candidates[s][i][2]) };
+			fitSubBlock(sub[s], base, fits[s][i]);
+		}
+	}
+
+	for(int i = 0; i < counts[0]; i++)
+	{
+		for(int j = 0; j < counts[1]; j++)
+		{
+			bool fits3 = true;
+			for(int c = 0; c < 3; c++)
+			{
+				int d = candidates[1][j][c] - candidates[0][i][c];
+				fits3 = fits3 && d >= -4 && d <= 3;
+			}
+			unsigned int error = fits[0][i].Error + fits[1][j].Error;
+			if(!fits3 || error >= best.Error)
+				continue;
+
+			best.Error = error;
+			best.Diff = true;
+			best.Flip = flip;
+			memcpy(best.Base[0], candidates[0][i], sizeof(best.Base[0]));
+			memcpy(best.Base[1], candidates[1][j], sizeof(best.Base[1]));
+			best.Fit[0] = fits[0][i];
+			best.Fit[1] = fits[1][j];
+		}
+	}
+}
+
+// Which sub-block pixel (x, y) is in, and its place there, matching how the pixels were gathered
+static inline int subBlockOf(int x, int y, bool flip)
+{
+	return flip ? (y >= 2) : (x >= 2);
+}
+
+static inline int slotOf(int x, int y, bool flip)
+{
+	return flip ? (y & 1) * 4 + x : y * 2 + (x & 1);
+}
+
+static void packBlock(const BlockCode& code, unsigned char* out)
+{
+	unsigned int high = 0, low = 0;
+	if(code.Diff)
+	{
+		for(int c = 0; c < 3; c++)
+		{
+			int d = code.Base[1][c] - code.Base[0][c];
+			high |= (code.Base[0][c] << (27 - c * 8)) | ((d & 7) << (24 - c * 8));
+		}
+	}
+	else
+	{
+		for(int c = 0; c < 3; c++)
+			high |= (code.Base[0][c] << (28 - c * 8)) | (code.Base[1][c] << (24 - c * 8));
+	}
+	high |= (code.Fit[0].Table << 5) | (code.Fit[1].Table << 2) | ((code.Diff ? 1 : 0) << 1) | (code.Flip ? 1 : 0);
+
+	// pixel indices go column by column, the high bit of each in the upper half
+	for(int x = 0; x < 4; x++)
+	{
+		for(int y = 0; y < 4; y++)
+		{
+			int index = code.Fit[ subBlockOf(x, y, code.Flip) ].Indices[ slotOf(x, y, code.Flip) ];
+			int p = x * 4 + y;
+			low |= ((index >> 1) << (p + 16)) | ((index & 1) << p);
+		}
+	}
+
+	for(int i = 0; i < 4; i++)
+	{
+		out[i]     = (unsigned char)(high >> (24 - i * 8));
+		out[i + 4] = (unsigned char)(low  >> (24 - i * 8));
+	}
+}
+
+size_t etc1ImageSize(unsigned int width, unsigned int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * ETC1_BLOCK_SIZE;
+}
+
+unsigned int encodeETC1Block(const unsigned char* rgb, ETC1Quality quality, unsigned char* out)
+{
+	BlockCode best;
+	best.Error = 0xFFFFFFFF;
+	for(int flip = 0; flip < 2; flip++)
+	{
+		const unsigned char* sub[2][8];
+		for(int y = 0; y < 4; y++)
+			for(int x = 0; x < 4; x++)
+				sub[ subBlockOf(x, y, flip != 0) ][ slotOf(x, y, flip != 0) ] = rgb + (y * 4 + x) * 3;
+
+		tryDifferential(sub, flip != 0, quality, best);
+		tryIndividual(sub, flip != 0, quality, best);
+	}
+	packBlock(best, out);
+	return best.Error;
+}
+
+void decodeETC1Block(const unsigned char* block, unsigned char* rgb)
+{
+	unsigned int high = (block[0] << 24) | (block[1] << 16) | (block[2] << 8) | block[3];
+	unsigned int low  = (block[4] << 24) | (block[5] << 16) | (block[6] << 8) | block[7];
+	bool diff = (high & 2) != 0, flip = (high & 1) != 0;
+	int tables[2] = { (int)(high >> 5) & 7, (int)(high >> 2) & 7 };
+
+	int base[2][3];
+	for(int c = 0; c < 3; c++)
+	{
+		if(diff)
+		{
+			int c1 = (high >> (27 - c * 8)) & 31;
+			int d = (high >> (24 - c * 8)) & 7;
+			d = d >= 4 ? d - 8 : d;
+			base[0][c] = expand5(c1);
+			base[1][c] = expand5((c1 + d) & 31);
+		}
+		else
+		{
+			base[0][c] = expand4((high >> (28 - c * 8)) & 15);
+			base[1][c] = expand4((high >> (24 - c * 8)) & 15);
+		}
+	}
+
+	for(int y = 0; y < 4; y++)
+	{
+		for(int x = 0; x < 4; x++)
+		{
+			int s = subBlockOf(x, y, flip);
+			int p = x * 4 + y;
+			int index = (((low >> (p + 16)) & 1) << 1) | ((low >> p) & 1);
+			int modifier = ETC1Modifiers[ tables[s] ][index & 1];
+			if(index & 2)
+				modifier = -modifier;
+			for(int c = 0; c < 3; c++)
+				rgb[(y * 4 + x) * 3 + c] = (unsigned char)clamp255(base[s][c] + modifier);
+		}
+	}
+}
+
+struct ETC1Job
+{
+	const unsigned char* Src;
+	unsigned int Width, Height;
+	ETC1Quality Quality;
+	unsigned char* Dst;
+	unsigned int FirstRow, EndRow;   // in blocks
+};
+
+static void* encodeRows(void* arg)
+{
+	ETC1Job* job = (ETC1Job*)arg;
+	unsigned int blocksWide = (job->Width + 3) / 4;
+	unsigned char pixels[16 * 3];
+	for(unsigned int by = job->FirstRow; by < job->EndRow; by++)
+	{
+		for(unsigned int bx = 0; bx < blocksWide; bx++)
+		{
+			for(unsigned int y = 0; y < 4; y++)
+			{
+				unsigned int sy = by * 4 + y < job->Height ? by * 4 + y : job->Height - 1;
+				for(unsigned int x = 0; x < 4; x++)
+				{
+					unsigned int sx = bx * 4 + x < job->Width ? bx * 4 + x : job->Width - 1;
+					memcpy(pixels + (y * 4 + x) * 3, job->Src + (sy * job->Width + sx) * 3, 3);
+				}
+			}
+			encodeETC1Block(pixels, job->Quality, job->Dst + (by * blocksWide + bx) * ETC1_BLOCK_SIZE);
+		}
+	}
+	return NULL;
+}
+
+void encodeETC1Image(const unsigned char* rgb, unsigned int width, unsigned int height,
+	ETC1Quality quality, int threads, std::vector<unsigned char>& out)
+{
+	out.resize(etc1ImageSize(width, height));
+	unsigned int blockRows = (height + 3) / 4;
+	if(threads <= 0)
+	{
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (int)cores : 1;
+	}
+	if((unsigned int)threads > blockRows)
+		threads = blockRows;
+	if(threads < 1 || out.empty())
+		return;
+
+	std::vector<ETC1Job> jobs(threads);
+	for(int i = 0; i < threads; i++)
+	{
+		ETC1Job& job = jobs[i];
+		job.Src = rgb;
+		job.Width = width;
+		job.Height = height;
+		job.Quality = quality;
+		job.Dst = &out[0];
+		job.FirstRow = blockRows * i / threads;
+		job.EndRow = blockRows * (i + 1) / threads;
+	}
+
+	// the calling thread takes the first share
+	std::vector<pthread_t> handles(threads);
+	std::vector<bool> started(threads, false);
+	for(int i = 1; i < threads; i++)
+		started[i] = pthread_create(&handles[i], NULL, encodeRows, &jobs[i]) == 0;
+	encodeRows(&jobs[0]);
+	for(int i = 1; i < threads; i++)
+	{
+		// couldn't get a thread, do it here
+		if(started[i])
+			pthread_join(handles[i], NULL);
+		else
+			encodeRows(&jobs[i]);
+	}
+}
+
+void decodeETC1Image(const unsigned char* data, unsigned int width, unsigned int height, std::vector<unsigned char>& out_rgb)
+{
+	out_rgb.resize(width * height * 3);
+	unsigned int blocksWide = (width + 3) / 4;
+	unsigned char pixels[16 * 3];
+	for(unsigned int by = 0; by * 4 < height; by++)
+	{
+		for(unsigned int bx = 0; bx < blocksWide; bx++)
+		{
+			decodeETC1Block(data + (by * blocksWide + bx) * ETC1_BLOCK_SIZE, pixels);
+			for(unsigned int y = 0; y < 4 && by * 4 + y < height; y++)
+				for(unsigned int x = 0; x < 4 && bx * 4 + x < width; x++)
+					memcpy(&out_rgb[((by * 4 + y) * width + bx * 4 + x) * 3], pixels + (y * 4 + x) * 3, 3);
+		}
+	}
+}
+
+double imagePSNR(const unsigned char* a, const unsigned char* b, unsigned int width, unsigned int height)
+{
+	double sum = 0.0;
+	size_t count = (size_t)width * height * 3;
+	for(size_t i = 0; i < count; i++)
+	{
+		double d = (double)a[i] - b[i];
+		sum += d * d;
+	}
+	if(sum == 0.0)
+		return 99.0;
+	return 10.0 * log10(255.0 * 255.0 * count / sum);
+}
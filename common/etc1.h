@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// ETC1 (GL_OES_compressed_ETC1_RGB8_texture) block codec. Every 4x4 block of RGB pixels
+// becomes 8 bytes, 6:1 against 24 bit RGB. The Pi's GLES2 has it where there is no S3TC.
+// No GL here, the offline tools and benchmarks link it without a context.
+
+#define ETC1_BLOCK_SIZE 8
+
+enum ETC1Quality
+{
+	ETC1_QUALITY_FAST,   // base colours straight from the sub-block averages
+	ETC1_QUALITY_HIGH,   // also tries every neighbour of the averages, about 25x slower
+};
+
+// Bytes of ETC1 data for an image, partial blocks at the edges count as whole ones
+size_t etc1ImageSize(unsigned int width, unsigned int height);
+
+// Encodes one block of 16 tightly packed RGB pixels (row by row) and returns the squared error
+unsigned int encodeETC1Block(const unsigned char* rgb, ETC1Quality quality, unsigned char* out);
+// Decodes one block back to 16 RGB pixels, row by row
+void decodeETC1Block(const unsigned char* block, unsigned char* rgb);
+
+// Encodes a tightly packed RGB image, rows in the order they go to GL, blocks row by row.
+// Edge blocks repeat the last row/column. The block rows are split over `threads` threads,
+// 0 means one per core.
+void encodeETC1Image(const unsigned char* rgb, unsigned int width, unsigned int height,
+	ETC1Quality quality, int threads, std::vector<unsigned char>& out);
+void decodeETC1Image(const unsigned char* data, unsigned int width, unsigned int height, std::vector<unsigned char>& out_rgb);
+
+// Peak signal to noise ratio of two RGB images in dB, for reporting encoder quality
+double imagePSNR(const unsigned char* a, const unsigned char* b, unsigned int width, unsigned int height);
@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "glcheck.h"
+
+GLErrorCheck GGLCheck;
+
+const char* glErrorName(GLenum error)
+{
+	switch(error)
+	{
+	case GL_NO_ERROR: return "GL_NO_ERROR";
+	case GL_INVALID_ENUM: return "GL_INVALID_ENUM";
+	case GL_INVALID_VALUE: return "GL_INVALID_VALUE";
+	case GL_INVALID_OPERATION: return "GL_INVALID_OPERATION";
+	case GL_INVALID_FRAMEBUFFER_OPERATION: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+	case GL_OUT_OF_MEMORY: return "GL_OUT_OF_MEMORY";
+	}
+	return "unknown";
+}
+
+GLErrorCheck::GLErrorCheck()
+	: Frame(0), Sampling(true), Interval(GL_CHECK_INTERVAL), Checks(0), Skipped(0)
+{
+}
+
+void GLErrorCheck::Check(const char* file, int line, const char* call)
+{
+	Checks++;
+	GLenum error = glGetError();
+	if(error == GL_NO_ERROR)
+		return;
+
+	if(call)
+		printf("GL error %s (0x%x) from %s at %s:%d\n", glErrorName(error), error, call, file, line);
+	else if(GL_CHECK_MODE == GL_CHECK_DEBUG)
+		printf("GL error %s (0x%x) from the call before %s:%d\n", glErrorName(error), error, file, line);
+	else
+		printf("GL error %s (0x%x) found at %s:%d, set by a call since the last checked frame\n",
+			glErrorName(error), error, file, line);
+	// GL keeps one flag per kind of error, list the rest
+	for(int i = 0; i < 8; i++)
+	{
+		error = glGetError();
+		if(error == GL_NO_ERROR)
+			break;
+		printf("  and %s (0x%x)\n", glErrorName(error), error);
+	}
+	fflush(stdout);
+	abort();
+}
+
+void GLErrorCheck::BeginFrame()
+{
+	Frame++;
+	Sampling = Interval <= 1 || Frame % Interval == 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "GLES2/gl2.h"
+
+// How check() looks for GL errors, picked at compile time with -DGL_CHECK_MODE=n (the
+// GL_CHECK_MODE cache variable in CMake sets it for the whole tree)
+//   0 : not at all, check() compiles to nothing
+//   1 : sampled, glGetError only runs in one frame out of GGLCheck.Interval
+//   2 : debug, glGetError after every check, a failure prints the file, line and call
+// glGetError waits for the driver to catch up with the calls before it, so it isn't free
+// after each call. It is separate from NDEBUG, the asserts stay either way.
+#define GL_CHECK_OFF 0
+#define GL_CHECK_SAMPLED 1
+#define GL_CHECK_DEBUG 2
+
+#ifndef GL_CHECK_MODE
+#define GL_CHECK_MODE GL_CHECK_SAMPLED
+#endif
+
+// Frames between checked frames in sampled mode
+#ifndef GL_CHECK_INTERVAL
+#define GL_CHECK_INTERVAL 60
+#endif
+
+// Reads and reports GL errors for check(). A failure prints where it was found and
+// aborts, like the assert check() used to be. GL thread only.
+class GLErrorCheck
+{
+	unsigned int Frame;
+
+public:
+
+	GLErrorCheck();
+
+	// Sampled mode checks in the frames where this is true, the first frame always is
+	bool Sampling;
+	unsigned int Interval;
+
+	// call is the failing call's source, or NULL when it is the one before the check
+	void Check(const char* file, int line, const char* call);
+	// Once a frame, from BeginFrame and updateScreen
+	void BeginFrame();
+
+	// glGetError calls made and checks that didn't make one, since the start
+	unsigned long long Checks;
+	unsigned long long Skipped;
+};
+
+extern GLErrorCheck GGLCheck;
+
+// GL_INVALID_ENUM and the like, "unknown" for anything else
+const char* glErrorName(GLenum error);
+
+// check() after a call, or GL_CHECK(call) for a call that returns nothing so debug mode
+// can name it: GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, 3));
+#if GL_CHECK_MODE == GL_CHECK_OFF
+#define check() ((void)0)
+#define GL_CHECK(call) do { call; } while(0)
+#elif GL_CHECK_MODE == GL_CHECK_SAMPLED
+#define check() do { if(GGLCheck.Sampling) GGLCheck.Check(__FILE__, __LINE__, NULL); else GGLCheck.Skipped++; } while(0)
+#define GL_CHECK(call) do { call; check(); } while(0)
+#else
+#define check() GGLCheck.Check(__FILE__, __LINE__, NULL)
+#define GL_CHECK(call) do { call; GGLCheck.Check(__FILE__, __LINE__, #call); } while(0)
+#endif
@@ -0,0 +1,241 @@
+#include <stdio.h>
+
+#include "glstate.h"
+
+GLStateCache GGLState;
+
+// no GL name or enum has this value
+static const GLuint GUnknown = 0xffffffff;
+
+static int capIndex(GLenum cap)
+{
+	switch(cap)
+	{
+	case GL_BLEND: return 0;
+	case GL_CULL_FACE: return 1;
+	case GL_DEPTH_TEST: return 2;
+	case GL_DITHER: return 3;
+	case GL_POLYGON_OFFSET_FILL: return 4;
+	case GL_SAMPLE_ALPHA_TO_COVERAGE: return 5;
+	case GL_SAMPLE_COVERAGE: return 6;
+	case GL_SCISSOR_TEST: return 7;
+	case GL_STENCIL_TEST: return 8;
+	}
+	return -1;
+}
+
+GLStateCache::GLStateCache()
+	: Enabled(true), Issued(0), Elided(0), LastIssued(0), LastElided(0), TotalIssued(0), TotalElided(0)
+{
+	Invalidate();
+}
+
+void GLStateCache::Invalidate()
+{
+	Program = GUnknown;
+	Unit = GUnknown;
+	for(int i = 0; i < GLSTATE_TEXTURE_UNITS; i++)
+	{
+		Texture2D[i] = GUnknown;
+		TextureCube[i] = GUnknown;
+	}
+	ArrayBuffer = GUnknown;
+	ElementBuffer = GUnknown;
+	Framebuffer = GUnknown;
+	for(int i = 0; i < GLSTATE_CAPS; i++)
+		Caps[i] = -1;
+	for(int i = 0; i < GLSTATE_VERTEX_ATTRIBS; i++)
+		Attribs[i] = -1;
+	BlendSource = GUnknown;
+	BlendDestination = GUnknown;
+	DepthCompare = GUnknown;
+	ViewportRect[0] = ViewportRect[1] = 0;
+	ViewportRect[2] = ViewportRect[3] = -1;
+}
+
+bool GLStateCache::Redundant(bool same)
+{
+	if(same && Enabled)
+	{
+		Elided++;
+		TotalElided++;
+		return true;
+	}
+	Issued++;
+	TotalIssued++;
+	return false;
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+	if(Redundant(Program == program))
+		return;
+	Program = program;
+	glUseProgram(program);
+}
+
+void GLStateCache::ActiveTexture(GLenum texture)
+{
+	if(Redundant(Unit == texture - GL_TEXTURE0))
+		return;
+	Unit = texture - GL_TEXTURE0;
+	glActiveTexture(texture);
+}
+
+// NULL for targets and units it doesn't follow, those always go to GL
+GLuint* GLStateCache::BoundTexture(GLenum target)
+{
+	if(Unit >= GLSTATE_TEXTURE_UNITS)
+		return NULL;
+	if(target == GL_TEXTURE_2D)
+		return &Texture2D[Unit];
+	if(target == GL_TEXTURE_CUBE_MAP)
+		return &TextureCube[Unit];
+	return NULL;
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+	GLuint* bound = BoundTexture(target);
+	if(Redundant(bound && *bound == texture))
+		return;
+	if(bound)
+		*bound = texture;
+	glBindTexture(target, texture);
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+	GLuint* bound = target == GL_ARRAY_BUFFER ? &ArrayBuffer : target == GL_ELEMENT_ARRAY_BUFFER ? &ElementBuffer : NULL;
+	if(Redundant(bound && *bound == buffer))
+		return;
+	if(bound)
+		*bound = buffer;
+	glBindBuffer(target, buffer);
+}
+
+void GLStateCache::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	if(Redundant(Framebuffer == framebuffer))
+		return;
+	Framebuffer = framebuffer;
+	glBindFramebuffer(target, framebuffer);
+}
+
+void GLStateCache::SetCap(GLenum cap, bool on)
+{
+	int i = capIndex(cap);
+	if(Redundant(i >= 0 && Caps[i] == (on ? 1 : 0)))
+		return;
+	if(i >= 0)
+		Caps[i] = on ? 1 : 0;
+	if(on)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+void GLStateCache::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	if(Redundant(BlendSource == sfactor && BlendDestination == dfactor))
+		return;
+	BlendSource = sfactor;
+	BlendDestination = dfactor;
+	glBlendFunc(sfactor, dfactor);
+}
+
+void GLStateCache::DepthFunc(GLenum func)
+{
+	if(Redundant(DepthCompare == func))
+		return;
+	DepthCompare = func;
+	glDepthFunc(func);
+}
+
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	if(Redundant(ViewportRect[0] == x && ViewportRect[1] == y && ViewportRect[2] == width && ViewportRect[3] == height))
+		return;
+	ViewportRect[0] = x;
+	ViewportRect[1] = y;
+	ViewportRect[2] = width;
+	ViewportRect[3] = height;
+	glViewport(x, y, width, height);
+}
+
+void GLStateCache::EnableVertexAttribArray(GLuint index)
+{
+	if(Redundant(index < GLSTATE_VERTEX_ATTRIBS && Attribs[index] == 1))
+		return;
+	if(index < GLSTATE_VERTEX_ATTRIBS)
+		Attribs[index] = 1;
+	glEnableVertexAttribArray(index);
+}
+
+void GLStateCache::DisableVertexAttribArray(GLuint index)
+{
+	if(Redundant(index < GLSTATE_VERTEX_ATTRIBS && Attribs[index] == 0))
+		return;
+	if(index < GLSTATE_VERTEX_ATTRIBS)
+		Attribs[index] = 0;
+	glDisableVertexAttribArray(index);
+}
+
+void GLStateCache::DeleteProgram(GLuint program)
+{
+	if(Program == program)
+		Program = GUnknown;
+	glDeleteProgram(program);
+}
+
+// GL unbinds a deleted object wherever it is bound, the cache follows
+void GLStateCache::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	for(GLsizei i = 0; i < n; i++)
+	{
+		for(int u = 0; u < GLSTATE_TEXTURE_UNITS; u++)
+		{
+			if(Texture2D[u] == textures[i])
+				Texture2D[u] = 0;
+			if(TextureCube[u] == textures[i])
+				TextureCube[u] = 0;
+		}
+	}
+	glDeleteTextures(n, textures);
+}
+
+void GLStateCache::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	for(GLsizei i = 0; i < n; i++)
+	{
+		if(ArrayBuffer == buffers[i])
+			ArrayBuffer = 0;
+		if(ElementBuffer == buffers[i])
+			ElementBuffer = 0;
+	}
+	glDeleteBuffers(n, buffers);
+}
+
+void GLStateCache::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+	for(GLsizei i = 0; i < n; i++)
+		if(Framebuffer == framebuffers[i])
+			Framebuffer = 0;
+	glDeleteFramebuffers(n, framebuffers);
+}
+
+void GLStateCache::BeginFrame()
+{
+	LastIssued = Issued;
+	LastElided = Elided;
+	Issued = 0;
+	Elided = 0;
+}
+
+void GLStateCache::PrintStats(const char* label)
+{
+	unsigned long long total = TotalIssued + TotalElided;
+	printf("%s: last frame %u state calls issued, %u elided; in all %llu issued, %llu elided (%.1f%%)%s\n",
+		label, LastIssued, LastElided, TotalIssued, TotalElided,
+		total ? TotalElided * 100.0 / total : 0.0, Enabled ? "" : ", cache off");
+}
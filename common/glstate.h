@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GLES2/gl2.h"
+
+#define GLSTATE_TEXTURE_UNITS 8
+#define GLSTATE_VERTEX_ATTRIBS 16
+#define GLSTATE_CAPS 9
+
+// Remembers the GL state set through it and drops calls that would set what is already
+// set, with the same shape as the GL calls (GGLState.BindTexture(GL_TEXTURE_2D, id)).
+// Everything starts unknown, so the first call of each kind always goes to GL.
+// Code that changes this state with plain GL calls has to Invalidate afterwards, and
+// objects have to be deleted through it so a name GL hands out again isn't taken for
+// still bound. GL thread only.
+class GLStateCache
+{
+	bool Enabled;
+	GLuint Program;
+	unsigned int Unit;                                  // active texture unit, 0 based
+	GLuint Texture2D[GLSTATE_TEXTURE_UNITS];
+	GLuint TextureCube[GLSTATE_TEXTURE_UNITS];
+	GLuint ArrayBuffer;
+	GLuint ElementBuffer;
+	GLuint Framebuffer;
+	signed char Caps[GLSTATE_CAPS];                     // -1 unknown, 0 off, 1 on
+	signed char Attribs[GLSTATE_VERTEX_ATTRIBS];
+	GLenum BlendSource, BlendDestination;
+	GLenum DepthCompare;
+	GLint ViewportRect[4];
+
+	// Counts the call, true when it can be dropped
+	bool Redundant(bool same);
+	GLuint* BoundTexture(GLenum target);
+	void SetCap(GLenum cap, bool on);
+
+public:
+
+	GLStateCache();
+
+	void UseProgram(GLuint program);
+	void ActiveTexture(GLenum texture);
+	void BindTexture(GLenum target, GLuint texture);
+	void BindBuffer(GLenum target, GLuint buffer);
+	void BindFramebuffer(GLenum target, GLuint framebuffer);
+	void Enable(GLenum cap) { SetCap(cap, true); }
+	void Disable(GLenum cap) { SetCap(cap, false); }
+	void BlendFunc(GLenum sfactor, GLenum dfactor);
+	void DepthFunc(GLenum func);
+	void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	void EnableVertexAttribArray(GLuint index);
+	void DisableVertexAttribArray(GLuint index);
+
+	void DeleteProgram(GLuint program);
+	void DeleteTextures(GLsizei n, const GLuint* textures);
+	void DeleteBuffers(GLsizei n, const GLuint* buffers);
+	void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+	// Forgets everything, for after GL calls that went around the cache
+	void Invalidate();
+	// Off passes every call through, to compare against
+	void SetEnabled(bool enabled) { Enabled = enabled; Invalidate(); }
+
+	// Calls sent to GL and dropped, this frame and the one before
+	unsigned int Issued, Elided;
+	unsigned int LastIssued, LastElided;
+	unsigned long long TotalIssued, TotalElided;
+
+	void BeginFrame();
+	void PrintStats(const char* label);
+};
+
+extern GLStateCache GGLState;
@@ -0,0 +1,166 @@
+#include <stdio.h>
+
+#include "gpumemory.h"
+#include "glstate.h"
+
+GpuMemory GGpuMemory;
+
+static const char* GCategoryNames[GPU_CATEGORY_COUNT] = { "textures", "vertex buffers", "index buffers", "render targets" };
+
+GpuMemory::GpuMemory()
+{
+	for(int i = 0; i < GPU_CATEGORY_COUNT; i++)
+	{
+		Current[i] = 0;
+		Peak[i] = 0;
+	}
+	Total = 0;
+	PeakTotal = 0;
+	Budget = 0;
+	// objects start out used in frame 1, the first BeginFrame makes them evictable
+	Frame = 1;
+	ResetStats();
+}
+
+bool GpuMemory::Reserve(size_t bytes)
+{
+	if(!Budget || Total + bytes <= Budget)
+		return true;
+
+	// check first so a reserve that can't succeed doesn't throw out textures for nothing
+	size_t freeable = Budget > Total ? Budget - Total : 0;
+	std::list<unsigned long long>::reverse_iterator it = LRU.rbegin();
+	for(; freeable < bytes && it != LRU.rend(); ++it)
+	{
+		const Allocation& a = Allocations[*it];
+		if(a.LastUsed == Frame)
+			break;
+		freeable += a.Bytes;
+	}
+	if(freeable < bytes)
+	{
+		OverBudget++;
+		printf("GPU memory over budget: %.2f MB more on %.2f / %.2f MB used, nothing left to evict\n",
+			bytes / (1024.0 * 1024.0), Total / (1024.0 * 1024.0), Budget / (1024.0 * 1024.0));
+		return false;
+	}
+
+	while(Total + bytes > Budget)
+	{
+		unsigned long long victim = LRU.back();
+		Allocation& a = Allocations[victim];
+		unsigned int name = (unsigned int)victim;
+		Evictions++;
+		BytesEvicted += a.Bytes;
+		a.Evict(a.Owner, name);
+		// the owner should have untracked it, make sure the loop moves on
+		if(Allocations.count(victim))
+			Untrack((GpuObjectType)(victim >> 32), name);
+	}
+	return true;
+}
+
+void GpuMemory::Track(GpuObjectType type, unsigned int name, GpuMemoryCategory category, size_t bytes,
+	GpuEvictFunction evict, void* owner)
+{
+	if(!name)
+		return;
+	Untrack(type, name);
+
+	unsigned long long key = Key(type, name);
+	Allocation& a = Allocations[key];
+	a.Category = category;
+	a.Bytes = bytes;
+	a.Evict = evict;
+	a.Owner = owner;
+	a.LastUsed = Frame;
+	if(evict)
+	{
+		LRU.push_front(key);
+		a.Position = LRU.begin();
+	}
+
+	Current[category] += bytes;
+	if(Current[category] > Peak[category])
+		Peak[category] = Current[category];
+	Total += bytes;
+	if(Total > PeakTotal)
+		PeakTotal = Total;
+}
+
+void GpuMemory::Untrack(GpuObjectType type, unsigned int name)
+{
+	std::map<unsigned long long, Allocation>::iterator it = Allocations.find(Key(type, name));
+	if(it == Allocations.end())
+		return;
+	Allocation& a = it->second;
+	Current[a.Category] -= a.Bytes;
+	Total -= a.Bytes;
+	if(a.Evict)
+		LRU.erase(a.Position);
+	Allocations.erase(it);
+}
+
+void GpuMemory::Touch(GpuObjectType type, unsigned int name)
+{
+	std::map<unsigned long long, Allocation>::iterator it = Allocations.find(Key(type, name));
+	if(it == Allocations.end())
+		return;
+	Allocation& a = it->second;
+	a.LastUsed = Frame;
+	if(a.Evict)
+		LRU.splice(LRU.begin(), LRU, a.Position);
+}
+
+void GpuMemory::PrintStats(const char* label)
+{
+	printf("%s: %.2f MB used (peak %.2f), budget ", label, Total / (1024.0 * 1024.0), PeakTotal / (1024.0 * 1024.0));
+	if(Budget)
+		printf("%.2f MB", Budget / (1024.0 * 1024.0));
+	else
+		printf("none");
+	printf(", %llu evictions (%.2f MB), %llu allocations over budget\n",
+		Evictions, BytesEvicted / (1024.0 * 1024.0), OverBudget);
+	for(int i = 0; i < GPU_CATEGORY_COUNT; i++)
+		printf("  %-15s %8.2f MB (peak %.2f)\n", GCategoryNames[i], Current[i] / (1024.0 * 1024.0), Peak[i] / (1024.0 * 1024.0));
+}
+
+void GpuMemory::ResetStats()
+{
+	Evictions = 0;
+	BytesEvicted = 0;
+	OverBudget = 0;
+}
+
+size_t gpuImageBytes(unsigned int width, unsigned int height, unsigned int bytes_per_pixel, unsigned int levels)
+{
+	size_t bytes = 0;
+	for(unsigned int level = 0; levels == 0 || level < levels; level++)
+	{
+		bytes += (size_t)width * height * bytes_per_pixel;
+		if(width == 1 && height == 1)
+			break;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return bytes;
+}
+
+GLuint createBuffer(GLenum target, const void* data, size_t bytes, GLenum usage)
+{
+	GGpuMemory.Reserve(bytes);
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	GGLState.BindBuffer(target, buffer);
+	glBufferData(target, bytes, data, usage);
+	GGpuMemory.Track(GPU_OBJECT_BUFFER, buffer, target == GL_ELEMENT_ARRAY_BUFFER ? GPU_INDEX_BUFFERS : GPU_VERTEX_BUFFERS, bytes);
+	return buffer;
+}
+
+void deleteBuffer(GLuint buffer)
+{
+	if(!buffer)
+		return;
+	GGpuMemory.Untrack(GPU_OBJECT_BUFFER, buffer);
+	GGLState.DeleteBuffers(1, &buffer);
+}
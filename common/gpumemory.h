@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stddef.h>
+#include <list>
+#include <map>
+
+#include "GLES2/gl2.h"
+
+enum GpuMemoryCategory
+{
+	GPU_TEXTURES,
+	GPU_VERTEX_BUFFERS,
+	GPU_INDEX_BUFFERS,
+	GPU_RENDER_TARGETS,
+	GPU_CATEGORY_COUNT
+};
+
+// GL keeps a separate name space for each kind of object
+enum GpuObjectType
+{
+	GPU_OBJECT_TEXTURE,
+	GPU_OBJECT_BUFFER,
+	GPU_OBJECT_RENDERBUFFER
+};
+
+// Called to free an evictable object, it must delete the GL object and Untrack it.
+// The owner reloads it later when it is needed again.
+typedef void (*GpuEvictFunction)(void* owner, unsigned int name);
+
+// Accounting of everything allocated in GPU memory, by category, against a budget.
+// Allocations call Reserve before creating the object and Track once it exists, deletes call
+// Untrack. Objects tracked with an evict function can be reloaded by their owner, Reserve
+// frees those least recently used first, but never one touched in the current frame.
+// GL thread only, like the objects it counts.
+class GpuMemory
+{
+	struct Allocation
+	{
+		GpuMemoryCategory Category;
+		size_t Bytes;
+		GpuEvictFunction Evict;
+		void* Owner;
+		unsigned int LastUsed;
+		std::list<unsigned long long>::iterator Position;   // in LRU when Evict is set
+	};
+
+	std::map<unsigned long long, Allocation> Allocations;
+	std::list<unsigned long long> LRU;       // evictable objects, most recently used at the front
+	size_t Current[GPU_CATEGORY_COUNT];
+	size_t Peak[GPU_CATEGORY_COUNT];
+	size_t Total;
+	size_t PeakTotal;
+	size_t Budget;
+	unsigned int Frame;
+
+	static unsigned long long Key(GpuObjectType type, unsigned int name) { return ((unsigned long long)type << 32) | name; }
+
+public:
+
+	unsigned long long Evictions;
+	unsigned long long BytesEvicted;
+	unsigned long long OverBudget;          // allocations that went ahead past the budget
+
+	GpuMemory();
+
+	// 0 is no budget, usage is still counted
+	void SetBudget(size_t bytes) { Budget = bytes; }
+	size_t GetBudget() { return Budget; }
+	void BeginFrame() { Frame++; }
+
+	// Makes room for bytes by evicting, false when it can't. The allocation can still go
+	// ahead, a warning is printed then.
+	bool Reserve(size_t bytes);
+	// Tracking a name again replaces the old entry, so a texture can be given an evict
+	// function or moved to another category after it was created
+	void Track(GpuObjectType type, unsigned int name, GpuMemoryCategory category, size_t bytes,
+		GpuEvictFunction evict = NULL, void* owner = NULL);
+	void Untrack(GpuObjectType type, unsigned int name);
+	// Marks the object used in this frame
+	void Touch(GpuObjectType type, unsigned int name);
+
+	size_t GetCurrent(GpuMemoryCategory category) { return Current[category]; }
+	size_t GetPeak(GpuMemoryCategory category) { return Peak[category]; }
+	size_t GetTotal() { return Total; }
+	size_t GetPeakTotal() { return PeakTotal; }
+
+	void PrintStats(const char* label);
+	void ResetStats();
+};
+
+// Bytes a level chain takes down to 1x1, 0 levels is the full chain
+size_t gpuImageBytes(unsigned int width, unsigned int height, unsigned int bytes_per_pixel, unsigned int levels = 1);
+
+extern GpuMemory GGpuMemory;
+
+// glGenBuffers and glBufferData with the Reserve and Track around them, an element array
+// counts as an index buffer and anything else as a vertex buffer. Leaves it bound.
+GLuint createBuffer(GLenum target, const void* data, size_t bytes, GLenum usage = GL_STATIC_DRAW);
+// Untracks and deletes a buffer from createBuffer, 0 is ignored
+void deleteBuffer(GLuint buffer);
@@ -3,6 +3,10 @@
 #include "GLES2/gl2.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
+#include <vector>
+#include "pixelconvert.h"
+#include "programreflect.h"
+#include "spritebatch.h"
 
 void InitGraphics();
 void ReleaseGraphics();
@@ -20,8 +24,13 @@ public:
 	GfxShader() : Src(NULL), Id(0), GlShaderType(0) {}
 	~GfxShader() { if(Src) delete[] Src; }
 
+	// Read the source, it is compiled later by Compile
 	bool LoadVertexShader(const char* filename);
 	bool LoadFragmentShader(const char* filename);
+	// Compiles once, GfxProgram::Create calls it when the program isn't in the binary cache
+	// (programcache.h). GetId() is 0 until then.
+	bool Compile();
+	const GLchar* GetSource() { return Src; }
 	GLuint GetId() { return Id; }
 };
 
@@ -30,6 +39,7 @@ class GfxProgram
 	GfxShader* VertexShader;
 	GfxShader* FragmentShader;
 	GLuint Id;
+	ProgramReflection Reflection;
 
 public:
 
@@ -38,6 +48,21 @@ public:
 
 	bool Create(GfxShader* vertex_shader, GfxShader* fragment_shader);
 	GLuint GetId() { return Id; }
+
+	// Active uniforms and attributes, enumerated once by Create (see programreflect.h).
+	// Look the indices up at init, not per draw.
+	int GetUniform(const char* name) const { return Reflection.FindUniform(name); }
+	GLint GetAttrib(const char* name) const { return Reflection.FindAttrib(name); }
+	ProgramReflection& GetReflection() { return Reflection; }
+
+	// Upload only what changed, with the program in use
+	void SetInt(int uniform, GLint value) { Reflection.SetInt(uniform, value); }
+	void SetFloat(int uniform, GLfloat value) { Reflection.SetFloat(uniform, value); }
+	void SetVec2(int uniform, GLfloat x, GLfloat y) { Reflection.SetVec2(uniform, x, y); }
+	void SetVec3(int uniform, GLfloat x, GLfloat y, GLfloat z) { Reflection.SetVec3(uniform, x, y, z); }
+	void SetVec4(int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w) { Reflection.SetVec4(uniform, x, y, z, w); }
+	void SetMat3(int uniform, const GLfloat* m) { Reflection.SetMat3(uniform, m); }
+	void SetMat4(int uniform, const GLfloat* m) { Reflection.SetMat4(uniform, m); }
 };
 
 class GfxTexture
@@ -46,18 +71,26 @@ class GfxTexture
 	int Height;
 	GLuint Id;
 	bool IsRGBA;
+	bool IsRGB565;
+	std::vector<unsigned char> Converted; // staging for SetPixels with a layout
 
 	GLuint FramebufferId;
 public:
 
-	GfxTexture() : Width(0), Height(0), Id(0), FramebufferId(0) {}
+	GfxTexture() : Width(0), Height(0), Id(0), IsRGBA(false), IsRGB565(false), FramebufferId(0) {}
 	~GfxTexture() {}
 
 	bool CreateRGBA(int width, int height, const void* data = NULL);
+	// Half the memory and bandwidth of RGBA, data (if any) is RGBA and converted on upload
+	bool CreateRGB565(int width, int height, const void* rgba_data = NULL);
         bool CreatePixRGBA(const void* data = NULL);
 	bool CreateGreyScale(int width, int height, const void* data = NULL);
 	bool GenerateFrameBuffer();
+	// Deletes the texture and its frame buffer
+	void Release();
 	void SetPixels(const void* data);
+	// data in any PixelLayout, converted to what the texture holds first
+	void SetPixels(const void* data, PixelLayout layout, bool flip_rows = false);
 	GLuint GetId() { return Id; }
 	GLuint GetFramebufferId() { return FramebufferId; }
 	int GetWidth() {return Width;}
@@ -67,5 +100,11 @@ public:
 
 void SaveFrameBuffer(const char* fname);
 
+// State goes through GGLState (glstate.h) and is left set for the next draw: buffers and
+// textures stay bound, blending stays on after DrawTextureRect and off after
+// DrawYUVTextureRect. DrawTextureRect is a one rect GSpriteBatch, draw many rects through
+// GSpriteBatch directly so they share the draw call. Its whichTexture is ignored, the batch
+// has its own vertex buffer.
+extern SpriteBatch GSpriteBatch;
 void DrawTextureRect(GfxTexture* texture, float x0, float y0, float x1, float y1, GfxTexture* render_target, int whichTexture, float x, float y);
 void DrawYUVTextureRect(GfxTexture* ytexture, GfxTexture* utexture, GfxTexture* vtexture, float x0, float y0, float x1, float y1, GfxTexture* render_target, int whichTexture);
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ktxfile.h"
+#include "mappedfile.h"
+#include "etc1.h"
+
+static const unsigned char KTXIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+#define KTX_ENDIANNESS 0x04030201
+#define KTX_HEADER_SIZE 64
+
+#define PKM_HEADER_SIZE 16
+#define PKM_ETC1_RGB_NO_MIPMAPS 0
+
+// KTX header fields after the identifier, in the writer's byte order
+struct KTXHeader
+{
+	uint32_t Endianness;
+	uint32_t GLType, GLTypeSize, GLFormat;
+	uint32_t GLInternalFormat, GLBaseInternalFormat;
+	uint32_t PixelWidth, PixelHeight, PixelDepth;
+	uint32_t NumberOfArrayElements, NumberOfFaces, NumberOfMipmapLevels;
+	uint32_t BytesOfKeyValueData;
+};
+
+static void putBigEndian16(unsigned char* p, unsigned int v)
+{
+	p[0] = (unsigned char)(v >> 8);
+	p[1] = (unsigned char)v;
+}
+
+static unsigned int getBigEndian16(const unsigned char* p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+void setLevelPixels(TextureLevel& level, const unsigned char* pixels, unsigned int width, unsigned int height, int pixel_size)
+{
+	size_t rowSize = width * pixel_size, paddedSize = (rowSize + 3) & ~(size_t)3;
+	level.Width = width;
+	level.Height = height;
+	level.Data.assign(paddedSize * height, 0);
+	for(unsigned int y = 0; y < height; y++)
+		memcpy(&level.Data[y * paddedSize], pixels + y * rowSize, rowSize);
+}
+
+bool writeKTX(const char* path, const TextureImage& image)
+{
+	if(image.Levels.empty())
+		return false;
+
+	KTXHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Endianness = KTX_ENDIANNESS;
+	header.GLType = image.Type;
+	header.GLTypeSize = 1;   // bytes, compressed or not
+	header.GLFormat = image.Format;
+	header.GLInternalFormat = image.InternalFormat;
+	header.GLBaseInternalFormat = image.Format == KTX_RGBA || image.InternalFormat == KTX_RGBA ? KTX_RGBA : KTX_RGB;
+	header.PixelWidth = image.Levels[0].Width;
+	header.PixelHeight = image.Levels[0].Height;
+	header.NumberOfFaces = 1;
+	header.NumberOfMipmapLevels = image.Levels.size();
+
+	FILE* f = fopen(path, "wb");
+	if(!f)
+		return false;
+
+	bool ok = fwrite(KTXIdentifier, 1, sizeof(KTXIdentifier), f) == sizeof(KTXIdentifier)
+		&& fwrite(&header, sizeof(header), 1, f) == 1;
+	for(size_t i = 0; ok && i < image.Levels.size(); i++)
+	{
+		const std::vector<unsigned char>& data = image.Levels[i].Data;
+		uint32_t size = data.size();
+		static const unsigned char padding[3] = { 0, 0, 0 };
+		ok = fwrite(&size, sizeof(size), 1, f) == 1
+			&& (data.empty() || fwrite(&data[0], 1, data.size(), f) == data.size())
+			&& fwrite(padding, 1, (4 - size % 4) % 4, f) == (4 - size % 4) % 4;
+	}
+	return fclose(f) == 0 && ok;
+}
+
+bool writePKM(const char* path, const TextureImage& image)
+{
+	if(image.Levels.empty() || image.InternalFormat != KTX_ETC1_RGB8_OES)
+		return false;
+	const TextureLevel& level = image.Levels[0];
+
+	unsigned char header[PKM_HEADER_SIZE];
+	memcpy(header, "PKM 10", 6);
+	putBigEndian16(header + 6, PKM_ETC1_RGB_NO_MIPMAPS);
+	putBigEndian16(header + 8, (level.Width + 3) & ~3u);
+	putBigEndian16(header + 10, (level.Height + 3) & ~3u);
+	putBigEndian16(header + 12, level.Width);
+	putBigEndian16(header + 14, level.Height);
+
+	FILE* f = fopen(path, "wb");
+	if(!f)
+		return false;
+	bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header)
+		&& (level.Data.empty() || fwrite(&level.Data[0], 1, level.Data.size(), f) == level.Data.size());
+	return fclose(f) == 0 && ok;
+}
+
+// Bytes a level of the header's format needs, 0 for a format this can't size.
+// 64 bit so a lying header can't wrap it on the Pi.
+static unsigned long long ktxLevelSize(const KTXHeader& header, unsigned int width, unsigned int height)
+{
+	if(header.GLType == 0)
+		return header.GLInternalFormat == KTX_ETC1_RGB8_OES ? (unsigned long long)((width + 3) / 4) * ((height + 3) / 4) * 8 : 0;
+
+	int pixel_size = 0;
+	switch(header.GLFormat)
+	{
+	case KTX_ALPHA:
+	case KTX_LUMINANCE:       pixel_size = 1; break;
+	case KTX_LUMINANCE_ALPHA: pixel_size = 2; break;
+	case KTX_RGB:             pixel_size = 3; break;
+	case KTX_RGBA:            pixel_size = 4; break;
+	}
+	// rows padded to 4 bytes, as setLevelPixels writes them
+	return (((unsigned long long)width * pixel_size + 3) & ~3ull) * height;
+}
+
+static bool parseKTX(const unsigned char* data, size_t size, TextureImage& out_image)
+{
+	KTXHeader header;
+	memcpy(&header, data + sizeof(KTXIdentifier), sizeof(header));
+	if(header.Endianness != KTX_ENDIANNESS)
+	{
+		printf("KTX file is the wrong endianness\n");
+		return false;
+	}
+	if(header.PixelDepth > 1 || header.NumberOfArrayElements != 0 || header.NumberOfFaces != 1)
+	{
+		printf("Only single 2D KTX textures are supported\n");
+		return false;
+	}
+	if(header.GLType != 0 && header.GLType != KTX_UNSIGNED_BYTE)
+	{
+		printf("Only byte or compressed KTX textures are supported\n");
+		return false;
+	}
+	if(header.PixelWidth == 0 || header.PixelHeight == 0 || ktxLevelSize(header, 1, 1) == 0)
+	{
+		printf("KTX texture has no size or a format that isn't supported\n");
+		return false;
+	}
+
+	out_image.InternalFormat = header.GLInternalFormat;
+	out_image.Format = header.GLFormat;
+	out_image.Type = header.GLType;
+	out_image.Levels.clear();
+	// every offset is checked against what is left rather than added first, a size_t
+	// is 32 bits on the Pi and a bad header could wrap it
+	if(header.BytesOfKeyValueData > size - KTX_HEADER_SIZE)
+	{
+		printf("KTX file is truncated\n");
+		return false;
+	}
+	size_t offset = KTX_HEADER_SIZE + header.BytesOfKeyValueData;
+	unsigned int levels = header.NumberOfMipmapLevels ? header.NumberOfMipmapLevels : 1;
+	unsigned int width = header.PixelWidth, height = header.PixelHeight;
+	for(unsigned int i = 0; i < levels; i++)
+	{
+		uint32_t levelSize;
+		if(size - offset < sizeof(levelSize))
+			break;
+		memcpy(&levelSize, data + offset, sizeof(levelSize));
+		offset += sizeof(levelSize);
+		if(levelSize > size - offset)
+			break;
+		unsigned long long expected = ktxLevelSize(header, width, height);
+		if(levelSize != expected)
+		{
+			printf("KTX level %u is %u bytes, %ux%u needs %llu\n", i, levelSize, width, height, expected);
+			return false;
+		}
+
+		TextureLevel level;
+		level.Width = width;
+		level.Height = height;
+		level.Data.assign(data + offset, data + offset + levelSize);
+		out_image.Levels.push_back(level);
+
+		// the padding after the last level may be missing
+		size_t padded = ((size_t)levelSize + 3) & ~(size_t)3;
+		offset = padded < size - offset ? offset + padded : size;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	if(out_image.Levels.size() != levels)
+	{
+		printf("KTX file is truncated\n");
+		return false;
+	}
+	return true;
+}
+
+static bool parsePKM(const unsigned char* data, size_t size, TextureImage& out_image)
+{
+	if(getBigEndian16(data + 6) != PKM_ETC1_RGB_NO_MIPMAPS)
+	{
+		printf("Only ETC1 PKM files are supported\n");
+		return false;
+	}
+
+	// the padded size is what is stored, it has to be the real size rounded up to blocks
+	unsigned int paddedWidth = getBigEndian16(data + 8), paddedHeight = getBigEndian16(data + 10);
+	TextureLevel level;
+	level.Width = getBigEndian16(data + 12);
+	level.Height = getBigEndian16(data + 14);
+	if(level.Width == 0 || level.Height == 0 ||
+		paddedWidth != ((level.Width + 3) & ~3u) || paddedHeight != ((level.Height + 3) & ~3u))
+	{
+		printf("PKM file is %ux%u stored as %ux%u\n", level.Width, level.Height, paddedWidth, paddedHeight);
+		return false;
+	}
+	size_t levelSize = (size_t)(paddedWidth / 4) * (paddedHeight / 4) * 8;
+	if(levelSize != etc1ImageSize(level.Width, level.Height))
+	{
+		printf("PKM level is %lu bytes, %ux%u needs %lu\n", (unsigned long)levelSize, level.Width, level.Height,
+			(unsigned long)etc1ImageSize(level.Width, level.Height));
+		return false;
+	}
+	if(levelSize > size - PKM_HEADER_SIZE)
+	{
+		printf("PKM file is truncated\n");
+		return false;
+	}
+	level.Data.assign(data + PKM_HEADER_SIZE, data + PKM_HEADER_SIZE + levelSize);
+
+	out_image.InternalFormat = KTX_ETC1_RGB8_OES;
+	out_image.Format = out_image.Type = 0;
+	out_image.Levels.assign(1, level);
+	return true;
+}
+
+bool readTextureFile(const char* path, TextureImage& out_image)
+{
+	MappedFile file;
+	if(!file.Open(path))
+		return false;
+
+	const unsigned char* data = (const unsigned char*)file.GetData();
+	size_t size = file.GetSize();
+	if(size >= KTX_HEADER_SIZE && memcmp(data, KTXIdentifier, sizeof(KTXIdentifier)) == 0)
+		return parseKTX(data, size, out_image);
+	if(size >= PKM_HEADER_SIZE && memcmp(data, "PKM ", 4) == 0)
+		return parsePKM(data, size, out_image);
+
+	printf("%s is not a KTX or PKM file\n", path);
+	return false;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+// Containers for textures built offline with their mip chains: KTX 1.1 (compressed or
+// plain bytes, any number of levels) and PKM (Ericsson's ETC1 format, level 0 only).
+// No GL here, the tools write them offline.
+
+#define KTX_ETC1_RGB8_OES   0x8D64
+#define KTX_ALPHA           0x1906
+#define KTX_RGB             0x1907
+#define KTX_RGBA            0x1908
+#define KTX_LUMINANCE       0x1909
+#define KTX_LUMINANCE_ALPHA 0x190A
+#define KTX_UNSIGNED_BYTE   0x1401
+
+struct TextureLevel
+{
+	unsigned int Width, Height;
+	// Uncompressed rows are padded to 4 bytes, ready for the default GL_UNPACK_ALIGNMENT
+	std::vector<unsigned char> Data;
+};
+
+struct TextureImage
+{
+	unsigned int InternalFormat;   // e.g. KTX_ETC1_RGB8_OES or KTX_RGB
+	unsigned int Format, Type;     // glTexImage2D format and type, both 0 when compressed
+	std::vector<TextureLevel> Levels;   // level 0 first, each half the size of the last
+};
+
+// Copies tightly packed pixels into a level, padding the rows
+void setLevelPixels(TextureLevel& level, const unsigned char* pixels, unsigned int width, unsigned int height, int pixel_size);
+
+bool writeKTX(const char* path, const TextureImage& image);
+// Only the first level of an ETC1 image goes in, PKM has no mip maps
+bool writePKM(const char* path, const TextureImage& image);
+
+// Reads either container, told apart by the magic at the start
+bool readTextureFile(const char* path, TextureImage& out_image);
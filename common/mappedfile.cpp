@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mappedfile.h"
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	// mmap refuses zero length mappings, an empty file is still a valid (empty) view
+	Size = st.st_size;
+	if(Size == 0)
+	{
+		close(fd);
+		return true;
+	}
+
+	Data = mmap(NULL, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps its own reference to the file
+	close(fd);
+	if(Data == MAP_FAILED)
+	{
+		printf("Failed to map %s\n", filename);
+		Data = NULL;
+		Size = 0;
+		return false;
+	}
+
+	// we nearly always walk the file front to back, let the kernel read ahead
+	madvise(Data, Size, MADV_SEQUENTIAL);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(Data)
+		munmap(Data, Size);
+	Data = NULL;
+	Size = 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+
+// Read-only view of a whole file through mmap.
+// The data is NOT null terminated, always use GetSize() to find the end.
+class MappedFile
+{
+	void* Data;
+	size_t Size;
+
+public:
+
+	MappedFile() : Data(NULL), Size(0) {}
+	~MappedFile() { Close(); }
+
+	bool Open(const char* filename);
+	void Close();
+	const char* GetData() { return (const char*)Data; }
+	size_t GetSize() { return Size; }
+};
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "meshfile.h"
+#include "objloader.h"
+
+bool MeshFile::Open(const char* filename)
+{
+	Close();
+	if(!File.Open(filename))
+		return false;
+
+	// refuse anything that doesn't add up rather than reading off the end of the mapping
+	const MeshFileHeader* h = (const MeshFileHeader*)File.GetData();
+	size_t size = File.GetSize();
+	if(size < sizeof(MeshFileHeader) ||
+	   h->Magic != MESHFILE_MAGIC ||
+	   h->Version != MESHFILE_VERSION ||
+	   h->VertexStride != sizeof(MeshVertex) ||
+	   h->VertexOffset % 4 != 0 || h->IndexOffset % 2 != 0 ||
+	   h->VertexOffset + (unsigned long long)h->VertexCount * h->VertexStride > size ||
+	   h->IndexOffset + (unsigned long long)h->IndexCount * sizeof(unsigned short) > size ||
+	   !checkMeshIndices((const unsigned short*)(File.GetData() + h->IndexOffset), h->IndexCount, h->VertexCount))
+	{
+		printf("%s is not a valid version %d mesh file\n", filename, MESHFILE_VERSION);
+		File.Close();
+		return false;
+	}
+
+	Header = h;
+	return true;
+}
+
+void MeshFile::Close()
+{
+	File.Close();
+	Header = NULL;
+}
+
+bool checkMeshIndices(const unsigned short* indices, size_t count, unsigned int vertex_count)
+{
+	unsigned short largest = 0;
+	for(size_t i = 0; i < count; i++)
+		largest = std::max(largest, indices[i]);
+	return count == 0 || largest < vertex_count;
+}
+
+bool writeMeshFile(
+	const char * path,
+	const std::vector<unsigned short> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+){
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = MESHFILE_MAGIC;
+	header.Version = MESHFILE_VERSION;
+	header.VertexCount = vertices.size();
+	header.IndexCount = indices.size();
+	header.VertexStride = sizeof(MeshVertex);
+	header.VertexOffset = (sizeof(MeshFileHeader) + 15) & ~15;
+	header.IndexOffset = header.VertexOffset + header.VertexCount * header.VertexStride;
+
+	std::vector<MeshVertex> interleaved(vertices.size());
+	glm::vec3 bmin(0.0f), bmax(0.0f);
+	for(size_t i = 0; i < vertices.size(); i++)
+	{
+		MeshVertex& v = interleaved[i];
+		memcpy(v.Position, &vertices[i].x, sizeof(v.Position));
+		memcpy(v.UV, &uvs[i].x, sizeof(v.UV));
+		memcpy(v.Normal, &normals[i].x, sizeof(v.Normal));
+		bmin = i ? glm::min(bmin, vertices[i]) : vertices[i];
+		bmax = i ? glm::max(bmax, vertices[i]) : vertices[i];
+	}
+	memcpy(header.BoundsMin, &bmin.x, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, &bmax.x, sizeof(header.BoundsMax));
+
+	// write to a temporary name and rename, so a reader never maps half a file
+	std::string tmp = std::string(path) + ".tmp";
+	FILE* f = fopen(tmp.c_str(), "wb");
+	if(!f)
+		return false;
+
+	static const char padding[16] = { 0 };
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+		fwrite(padding, 1, header.VertexOffset - sizeof(header), f) == header.VertexOffset - sizeof(header) &&
+		(interleaved.empty() || fwrite(&interleaved[0], sizeof(MeshVertex), interleaved.size(), f) == interleaved.size()) &&
+		(indices.empty() || fwrite(&indices[0], sizeof(unsigned short), indices.size(), f) == indices.size());
+	ok = fclose(f) == 0 && ok;
+
+	if(!ok || rename(tmp.c_str(), path) != 0)
+	{
+		remove(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+std::string meshCachePath(const char* objpath)
+{
+	return std::string(objpath) + ".mesh";
+}
+
+bool isMeshCacheFresh(const char* objpath)
+{
+	return isCacheFresh(objpath, meshCachePath(objpath));
+}
+
+bool isCacheFresh(const char* objpath, const std::string& cachepath)
+{
+	struct stat src, cache;
+	if(stat(cachepath.c_str(), &cache) != 0)
+		return false;
+	// no source at all is fine, the cache can be shipped on its own
+	if(stat(objpath, &src) != 0)
+		return true;
+	return cache.st_mtime >= src.st_mtime;
+}
+
+bool openMeshCache(const char* objpath, MeshFile& out)
+{
+	std::string cache = meshCachePath(objpath);
+	if(isMeshCacheFresh(objpath) && out.Open(cache.c_str()))
+		return true;
+
+	// loadOBJIndexed writes the cache as a side effect
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(objpath, indices, vertices, uvs, normals))
+		return false;
+	return out.Open(cache.c_str());
+}
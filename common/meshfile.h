@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "mappedfile.h"
+
+// Binary mesh cache, written by loadOBJIndexed next to the model as <model>.obj.mesh
+//
+//  MeshFileHeader
+//  VertexCount * MeshVertex      at VertexOffset
+//  IndexCount * unsigned short   at IndexOffset
+//
+// Everything is stored little endian, the way the Pi wants it, so a mapped
+// file can be handed to glBufferData as is.
+
+#define MESHFILE_MAGIC   0x4853454D // "MESH"
+#define MESHFILE_VERSION 2 // 2: indices in vertex cache order
+
+struct MeshVertex
+{
+	float Position[3];
+	float UV[2];
+	float Normal[3];
+};
+
+struct MeshFileHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int VertexCount;
+	unsigned int IndexCount;
+	unsigned int VertexStride;
+	unsigned int VertexOffset;
+	unsigned int IndexOffset;
+	unsigned int Flags;       // always 0 for now
+	float BoundsMin[3];
+	float BoundsMax[3];
+};
+
+class MeshFile
+{
+	MappedFile File;
+	const MeshFileHeader* Header;
+
+public:
+
+	MeshFile() : Header(NULL) {}
+	~MeshFile() {}
+
+	bool Open(const char* filename);
+	void Close();
+	const MeshFileHeader* GetHeader() { return Header; }
+	const MeshVertex* GetVertices() { return (const MeshVertex*)(File.GetData() + Header->VertexOffset); }
+	const unsigned short* GetIndices() { return (const unsigned short*)(File.GetData() + Header->IndexOffset); }
+	size_t GetVertexDataSize() { return (size_t)Header->VertexCount * Header->VertexStride; }
+	size_t GetIndexDataSize() { return (size_t)Header->IndexCount * sizeof(unsigned short); }
+};
+
+bool writeMeshFile(
+	const char * path,
+	const std::vector<unsigned short> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+);
+
+// False when an index is vertex_count or more, the GPU would read past the vertex buffer
+bool checkMeshIndices(const unsigned short* indices, size_t count, unsigned int vertex_count);
+
+// Where the cache for an .obj lives, and whether it is at least as new as the .obj.
+// isCacheFresh is the same test for any other file made from the .obj (chunkFilePath).
+std::string meshCachePath(const char* objpath);
+bool isMeshCacheFresh(const char* objpath);
+bool isCacheFresh(const char* objpath, const std::string& cachepath);
+
+// Maps the cache of an .obj, (re)building it first when it is missing or stale
+bool openMeshCache(const char* objpath, MeshFile& out);
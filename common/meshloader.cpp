@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include <vector>
+
+#include "meshfile.h"
+#include "meshloader.h"
+#include "objloader.h"
+#include "meshpartition.h"
+#include "gpumemory.h"
+#include "glstate.h"
+#include "programreflect.h"
+
+static void uploadMesh(const void* vertices, size_t vertices_size, const void* indices, size_t indices_size, MeshBuffers& out)
+{
+	out.VertexBuffer = createBuffer(GL_ARRAY_BUFFER, vertices, vertices_size);
+	out.ElementBuffer = createBuffer(GL_ELEMENT_ARRAY_BUFFER, indices, indices_size);
+}
+
+// When the cache can't be written (read only directory) interleave in memory instead
+static bool loadUncached(const char* objpath, MeshBuffers& out)
+{
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(objpath, indices, vertices, uvs, normals) || indices.empty())
+		return false;
+
+	VertexLayout layout;
+	describeMeshVertex(layout, NULL, NULL, NULL);
+	std::vector<unsigned char> interleaved;
+	buildInterleaved(layout, vertices, uvs, normals, interleaved);
+
+	glm::vec3 bmin = vertices[0], bmax = vertices[0];
+	for(size_t i = 1; i < vertices.size(); i++)
+	{
+		bmin = glm::min(bmin, vertices[i]);
+		bmax = glm::max(bmax, vertices[i]);
+	}
+	memcpy(out.BoundsMin, &bmin.x, sizeof(out.BoundsMin));
+	memcpy(out.BoundsMax, &bmax.x, sizeof(out.BoundsMax));
+
+	out.IndexCount = indices.size();
+	out.VertexCount = vertices.size();
+	out.Stride = layout.GetStride();
+	uploadMesh(&interleaved[0], interleaved.size(), &indices[0], indices.size() * sizeof(unsigned short), out);
+	return true;
+}
+
+bool loadMeshBuffers(const char* objpath, MeshBuffers& out)
+{
+	memset(&out, 0, sizeof(out));
+
+	MeshFile mesh;
+	if(!openMeshCache(objpath, mesh))
+	{
+		if(loadUncached(objpath, out))
+			return true;
+		printf("Could not load mesh %s\n", objpath);
+		return false;
+	}
+
+	const MeshFileHeader* header = mesh.GetHeader();
+	out.IndexCount = header->IndexCount;
+	out.VertexCount = header->VertexCount;
+	out.Stride = header->VertexStride;
+	memcpy(out.BoundsMin, header->BoundsMin, sizeof(out.BoundsMin));
+	memcpy(out.BoundsMax, header->BoundsMax, sizeof(out.BoundsMax));
+
+	// no intermediate copy, the driver reads straight from the page cache
+	uploadMesh(mesh.GetVertices(), mesh.GetVertexDataSize(), mesh.GetIndices(), mesh.GetIndexDataSize(), out);
+
+	printf("Loaded mesh %s: %d vertices, %d indices\n", objpath, out.VertexCount, out.IndexCount);
+	return true;
+}
+
+bool loadMeshLODBuffers(const char* objpath, MeshBuffers& out, MeshLODChain& out_lods)
+{
+	memset(&out, 0, sizeof(out));
+
+	MeshFile mesh;
+	if(!openMeshCache(objpath, mesh))
+	{
+		printf("Could not load mesh %s\n", objpath);
+		return false;
+	}
+
+	const MeshFileHeader* header = mesh.GetHeader();
+	if(header->IndexCount == 0)
+	{
+		printf("Mesh %s has no triangles\n", objpath);
+		return false;
+	}
+	std::vector<unsigned short> indices;
+	buildMeshLODs(mesh.GetIndices(), header->IndexCount, mesh.GetVertices()->Position, header->VertexCount, header->VertexStride,
+		MAX_MESH_LODS, out_lods, indices);
+	printMeshLODs(objpath, out_lods);
+
+	out.IndexCount = indices.size();
+	out.VertexCount = header->VertexCount;
+	out.Stride = header->VertexStride;
+	memcpy(out.BoundsMin, header->BoundsMin, sizeof(out.BoundsMin));
+	memcpy(out.BoundsMax, header->BoundsMax, sizeof(out.BoundsMax));
+	uploadMesh(mesh.GetVertices(), mesh.GetVertexDataSize(), &indices[0], indices.size() * sizeof(unsigned short), out);
+	return true;
+}
+
+bool loadMeshChunkBuffers(const char* objpath, std::vector<MeshBuffers>& out)
+{
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(objpath, indices, vertices, uvs, normals) || indices.empty())
+	{
+		printf("Could not load mesh %s\n", objpath);
+		return false;
+	}
+
+	std::vector<MeshChunk> chunks;
+	partitionMesh(&indices[0], indices.size(), vertices, MAX_CHUNK_VERTICES, chunks);
+	printPartitionReport(chunks, vertices.size());
+
+	VertexLayout layout;
+	describeMeshVertex(layout, NULL, NULL, NULL);
+	std::vector<glm::vec3> chunk_vertices, chunk_normals;
+	std::vector<glm::vec2> chunk_uvs;
+	std::vector<unsigned char> interleaved;
+	for(size_t i = 0; i < chunks.size(); i++)
+	{
+		const MeshChunk& chunk = chunks[i];
+		gatherChunkVertices(chunk, vertices, chunk_vertices);
+		gatherChunkVertices(chunk, uvs, chunk_uvs);
+		gatherChunkVertices(chunk, normals, chunk_normals);
+		buildInterleaved(layout, chunk_vertices, chunk_uvs, chunk_normals, interleaved);
+
+		MeshBuffers buffers;
+		memset(&buffers, 0, sizeof(buffers));
+		buffers.IndexCount = chunk.Indices.size();
+		buffers.VertexCount = chunk.Vertices.size();
+		buffers.Stride = layout.GetStride();
+		memcpy(buffers.BoundsMin, &chunk.BoundsMin.x, sizeof(buffers.BoundsMin));
+		memcpy(buffers.BoundsMax, &chunk.BoundsMax.x, sizeof(buffers.BoundsMax));
+		uploadMesh(&interleaved[0], interleaved.size(), &chunk.Indices[0], chunk.Indices.size() * sizeof(unsigned short), buffers);
+		out.push_back(buffers);
+	}
+	return true;
+}
+
+int drawMeshChunks(const std::vector<MeshBuffers>& chunks, VertexLayout& layout, const glm::mat4& mvp)
+{
+	int drawn = 0;
+	for(size_t i = 0; i < chunks.size(); i++)
+	{
+		const MeshBuffers& chunk = chunks[i];
+		glm::vec3 bmin(chunk.BoundsMin[0], chunk.BoundsMin[1], chunk.BoundsMin[2]);
+		glm::vec3 bmax(chunk.BoundsMax[0], chunk.BoundsMax[1], chunk.BoundsMax[2]);
+		if(!isBoxVisible(mvp, bmin, bmax))
+			continue;
+		layout.Enable(chunk.VertexBuffer);
+		GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ElementBuffer);
+		glDrawElements(GL_TRIANGLES, chunk.IndexCount, GL_UNSIGNED_SHORT, 0);
+		drawn++;
+	}
+	return drawn;
+}
+
+void deleteMeshChunkBuffers(std::vector<MeshBuffers>& chunks)
+{
+	for(size_t i = 0; i < chunks.size(); i++)
+		deleteMeshBuffers(chunks[i]);
+	chunks.clear();
+}
+
+void deleteMeshBuffers(MeshBuffers& buffers)
+{
+	deleteBuffer(buffers.VertexBuffer);
+	deleteBuffer(buffers.ElementBuffer);
+	memset(&buffers, 0, sizeof(buffers));
+}
+
+void describeMeshVertex(VertexLayout& layout, const char* position, const char* uv, const char* normal)
+{
+	layout.Add(VERTEX_POSITION, position, 3, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, Position));
+	layout.Add(VERTEX_UV, uv, 2, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, UV));
+	layout.Add(VERTEX_NORMAL, normal, 3, GL_FLOAT, GL_FALSE, offsetof(MeshVertex, Normal));
+	assert(layout.GetStride() == sizeof(MeshVertex));
+}
+
+bool loadQuantizedMeshBuffers(const char* objpath, MeshBuffers& out, MeshQuantization& out_quantization)
+{
+	memset(&out, 0, sizeof(out));
+
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(objpath, indices, vertices, uvs, normals) || indices.empty())
+	{
+		printf("Could not load mesh %s\n", objpath);
+		return false;
+	}
+
+	std::vector<QuantizedVertex> quantized;
+	quantizeMesh(vertices, uvs, normals, quantized, out_quantization);
+	printQuantizationReport(vertices, uvs, normals, quantized, out_quantization);
+
+	glm::vec3 bmin = out_quantization.PositionOffset - out_quantization.PositionScale;
+	glm::vec3 bmax = out_quantization.PositionOffset + out_quantization.PositionScale;
+	memcpy(out.BoundsMin, &bmin.x, sizeof(out.BoundsMin));
+	memcpy(out.BoundsMax, &bmax.x, sizeof(out.BoundsMax));
+	out.IndexCount = indices.size();
+	out.VertexCount = quantized.size();
+	out.Stride = sizeof(QuantizedVertex);
+	uploadMesh(&quantized[0], quantized.size() * sizeof(QuantizedVertex), &indices[0], indices.size() * sizeof(unsigned short), out);
+	return true;
+}
+
+void describeQuantizedVertex(VertexLayout& layout, const char* position, const char* uv, const char* normal)
+{
+	layout.Add(VERTEX_POSITION, position, 3, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, Position));
+	layout.Add(VERTEX_NORMAL, normal, 2, GL_BYTE, GL_TRUE, offsetof(QuantizedVertex, Normal));
+	layout.Add(VERTEX_UV, uv, 2, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, UV));
+	assert(layout.GetStride() == sizeof(QuantizedVertex));
+}
+
+void setQuantizationUniforms(ProgramReflection& uniforms, const MeshQuantization& quantization)
+{
+	const glm::vec3& scale = quantization.PositionScale;
+	const glm::vec3& offset = quantization.PositionOffset;
+	uniforms.SetVec3(uniforms.FindUniform("PositionScale"), scale.x, scale.y, scale.z);
+	uniforms.SetVec3(uniforms.FindUniform("PositionOffset"), offset.x, offset.y, offset.z);
+	uniforms.SetVec2(uniforms.FindUniform("UVScale"), quantization.UVScale.x, quantization.UVScale.y);
+	uniforms.SetVec2(uniforms.FindUniform("UVOffset"), quantization.UVOffset.x, quantization.UVOffset.y);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "GLES2/gl2.h"
+#include "vertexlayout.h"
+#include "meshquantize.h"
+#include "meshsimplify.h"
+
+class ProgramReflection;
+
+// GL side of a model loaded through its .mesh cache.
+// VertexBuffer holds interleaved MeshVertex data (see meshfile.h),
+// ElementBuffer holds IndexCount GL_UNSIGNED_SHORT indices.
+struct MeshBuffers
+{
+	GLuint VertexBuffer;
+	GLuint ElementBuffer;
+	GLsizei IndexCount;
+	GLsizei VertexCount;
+	GLsizei Stride;
+	float BoundsMin[3];
+	float BoundsMax[3];
+};
+
+// Loads an .obj into two new buffer objects. An up to date cache is mapped and
+// its pages go straight to glBufferData, otherwise the .obj is parsed and cached first.
+bool loadMeshBuffers(const char* objpath, MeshBuffers& out);
+void deleteMeshBuffers(MeshBuffers& buffers);
+
+// Same as loadMeshBuffers plus a chain of simplified levels. All levels share the vertex buffer,
+// their indices follow each other in the element buffer (IndexCount covers them all), draw one with
+//   glDrawElements(GL_TRIANGLES, lod.IndexCount, GL_UNSIGNED_SHORT, (void*)(lod.IndexOffset * sizeof(unsigned short)))
+bool loadMeshLODBuffers(const char* objpath, MeshBuffers& out, MeshLODChain& out_lods);
+
+// For models past 65535 vertices: split into chunks (see meshpartition.h), each with its own
+// buffers and bounds, appended to out. Nothing is cached, big models parse every time.
+bool loadMeshChunkBuffers(const char* objpath, std::vector<MeshBuffers>& out);
+// Draws the chunks whose bounds touch the view volume of mvp with a describeMeshVertex layout,
+// returns how many were drawn
+int drawMeshChunks(const std::vector<MeshBuffers>& chunks, VertexLayout& layout, const glm::mat4& mvp);
+void deleteMeshChunkBuffers(std::vector<MeshBuffers>& chunks);
+
+// Layout of a MeshBuffers vertex, pass the shader's attribute names (or NULL for unused ones)
+void describeMeshVertex(VertexLayout& layout, const char* position, const char* uv, const char* normal);
+
+// Same as loadMeshBuffers but the vertices are stored as QuantizedVertex (16 bytes instead of 32),
+// draw with a layout from describeQuantizedVertex and the uniforms from setQuantizationUniforms
+bool loadQuantizedMeshBuffers(const char* objpath, MeshBuffers& out, MeshQuantization& out_quantization);
+void describeQuantizedVertex(VertexLayout& layout, const char* position, const char* uv, const char* normal);
+// Sets PositionScale, PositionOffset, UVScale and UVOffset on the current program through
+// its reflection, so they cost nothing once set
+void setQuantizationUniforms(ProgramReflection& uniforms, const MeshQuantization& quantization);
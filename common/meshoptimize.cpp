@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#include "meshoptimize.h"
+
+// Tuning from the paper, the cache modelled here is an LRU a bit bigger than the real one
+#define FORSYTH_CACHE_SIZE     32
+#define FORSYTH_DECAY_POWER    1.5f
+#define FORSYTH_LAST_TRI_SCORE 0.75f
+#define FORSYTH_VALENCE_SCALE  2.0f
+#define FORSYTH_VALENCE_POWER  0.5f
+
+static float GCacheScore[FORSYTH_CACHE_SIZE];
+static float GValenceScore[64];
+static bool GScoreTablesReady = false;
+
+static void initScoreTables()
+{
+	if(GScoreTablesReady)
+		return;
+	for(int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+	{
+		// the three vertices of the last triangle score the same, the rest fall off with age
+		if(i < 3)
+			GCacheScore[i] = FORSYTH_LAST_TRI_SCORE;
+		else
+			GCacheScore[i] = powf(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_DECAY_POWER);
+	}
+	// vertices with few triangles left get a boost so they are finished off and leave
+	GValenceScore[0] = 0.0f;
+	for(int i = 1; i < 64; i++)
+		GValenceScore[i] = FORSYTH_VALENCE_SCALE * powf((float)i, -FORSYTH_VALENCE_POWER);
+	GScoreTablesReady = true;
+}
+
+static inline float vertexScore(int cache_position, unsigned int remaining)
+{
+	if(remaining == 0)
+		return -1.0f;
+	float score = cache_position >= 0 ? GCacheScore[cache_position] : 0.0f;
+	return score + GValenceScore[remaining < 64 ? remaining : 63];
+}
+
+template<typename Index>
+static void forsyth(Index* indices, size_t index_count, size_t vertex_count)
+{
+	initScoreTables();
+	size_t tri_count = index_count / 3;
+	if(tri_count == 0)
+		return;
+
+	// triangles using each vertex, as offsets into one array
+	std::vector<unsigned int> offsets(vertex_count + 1, 0);
+	for(size_t i = 0; i < tri_count * 3; i++)
+		offsets[indices[i] + 1]++;
+	for(size_t v = 0; v < vertex_count; v++)
+		offsets[v + 1] += offsets[v];
+	std::vector<unsigned int> adjacency(tri_count * 3);
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for(size_t i = 0; i < tri_count * 3; i++)
+		adjacency[fill[indices[i]]++] = i / 3;
+
+	// remaining[v] counts the unemitted triangles of v, they sit at the front of its adjacency list
+	std::vector<unsigned int> remaining(vertex_count);
+	std::vector<int> cache_pos(vertex_count, -1);
+	std::vector<float> vscore(vertex_count);
+	for(size_t v = 0; v < vertex_count; v++)
+	{
+		remaining[v] = offsets[v + 1] - offsets[v];
+		vscore[v] = vertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> tscore(tri_count);
+	std::vector<bool> emitted(tri_count, false);
+	for(size_t t = 0; t < tri_count; t++)
+		tscore[t] = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+
+	std::vector<Index> output(tri_count * 3);
+	unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+	int cache_count = 0;
+
+	// best triangle to start from, afterwards only triangles touching the cache are considered
+	size_t best = 0;
+	for(size_t t = 1; t < tri_count; t++)
+		if(tscore[t] > tscore[best]) best = t;
+	size_t scan = 0;
+
+	for(size_t out = 0; out < tri_count; out++)
+	{
+		emitted[best] = true;
+		const Index* tri = &indices[best * 3];
+		memcpy(&output[out * 3], tri, 3 * sizeof(Index));
+
+		// take the triangle off its vertices' remaining lists
+		for(int k = 0; k < 3; k++)
+		{
+			unsigned int v = tri[k];
+			unsigned int* list = &adjacency[offsets[v]];
+			for(unsigned int j = 0; j < remaining[v]; j++)
+			{
+				if(list[j] == best)
+				{
+					list[j] = list[remaining[v] - 1];
+					list[remaining[v] - 1] = best;
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// move the triangle's vertices to the front of the LRU cache
+		unsigned int new_cache[FORSYTH_CACHE_SIZE + 3];
+		int new_count = 0;
+		for(int k = 0; k < 3; k++)
+			new_cache[new_count++] = tri[k];
+		for(int c = 0; c < cache_count; c++)
+		{
+			unsigned int v = cache[c];
+			if(v != tri[0] && v != tri[1] && v != tri[2])
+				new_cache[new_count++] = v;
+		}
+
+		// rescore everything that was or is in the cache, and their triangles
+		for(int c = 0; c < new_count; c++)
+		{
+			unsigned int v = new_cache[c];
+			cache_pos[v] = c < FORSYTH_CACHE_SIZE ? c : -1;
+			float delta = vertexScore(cache_pos[v], remaining[v]) - vscore[v];
+			vscore[v] += delta;
+			for(unsigned int j = 0; j < remaining[v]; j++)
+				tscore[adjacency[offsets[v] + j]] += delta;
+		}
+		cache_count = new_count < FORSYTH_CACHE_SIZE ? new_count : FORSYTH_CACHE_SIZE;
+		memcpy(cache, new_cache, cache_count * sizeof(unsigned int));
+
+		// next: the best triangle using a cached vertex
+		float best_score = -1.0f;
+		best = tri_count;
+		for(int c = 0; c < cache_count; c++)
+		{
+			unsigned int v = cache[c];
+			for(unsigned int j = 0; j < remaining[v]; j++)
+			{
+				unsigned int t = adjacency[offsets[v] + j];
+				if(tscore[t] > best_score)
+				{
+					best_score = tscore[t];
+					best = t;
+				}
+			}
+		}
+
+		// nothing connected is left, carry on with the first unemitted triangle
+		if(best == tri_count)
+		{
+			while(scan < tri_count && emitted[scan])
+				scan++;
+			best = scan;
+		}
+	}
+
+	memcpy(indices, &output[0], tri_count * 3 * sizeof(Index));
+}
+
+template<typename Index>
+static void fetchOrder(Index* indices, size_t index_count, size_t vertex_count, std::vector<unsigned int>& out_remap)
+{
+	out_remap.assign(vertex_count, ~0u);
+	unsigned int next = 0;
+	for(size_t i = 0; i < index_count; i++)
+	{
+		unsigned int& r = out_remap[indices[i]];
+		if(r == ~0u)
+			r = next++;
+		indices[i] = (Index)r;
+	}
+	for(size_t v = 0; v < vertex_count; v++)
+		if(out_remap[v] == ~0u)
+			out_remap[v] = next++;
+}
+
+template<typename Index>
+static VertexCacheStats fifoStats(const Index* indices, size_t index_count, size_t vertex_count, unsigned int cache_size)
+{
+	// time stamp of when each vertex entered the FIFO, it is cached while newer than cache_size entries
+	std::vector<unsigned int> entered(vertex_count, 0);
+	unsigned int clock = cache_size + 1;
+	unsigned int transformed = 0;
+	for(size_t i = 0; i < index_count; i++)
+	{
+		unsigned int& e = entered[indices[i]];
+		if(clock - e > cache_size)
+		{
+			e = clock++;
+			transformed++;
+		}
+	}
+
+	VertexCacheStats stats;
+	stats.Triangles = index_count / 3;
+	stats.Vertices = vertex_count;
+	stats.Transformed = transformed;
+	stats.CacheSize = cache_size;
+	stats.ACMR = stats.Triangles ? (float)transformed / stats.Triangles : 0.0f;
+	stats.ATVR = vertex_count ? (float)transformed / vertex_count : 0.0f;
+	return stats;
+}
+
+void optimizeVertexCache(unsigned short* indices, size_t index_count, size_t vertex_count) { forsyth(indices, index_count, vertex_count); }
+void optimizeVertexCache(unsigned int* indices, size_t index_count, size_t vertex_count) { forsyth(indices, index_count, vertex_count); }
+
+void optimizeVertexFetch(unsigned short* indices, size_t index_count, size_t vertex_count, std::vector<unsigned int>& out_remap) { fetchOrder(indices, index_count, vertex_count, out_remap); }
+void optimizeVertexFetch(unsigned int* indices, size_t index_count, size_t vertex_count, std::vector<unsigned int>& out_remap) { fetchOrder(indices, index_count, vertex_count, out_remap); }
+
+VertexCacheStats analyzeVertexCache(const unsigned short* indices, size_t index_count, size_t vertex_count, unsigned int cache_size) { return fifoStats(indices, index_count, vertex_count, cache_size); }
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size) { return fifoStats(indices, index_count, vertex_count, cache_size); }
+
+void printVertexCacheStats(const char* label, const VertexCacheStats& stats)
+{
+	printf("%s: %u triangles, %u vertices, %u transformed (FIFO %u)  ACMR %.3f  ATVR %.3f\n",
+		label, stats.Triangles, stats.Vertices, stats.Transformed, stats.CacheSize, stats.ACMR, stats.ATVR);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Index buffer reordering for the post-transform vertex cache.
+// The passes work on 16 or 32 bit indices.
+
+// Reorders the triangles so vertices are reused while still in the post-transform
+// cache (Tom Forsyth's "Linear-Speed Vertex Cache Optimisation")
+void optimizeVertexCache(unsigned short* indices, size_t index_count, size_t vertex_count);
+void optimizeVertexCache(unsigned int* indices, size_t index_count, size_t vertex_count);
+
+// Renumbers the vertices in the order the indices first use them so fetches walk the
+// vertex buffer forwards. Rewrites the indices, out_remap[old vertex] = new vertex,
+// apply it to every attribute array with remapVertices. Unused vertices go last.
+void optimizeVertexFetch(unsigned short* indices, size_t index_count, size_t vertex_count, std::vector<unsigned int>& out_remap);
+void optimizeVertexFetch(unsigned int* indices, size_t index_count, size_t vertex_count, std::vector<unsigned int>& out_remap);
+
+template<typename T>
+void remapVertices(std::vector<T>& data, const std::vector<unsigned int>& remap)
+{
+	std::vector<T> old(data);
+	for(size_t i = 0; i < remap.size(); i++)
+		data[remap[i]] = old[i];
+}
+
+struct VertexCacheStats
+{
+	unsigned int Triangles;
+	unsigned int Vertices;
+	unsigned int Transformed;  // vertex shader runs with a FIFO cache of CacheSize entries
+	unsigned int CacheSize;
+	float ACMR;                // average cache miss ratio, transformed / triangles (0.5 .. 3)
+	float ATVR;                // average transform to vertex ratio, transformed / vertices (1 is ideal)
+};
+
+VertexCacheStats analyzeVertexCache(const unsigned short* indices, size_t index_count, size_t vertex_count, unsigned int cache_size = 16);
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size = 16);
+void printVertexCacheStats(const char* label, const VertexCacheStats& stats);
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <algorithm>
+
+#include "meshpartition.h"
+#include "meshoptimize.h"
+
+// Spreads the low 10 bits of v out to every third bit
+static unsigned int part1By2(unsigned int v)
+{
+	v &= 0x3FF;
+	v = (v | (v << 16)) & 0x030000FF;
+	v = (v | (v << 8)) & 0x0300F00F;
+	v = (v | (v << 4)) & 0x030C30C3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+static unsigned int mortonCode(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3& inv_extent)
+{
+	glm::vec3 n = (p - bmin) * inv_extent * 1023.0f;
+	unsigned int x = (unsigned int)std::max(0.0f, std::min(n.x, 1023.0f));
+	unsigned int y = (unsigned int)std::max(0.0f, std::min(n.y, 1023.0f));
+	unsigned int z = (unsigned int)std::max(0.0f, std::min(n.z, 1023.0f));
+	return part1By2(x) | (part1By2(y) << 1) | (part1By2(z) << 2);
+}
+
+static void finishChunk(MeshChunk& chunk, const std::vector<glm::vec3>& positions)
+{
+	optimizeVertexCache(&chunk.Indices[0], chunk.Indices.size(), chunk.Vertices.size());
+
+	// renumber in first use order so the chunk's vertex buffer is read front to back
+	std::vector<unsigned int> remap;
+	optimizeVertexFetch(&chunk.Indices[0], chunk.Indices.size(), chunk.Vertices.size(), remap);
+	remapVertices(chunk.Vertices, remap);
+
+	chunk.BoundsMin = chunk.BoundsMax = positions[ chunk.Vertices[0] ];
+	for(size_t i = 1; i < chunk.Vertices.size(); i++)
+	{
+		chunk.BoundsMin = glm::min(chunk.BoundsMin, positions[ chunk.Vertices[i] ]);
+		chunk.BoundsMax = glm::max(chunk.BoundsMax, positions[ chunk.Vertices[i] ]);
+	}
+}
+
+void partitionMesh(
+	const unsigned int* indices, size_t index_count,
+	const std::vector<glm::vec3> & positions,
+	unsigned int max_vertices,
+	std::vector<MeshChunk> & out_chunks)
+{
+	size_t tri_count = index_count / 3;
+	if(tri_count == 0 || positions.empty())
+		return;
+	if(max_vertices > MAX_CHUNK_VERTICES)
+		max_vertices = MAX_CHUNK_VERTICES;
+	if(max_vertices < 3)
+		max_vertices = 3;
+
+	glm::vec3 bmin = positions[0], bmax = positions[0];
+	for(size_t v = 1; v < positions.size(); v++)
+	{
+		bmin = glm::min(bmin, positions[v]);
+		bmax = glm::max(bmax, positions[v]);
+	}
+	glm::vec3 extent = bmax - bmin;
+	glm::vec3 inv_extent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+	                     extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+	                     extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+	// (morton code << 32 | triangle), sorting it gives the walk order
+	std::vector<unsigned long long> order(tri_count);
+	for(size_t t = 0; t < tri_count; t++)
+	{
+		glm::vec3 centre = (positions[ indices[t * 3] ] + positions[ indices[t * 3 + 1] ] + positions[ indices[t * 3 + 2] ]) * (1.0f / 3.0f);
+		order[t] = ((unsigned long long)mortonCode(centre, bmin, inv_extent) << 32) | t;
+	}
+	std::sort(order.begin(), order.end());
+
+	// local[v] is v's index in the current chunk, valid while owner[v] is the chunk's number
+	std::vector<unsigned int> owner(positions.size(), ~0u);
+	std::vector<unsigned short> local(positions.size());
+	unsigned int chunk_id = out_chunks.size();
+	out_chunks.push_back(MeshChunk());
+
+	for(size_t i = 0; i < tri_count; i++)
+	{
+		const unsigned int* tri = &indices[ (order[i] & 0xFFFFFFFFu) * 3 ];
+		MeshChunk* chunk = &out_chunks.back();
+
+		unsigned int fresh = 0;
+		for(int k = 0; k < 3; k++)
+			if(owner[ tri[k] ] != chunk_id && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]))
+				fresh++;
+		if(chunk->Vertices.size() + fresh > max_vertices)
+		{
+			finishChunk(*chunk, positions);
+			chunk_id++;
+			out_chunks.push_back(MeshChunk());
+			chunk = &out_chunks.back();
+		}
+
+		for(int k = 0; k < 3; k++)
+		{
+			unsigned int v = tri[k];
+			if(owner[v] != chunk_id)
+			{
+				owner[v] = chunk_id;
+				local[v] = (unsigned short)chunk->Vertices.size();
+				chunk->Vertices.push_back(v);
+			}
+			chunk->Indices.push_back(local[v]);
+		}
+	}
+	finishChunk(out_chunks.back(), positions);
+}
+
+bool isBoxVisible(const glm::mat4& mvp, const glm::vec3& bmin, const glm::vec3& bmax)
+{
+	// outside when all eight corners are beyond the same clip plane
+	unsigned int outside_all = 0x3F;
+	for(int c = 0; c < 8; c++)
+	{
+		glm::vec4 p = mvp * glm::vec4(c & 1 ? bmax.x : bmin.x, c & 2 ? bmax.y : bmin.y, c & 4 ? bmax.z : bmin.z, 1.0f);
+		unsigned int outside = 0;
+		if(p.x < -p.w) outside |= 1;
+		if(p.x >  p.w) outside |= 2;
+		if(p.y < -p.w) outside |= 4;
+		if(p.y >  p.w) outside |= 8;
+		if(p.z < -p.w) outside |= 16;
+		if(p.z >  p.w) outside |= 32;
+		outside_all &= outside;
+		if(!outside_all)
+			return true;
+	}
+	return false;
+}
+
+void printPartitionReport(const std::vector<MeshChunk>& chunks, size_t vertex_count)
+{
+	size_t vertices = 0, triangles = 0, largest = 0;
+	for(size_t i = 0; i < chunks.size(); i++)
+	{
+		vertices += chunks[i].Vertices.size();
+		triangles += chunks[i].Indices.size() / 3;
+		largest = std::max(largest, chunks[i].Vertices.size());
+	}
+	printf("%u chunks, %u triangles, %u vertices (%u in the mesh, %.2f%% duplicated on cuts), largest chunk %u vertices\n",
+		(unsigned)chunks.size(), (unsigned)triangles, (unsigned)vertices, (unsigned)vertex_count,
+		vertex_count ? 100.0 * (vertices - vertex_count) / vertex_count : 0.0, (unsigned)largest);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Splits an indexed mesh of any size into chunks GLES2 can draw with 16 bit indices.
+// Triangles are taken in Morton order of their centres, so a chunk covers a compact
+// region of space and its bounds make a useful culling volume.
+
+// 0xFFFF is kept free, some drivers treat it as a primitive restart index
+#define MAX_CHUNK_VERTICES 0xFFFF
+
+struct MeshChunk
+{
+	std::vector<unsigned short> Indices;  // into Vertices, reordered for the vertex cache
+	std::vector<unsigned int> Vertices;   // chunk vertex -> vertex of the whole mesh
+	glm::vec3 BoundsMin;
+	glm::vec3 BoundsMax;
+};
+
+// max_vertices per chunk, at most MAX_CHUNK_VERTICES. Vertices on the cut between two
+// chunks are duplicated into both.
+void partitionMesh(
+	const unsigned int* indices, size_t index_count,
+	const std::vector<glm::vec3> & positions,
+	unsigned int max_vertices,
+	std::vector<MeshChunk> & out_chunks);
+
+// Gathers one attribute array for a chunk, in chunk vertex order
+template<typename T>
+void gatherChunkVertices(const MeshChunk& chunk, const std::vector<T>& data, std::vector<T>& out)
+{
+	out.resize(chunk.Vertices.size());
+	for(size_t i = 0; i < chunk.Vertices.size(); i++)
+		out[i] = data[ chunk.Vertices[i] ];
+}
+
+// False when the box is certainly outside the view volume of mvp (conservative)
+bool isBoxVisible(const glm::mat4& mvp, const glm::vec3& bmin, const glm::vec3& bmax);
+
+void printPartitionReport(const std::vector<MeshChunk>& chunks, size_t vertex_count);
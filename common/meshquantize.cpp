@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <math.h>
+
+#include "meshquantize.h"
+
+// GLES2 maps a normalized signed b bit integer c to (2c+1)/(2^b-1), so 0 is not exactly
+// representable but both ends are. Unsigned ones are simply c/(2^b-1).
+static inline float snormToFloat(int c, int bits)
+{
+	return (2.0f * c + 1.0f) / (float)((1 << bits) - 1);
+}
+
+static inline int floatToSnorm(float f, int bits)
+{
+	int max = (1 << (bits - 1)) - 1;
+	int c = (int)floorf((f * ((1 << bits) - 1) - 1.0f) * 0.5f + 0.5f);
+	return c < -max - 1 ? -max - 1 : (c > max ? max : c);
+}
+
+static inline float signNotZero(float f)
+{
+	return f >= 0.0f ? 1.0f : -1.0f;
+}
+
+static glm::vec3 octDecode(float x, float y)
+{
+	glm::vec3 n(x, y, 1.0f - fabsf(x) - fabsf(y));
+	if(n.z < 0.0f)
+	{
+		n.x = (1.0f - fabsf(y)) * signNotZero(x);
+		n.y = (1.0f - fabsf(x)) * signNotZero(y);
+	}
+	return glm::normalize(n);
+}
+
+// Projects onto the octahedron, unfolds the lower half, then tries the four byte
+// pairs around the exact position and keeps the one that decodes closest to the input
+static void octEncode(glm::vec3 n, signed char out[2])
+{
+	float len = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	if(len == 0.0f)
+	{
+		out[0] = out[1] = 0;
+		return;
+	}
+	float x = n.x / len, y = n.y / len;
+	if(n.z < 0.0f)
+	{
+		float ox = x;
+		x = (1.0f - fabsf(y)) * signNotZero(ox);
+		y = (1.0f - fabsf(ox)) * signNotZero(y);
+	}
+
+	glm::vec3 unit = glm::normalize(n);
+	// snormToFloat solved for c, not yet rounded: the pair lies between floor and floor + 1
+	int cx = (int)floorf((x * 255.0f - 1.0f) * 0.5f), cy = (int)floorf((y * 255.0f - 1.0f) * 0.5f);
+	float best = -2.0f;
+	for(int dy = 0; dy <= 1; dy++)
+	{
+		for(int dx = 0; dx <= 1; dx++)
+		{
+			int qx = cx + dx < -128 ? -128 : (cx + dx > 127 ? 127 : cx + dx);
+			int qy = cy + dy < -128 ? -128 : (cy + dy > 127 ? 127 : cy + dy);
+			float d = glm::dot(unit, octDecode(snormToFloat(qx, 8), snormToFloat(qy, 8)));
+			if(d > best)
+			{
+				best = d;
+				out[0] = (signed char)qx;
+				out[1] = (signed char)qy;
+			}
+		}
+	}
+}
+
+void quantizeMesh(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<QuantizedVertex> & out_vertices,
+	MeshQuantization & out_quantization
+){
+	size_t count = vertices.size();
+	glm::vec3 pmin(0.0f), pmax(0.0f);
+	glm::vec2 tmin(0.0f), tmax(0.0f);
+	for(size_t i = 0; i < count; i++)
+	{
+		pmin = i ? glm::min(pmin, vertices[i]) : vertices[i];
+		pmax = i ? glm::max(pmax, vertices[i]) : vertices[i];
+		tmin = i ? glm::min(tmin, uvs[i]) : uvs[i];
+		tmax = i ? glm::max(tmax, uvs[i]) : uvs[i];
+	}
+
+	// positions go to [-1,1] around the centre of the bounds, uvs to [0,1]
+	MeshQuantization & q = out_quantization;
+	q.PositionOffset = (pmin + pmax) * 0.5f;
+	q.PositionScale = (pmax - pmin) * 0.5f;
+	q.UVOffset = tmin;
+	q.UVScale = tmax - tmin;
+	for(int c = 0; c < 3; c++)
+		if(q.PositionScale[c] == 0.0f) q.PositionScale[c] = 1.0f;
+	for(int c = 0; c < 2; c++)
+		if(q.UVScale[c] == 0.0f) q.UVScale[c] = 1.0f;
+
+	out_vertices.resize(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		QuantizedVertex & v = out_vertices[i];
+		for(int c = 0; c < 3; c++)
+			v.Position[c] = (short)floatToSnorm((vertices[i][c] - q.PositionOffset[c]) / q.PositionScale[c], 16);
+		v.Position[3] = 0;
+		octEncode(normals[i], v.Normal);
+		v.Pad[0] = v.Pad[1] = 0;
+		for(int c = 0; c < 2; c++)
+		{
+			float f = (uvs[i][c] - q.UVOffset[c]) / q.UVScale[c];
+			v.UV[c] = (unsigned short)floorf((f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f)) * 65535.0f + 0.5f);
+		}
+	}
+}
+
+void dequantizeVertex(const QuantizedVertex & v, const MeshQuantization & q, glm::vec3 & position, glm::vec2 & uv, glm::vec3 & normal)
+{
+	for(int c = 0; c < 3; c++)
+		position[c] = snormToFloat(v.Position[c], 16) * q.PositionScale[c] + q.PositionOffset[c];
+	for(int c = 0; c < 2; c++)
+		uv[c] = v.UV[c] / 65535.0f * q.UVScale[c] + q.UVOffset[c];
+	normal = octDecode(snormToFloat(v.Normal[0], 8), snormToFloat(v.Normal[1], 8));
+}
+
+void printQuantizationReport(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	const std::vector<QuantizedVertex> & quantized,
+	const MeshQuantization & quantization
+){
+	size_t count = vertices.size();
+	double pos_max = 0, pos_sum = 0, uv_max = 0, uv_sum = 0, angle_max = 0, angle_sum = 0;
+	for(size_t i = 0; i < count; i++)
+	{
+		glm::vec3 p, n;
+		glm::vec2 t;
+		dequantizeVertex(quantized[i], quantization, p, t, n);
+
+		double pe = glm::length(p - vertices[i]);
+		glm::vec2 dt = t - uvs[i];
+		double te = sqrt(dt.x * dt.x + dt.y * dt.y);
+		float cosine = glm::dot(glm::normalize(normals[i]), n);
+		double ae = acos(cosine > 1.0f ? 1.0f : (cosine < -1.0f ? -1.0f : cosine)) * 180.0 / M_PI;
+
+		pos_sum += pe; if(pe > pos_max) pos_max = pe;
+		uv_sum += te; if(te > uv_max) uv_max = te;
+		angle_sum += ae; if(ae > angle_max) angle_max = ae;
+	}
+
+	glm::vec3 extent = quantization.PositionScale * 2.0f;
+	float diagonal = glm::length(extent);
+	size_t before = count * (sizeof(glm::vec3) * 2 + sizeof(glm::vec2));
+	size_t after = count * sizeof(QuantizedVertex);
+	double n = count ? (double)count : 1.0;
+
+	printf("Quantized %u vertices\n", (unsigned)count);
+	printf("  position error  max %g  mean %g  (%.5f%% of the bounds diagonal)\n", pos_max, pos_sum / n, diagonal > 0 ? 100.0 * pos_max / diagonal : 0.0);
+	printf("  uv error        max %g  mean %g  (%.3f texels at 1024)\n", uv_max, uv_sum / n, uv_max * 1024.0);
+	printf("  normal error    max %.3f  mean %.3f degrees\n", angle_max, angle_sum / n);
+	printf("  vertex data     %u -> %u bytes (%u -> %u per vertex, %.0f%% saved)\n",
+		(unsigned)before, (unsigned)after,
+		(unsigned)(sizeof(glm::vec3) * 2 + sizeof(glm::vec2)), (unsigned)sizeof(QuantizedVertex),
+		before ? 100.0 * (before - after) / before : 0.0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Optional compression of loader output from 32 to 16 bytes per vertex:
+//  - positions as normalized GL_SHORT, rescaled in the shader with PositionScale/PositionOffset
+//  - normals octahedral encoded into two normalized GL_BYTEs
+//  - uvs as normalized GL_UNSIGNED_SHORT, rescaled with UVScale/UVOffset
+// The matching vertex shader decode is in tutorial08_basic_shading/QuantizedTransformVertexShader.glsl
+
+struct QuantizedVertex
+{
+	short Position[4];          // w is padding
+	signed char Normal[2];
+	unsigned char Pad[2];
+	unsigned short UV[2];
+};
+
+// decoded = attribute * Scale + Offset, per mesh
+struct MeshQuantization
+{
+	glm::vec3 PositionScale;
+	glm::vec3 PositionOffset;
+	glm::vec2 UVScale;
+	glm::vec2 UVOffset;
+};
+
+void quantizeMesh(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<QuantizedVertex> & out_vertices,
+	MeshQuantization & out_quantization
+);
+
+// What the GPU will see for one quantized vertex, exactly as GLES2 converts normalized integers
+void dequantizeVertex(const QuantizedVertex & v, const MeshQuantization & q, glm::vec3 & position, glm::vec2 & uv, glm::vec3 & normal);
+
+// Round trip error and memory saved, printed to stdout
+void printQuantizationReport(
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	const std::vector<QuantizedVertex> & quantized,
+	const MeshQuantization & quantization
+);
@@ -0,0 +1,463 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+#include "meshsimplify.h"
+#include "meshoptimize.h"
+
+// Open borders get a plane through the edge, perpendicular to the face, weighted this
+// much above a face of the same size so silhouettes of open meshes stay put
+#define BORDER_WEIGHT 10.0
+
+// Collapses that turn a triangle further than this (cosine) are rejected as flips
+#define MAX_FLIP_COSINE 0.2f
+
+// Planes are weighted by area and w sums the weights, so evaluate() gives the mean squared
+// distance and the error does not depend on how finely the mesh was tessellated
+struct Quadric
+{
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+};
+
+static void addPlane(Quadric& q, const glm::vec3& n, float d, double w)
+{
+	q.a2 += w * n.x * n.x; q.ab += w * n.x * n.y; q.ac += w * n.x * n.z; q.ad += w * n.x * d;
+	q.b2 += w * n.y * n.y; q.bc += w * n.y * n.z; q.bd += w * n.y * d;
+	q.c2 += w * n.z * n.z; q.cd += w * n.z * d;
+	q.d2 += w * d * d;
+	q.w += w;
+}
+
+static void addQuadric(Quadric& q, const Quadric& o)
+{
+	q.a2 += o.a2; q.ab += o.ab; q.ac += o.ac; q.ad += o.ad;
+	q.b2 += o.b2; q.bc += o.bc; q.bd += o.bd;
+	q.c2 += o.c2; q.cd += o.cd;
+	q.d2 += o.d2;
+	q.w += o.w;
+}
+
+// weighted mean squared distance of p to the planes in q
+static double evaluate(const Quadric& q, const glm::vec3& p)
+{
+	if(q.w <= 0.0)
+		return 0.0;
+	double x = p.x, y = p.y, z = p.z;
+	double r = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2
+		+ 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z + q.ad * x + q.bd * y + q.cd * z);
+	return r > 0.0 ? r / q.w : 0.0;
+}
+
+struct Collapse
+{
+	float Cost;
+	unsigned int From, To;
+	unsigned int FromStamp, ToStamp;
+
+	// std::priority_queue keeps the largest on top, we want the cheapest
+	bool operator<(const Collapse& o) const { return Cost > o.Cost; }
+};
+
+// Vertices with the same position are "wedges" of one welded vertex, split by a UV or
+// normal seam. Topology and quadrics live on welded vertices (named by their lowest wedge),
+// the triangles keep referring to wedges so attributes survive.
+struct SimplifyMesh
+{
+	const float* Positions;
+	size_t Stride;
+	std::vector<unsigned int> Welded;      // wedge -> welded vertex
+	std::vector<unsigned int> NextWedge;   // circular list of the wedges of a welded vertex
+	std::vector<unsigned int> Corners;     // 3 wedges per triangle
+	std::vector<bool> Alive;
+	std::vector<std::vector<unsigned int> > Triangles; // welded vertex -> triangles, may hold dead ones
+	std::vector<Quadric> Quadrics;
+	std::vector<bool> Border, Removed;
+	std::vector<unsigned int> Stamp;
+	std::priority_queue<Collapse> Heap;
+	size_t LiveTriangles;
+
+	glm::vec3 Position(unsigned int v) const
+	{
+		const float* p = (const float*)((const char*)Positions + v * Stride);
+		return glm::vec3(p[0], p[1], p[2]);
+	}
+
+	glm::vec3 Normal(const unsigned int* tri, unsigned int from, const glm::vec3& to) const
+	{
+		glm::vec3 p[3];
+		for(int k = 0; k < 3; k++)
+			p[k] = Welded[tri[k]] == from ? to : Position(tri[k]);
+		return glm::cross(p[1] - p[0], p[2] - p[0]);
+	}
+
+	void Push(unsigned int from, unsigned int to)
+	{
+		Quadric q = Quadrics[from];
+		addQuadric(q, Quadrics[to]);
+		Collapse c = { (float)evaluate(q, Position(to)), from, to, Stamp[from], Stamp[to] };
+		Heap.push(c);
+	}
+
+	void Init(const unsigned short* indices, size_t index_count, size_t vertex_count);
+	bool MapWedges(unsigned int from, unsigned int to, std::vector<unsigned int>& pairs) const;
+	bool Flips(unsigned int from, unsigned int to) const;
+	void Apply(unsigned int from, unsigned int to, const std::vector<unsigned int>& pairs);
+};
+
+struct PositionLess
+{
+	const SimplifyMesh* Mesh;
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		glm::vec3 pa = Mesh->Position(a), pb = Mesh->Position(b);
+		if(pa.x != pb.x) return pa.x < pb.x;
+		if(pa.y != pb.y) return pa.y < pb.y;
+		if(pa.z != pb.z) return pa.z < pb.z;
+		return a < b;
+	}
+};
+
+void SimplifyMesh::Init(const unsigned short* indices, size_t index_count, size_t vertex_count)
+{
+	// weld by exact position
+	std::vector<unsigned int> order(vertex_count);
+	for(size_t v = 0; v < vertex_count; v++)
+		order[v] = v;
+	PositionLess less = { this };
+	std::sort(order.begin(), order.end(), less);
+	Welded.resize(vertex_count);
+	NextWedge.resize(vertex_count);
+	for(size_t i = 0; i < vertex_count; )
+	{
+		size_t end = i + 1;
+		while(end < vertex_count && Position(order[end]) == Position(order[i]))
+			end++;
+		for(size_t j = i; j < end; j++)
+		{
+			Welded[order[j]] = order[i];
+			NextWedge[order[j]] = order[j + 1 < end ? j + 1 : i];
+		}
+		i = end;
+	}
+
+	size_t tri_count = index_count / 3;
+	Corners.assign(indices, indices + tri_count * 3);
+	Alive.assign(tri_count, false);
+	Triangles.resize(vertex_count);
+	Quadric zero;
+	memset(&zero, 0, sizeof(zero));
+	Quadrics.assign(vertex_count, zero);
+	Border.assign(vertex_count, false);
+	Removed.assign(vertex_count, false);
+	Stamp.assign(vertex_count, 0);
+	LiveTriangles = 0;
+
+	// edges as (welded a, welded b, triangle) with a < b, to find the open borders
+	std::vector<unsigned long long> edges;
+	for(size_t t = 0; t < tri_count; t++)
+	{
+		unsigned int w[3];
+		for(int k = 0; k < 3; k++)
+			w[k] = Welded[Corners[t * 3 + k]];
+		if(w[0] == w[1] || w[1] == w[2] || w[0] == w[2])
+			continue;
+
+		Alive[t] = true;
+		LiveTriangles++;
+		glm::vec3 n = glm::cross(Position(w[1]) - Position(w[0]), Position(w[2]) - Position(w[0]));
+		float area = glm::length(n);
+		for(int k = 0; k < 3; k++)
+		{
+			Triangles[w[k]].push_back(t);
+			unsigned int a = w[k], b = w[(k + 1) % 3];
+			edges.push_back(((unsigned long long)std::min(a, b) << 32) | std::max(a, b));
+		}
+		if(area == 0.0f)
+			continue;
+		n = n / area;
+		float d = -glm::dot(n, Position(w[0]));
+		for(int k = 0; k < 3; k++)
+			addPlane(Quadrics[w[k]], n, d, area);
+	}
+
+	std::sort(edges.begin(), edges.end());
+	for(size_t i = 0; i < edges.size(); )
+	{
+		size_t end = i + 1;
+		while(end < edges.size() && edges[end] == edges[i])
+			end++;
+		if(end - i == 1)
+		{
+			unsigned int a = (unsigned int)(edges[i] >> 32), b = (unsigned int)edges[i];
+			Border[a] = Border[b] = true;
+			// any triangle on the edge gives the face normal to build the border plane from
+			for(size_t j = 0; j < Triangles[a].size(); j++)
+			{
+				const unsigned int* tri = &Corners[Triangles[a][j] * 3];
+				if(Welded[tri[0]] != b && Welded[tri[1]] != b && Welded[tri[2]] != b)
+					continue;
+				glm::vec3 face = Normal(tri, ~0u, glm::vec3(0.0f));
+				glm::vec3 n = glm::cross(Position(b) - Position(a), face);
+				float len = glm::length(n);
+				if(len > 0.0f)
+				{
+					n = n / len;
+					float d = -glm::dot(n, Position(a));
+					float edge = glm::length(Position(b) - Position(a));
+					addPlane(Quadrics[a], n, d, BORDER_WEIGHT * edge * edge);
+					addPlane(Quadrics[b], n, d, BORDER_WEIGHT * edge * edge);
+				}
+				break;
+			}
+		}
+		i = end;
+	}
+
+	for(size_t i = 0; i < edges.size(); i++)
+	{
+		if(i > 0 && edges[i] == edges[i - 1])
+			continue;
+		unsigned int a = (unsigned int)(edges[i] >> 32), b = (unsigned int)edges[i];
+		Push(a, b);
+		Push(b, a);
+	}
+}
+
+// Every wedge of from must have a wedge of to on the same side of any seam, found through a
+// triangle that has both. Collapsing a seam vertex off its seam fails here, which is what keeps
+// the UVs from smearing. pairs gets (wedge, replacement) for each.
+bool SimplifyMesh::MapWedges(unsigned int from, unsigned int to, std::vector<unsigned int>& pairs) const
+{
+	pairs.clear();
+	unsigned int w = from;
+	do
+	{
+		unsigned int found = ~0u;
+		const std::vector<unsigned int>& tris = Triangles[from];
+		for(size_t i = 0; i < tris.size() && found == ~0u; i++)
+		{
+			if(!Alive[tris[i]])
+				continue;
+			const unsigned int* tri = &Corners[tris[i] * 3];
+			if(tri[0] != w && tri[1] != w && tri[2] != w)
+				continue;
+			for(int k = 0; k < 3; k++)
+				if(Welded[tri[k]] == to)
+					found = tri[k];
+		}
+		if(found == ~0u)
+		{
+			// a wedge nothing refers to any more can go anywhere
+			bool used = false;
+			for(size_t i = 0; i < tris.size() && !used; i++)
+			{
+				const unsigned int* tri = &Corners[tris[i] * 3];
+				used = Alive[tris[i]] && (tri[0] == w || tri[1] == w || tri[2] == w);
+			}
+			if(used)
+				return false;
+			found = to;
+		}
+		pairs.push_back(w);
+		pairs.push_back(found);
+		w = NextWedge[w];
+	}
+	while(w != from);
+	return true;
+}
+
+bool SimplifyMesh::Flips(unsigned int from, unsigned int to) const
+{
+	glm::vec3 target = Position(to);
+	const std::vector<unsigned int>& tris = Triangles[from];
+	for(size_t i = 0; i < tris.size(); i++)
+	{
+		if(!Alive[tris[i]])
+			continue;
+		const unsigned int* tri = &Corners[tris[i] * 3];
+		if(Welded[tri[0]] == to || Welded[tri[1]] == to || Welded[tri[2]] == to)
+			continue;
+		glm::vec3 before = Normal(tri, ~0u, target);
+		glm::vec3 after = Normal(tri, from, target);
+		float lb = glm::length(before), la = glm::length(after);
+		if(la == 0.0f || glm::dot(before, after) < MAX_FLIP_COSINE * lb * la)
+			return true;
+	}
+	return false;
+}
+
+void SimplifyMesh::Apply(unsigned int from, unsigned int to, const std::vector<unsigned int>& pairs)
+{
+	std::vector<unsigned int> kept;
+	for(size_t i = 0; i < Triangles[to].size(); i++)
+		if(Alive[Triangles[to][i]])
+			kept.push_back(Triangles[to][i]);
+
+	const std::vector<unsigned int>& tris = Triangles[from];
+	for(size_t i = 0; i < tris.size(); i++)
+	{
+		unsigned int t = tris[i];
+		if(!Alive[t])
+			continue;
+		unsigned int* tri = &Corners[t * 3];
+		if(Welded[tri[0]] == to || Welded[tri[1]] == to || Welded[tri[2]] == to)
+		{
+			Alive[t] = false;
+			LiveTriangles--;
+			continue;
+		}
+		for(int k = 0; k < 3; k++)
+			for(size_t p = 0; p < pairs.size(); p += 2)
+				if(tri[k] == pairs[p])
+				{
+					tri[k] = pairs[p + 1];
+					break;
+				}
+		kept.push_back(t);
+	}
+
+	Triangles[to].swap(kept);
+	std::vector<unsigned int>().swap(Triangles[from]);
+	addQuadric(Quadrics[to], Quadrics[from]);
+	Removed[from] = true;
+	Stamp[to]++;
+
+	std::vector<unsigned int> neighbours;
+	for(size_t i = 0; i < Triangles[to].size(); i++)
+		for(int k = 0; k < 3; k++)
+		{
+			unsigned int n = Welded[Corners[Triangles[to][i] * 3 + k]];
+			if(n != to)
+				neighbours.push_back(n);
+		}
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+	for(size_t i = 0; i < neighbours.size(); i++)
+	{
+		Push(neighbours[i], to);
+		Push(to, neighbours[i]);
+	}
+}
+
+float simplifyMesh(
+	const unsigned short* indices, size_t index_count,
+	const float* positions, size_t vertex_count, size_t position_stride,
+	size_t target_index_count,
+	std::vector<unsigned short>& out_indices)
+{
+	SimplifyMesh mesh;
+	mesh.Positions = positions;
+	mesh.Stride = position_stride;
+	mesh.Init(indices, index_count, vertex_count);
+
+	double max_cost = 0.0;
+	std::vector<unsigned int> pairs;
+	while(mesh.LiveTriangles * 3 > target_index_count && !mesh.Heap.empty())
+	{
+		Collapse c = mesh.Heap.top();
+		mesh.Heap.pop();
+		if(mesh.Removed[c.From] || mesh.Removed[c.To] ||
+		   mesh.Stamp[c.From] != c.FromStamp || mesh.Stamp[c.To] != c.ToStamp)
+			continue;
+		// a border vertex may only slide along the border
+		if(mesh.Border[c.From] && !mesh.Border[c.To])
+			continue;
+		if(!mesh.MapWedges(c.From, c.To, pairs) || mesh.Flips(c.From, c.To))
+			continue;
+		mesh.Apply(c.From, c.To, pairs);
+		max_cost = std::max(max_cost, (double)c.Cost);
+	}
+
+	out_indices.clear();
+	out_indices.reserve(mesh.LiveTriangles * 3);
+	for(size_t t = 0; t < mesh.Alive.size(); t++)
+		if(mesh.Alive[t])
+			out_indices.insert(out_indices.end(), &mesh.Corners[t * 3], &mesh.Corners[t * 3] + 3);
+	return (float)sqrt(max_cost);
+}
+
+void buildMeshLODs(
+	const unsigned short* indices, size_t index_count,
+	const float* positions, size_t vertex_count, size_t position_stride,
+	int levels,
+	MeshLODChain& out_lods,
+	std::vector<unsigned short>& out_indices)
+{
+	out_lods = MeshLODChain();
+	if(vertex_count == 0)
+		return;
+
+	glm::vec3 bmin, bmax;
+	for(size_t v = 0; v < vertex_count; v++)
+	{
+		const float* p = (const float*)((const char*)positions + v * position_stride);
+		glm::vec3 position(p[0], p[1], p[2]);
+		bmin = v ? glm::min(bmin, position) : position;
+		bmax = v ? glm::max(bmax, position) : position;
+	}
+	out_lods.Center = (bmin + bmax) * 0.5f;
+	for(size_t v = 0; v < vertex_count; v++)
+	{
+		const float* p = (const float*)((const char*)positions + v * position_stride);
+		out_lods.Radius = std::max(out_lods.Radius, glm::length(glm::vec3(p[0], p[1], p[2]) - out_lods.Center));
+	}
+
+	std::vector<unsigned short> current(indices, indices + index_count);
+	float error = 0.0f;
+	for(int level = 0; level < levels && level < MAX_MESH_LODS; level++)
+	{
+		if(level > 0)
+		{
+			std::vector<unsigned short> next;
+			error += simplifyMesh(&current[0], current.size(), positions, vertex_count, position_stride, current.size() / 6 * 3, next);
+			// not worth a level when the seams and borders left little to collapse
+			if(next.empty() || next.size() > current.size() * 3 / 4)
+				break;
+			current.swap(next);
+			optimizeVertexCache(&current[0], current.size(), vertex_count);
+		}
+
+		MeshLOD& lod = out_lods.Levels[level];
+		lod.IndexOffset = out_indices.size();
+		lod.IndexCount = current.size();
+		lod.Error = error;
+		out_indices.insert(out_indices.end(), current.begin(), current.end());
+		out_lods.NumLevels++;
+	}
+}
+
+float projectedMeshRadius(const MeshLODChain& lods, const glm::mat4& projection, const glm::mat4& model_view, float viewport_height)
+{
+	// the largest axis scale of the model matrix scales the sphere and the errors alike
+	float scale = std::max(glm::length(glm::vec3(model_view[0])),
+		std::max(glm::length(glm::vec3(model_view[1])), glm::length(glm::vec3(model_view[2]))));
+	glm::vec4 center = model_view * glm::vec4(lods.Center, 1.0f);
+	float radius = lods.Radius * scale;
+	float distance = -center.z - radius;
+	// the camera is inside the sphere, it covers the screen
+	if(distance <= 0.0f)
+		return viewport_height;
+	return radius * projection[1][1] * 0.5f * viewport_height / distance;
+}
+
+int selectMeshLOD(const MeshLODChain& lods, const glm::mat4& projection, const glm::mat4& model_view, float viewport_height, float max_pixel_error)
+{
+	if(lods.Radius <= 0.0f)
+		return 0;
+	// pixels per model unit at the nearest point of the bounding sphere
+	float pixels = projectedMeshRadius(lods, projection, model_view, viewport_height) / lods.Radius;
+	for(int level = lods.NumLevels - 1; level > 0; level--)
+		if(lods.Levels[level].Error * pixels <= max_pixel_error)
+			return level;
+	return 0;
+}
+
+void printMeshLODs(const char* label, const MeshLODChain& lods)
+{
+	printf("%s: radius %.3f\n", label, lods.Radius);
+	for(int level = 0; level < lods.NumLevels; level++)
+		printf("  LOD%d %6u triangles  error %.5f\n", level, lods.Levels[level].IndexCount / 3, lods.Levels[level].Error);
+}
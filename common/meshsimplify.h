@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Quadric error metric simplification (Garland & Heckbert). Edges collapse onto one of
+// their two vertices, so the simplified index lists still refer to the original vertex
+// buffer and every LOD can share it. UV seams and open borders are kept intact.
+
+// Simplifies towards target_index_count indices (it stops early when nothing more can
+// collapse without flipping triangles or tearing a seam). positions points at the first
+// vertex position, position_stride bytes apart. Returns the error of the result in model units.
+float simplifyMesh(
+	const unsigned short* indices, size_t index_count,
+	const float* positions, size_t vertex_count, size_t position_stride,
+	size_t target_index_count,
+	std::vector<unsigned short>& out_indices);
+
+#define MAX_MESH_LODS 4
+
+struct MeshLOD
+{
+	unsigned int IndexOffset;  // in indices, into the shared index buffer
+	unsigned int IndexCount;
+	float Error;               // model units, relative to level 0
+};
+
+struct MeshLODChain
+{
+	int NumLevels;
+	MeshLOD Levels[MAX_MESH_LODS];
+	glm::vec3 Center;          // bounding sphere, model space
+	float Radius;
+};
+
+// Level 0 is the input, each next level has about half the triangles of the one before.
+// The indices of all levels are appended to out_indices (offsets in the chain account for
+// anything already there) and each level is reordered for the vertex cache.
+void buildMeshLODs(
+	const unsigned short* indices, size_t index_count,
+	const float* positions, size_t vertex_count, size_t position_stride,
+	int levels,
+	MeshLODChain& out_lods,
+	std::vector<unsigned short>& out_indices);
+
+// Projected size of the bounding sphere in pixels, from the same matrices as the MVP
+float projectedMeshRadius(const MeshLODChain& lods, const glm::mat4& projection, const glm::mat4& model_view, float viewport_height);
+
+// Coarsest level whose error covers at most max_pixel_error pixels on screen
+int selectMeshLOD(const MeshLODChain& lods, const glm::mat4& projection, const glm::mat4& model_view, float viewport_height, float max_pixel_error = 1.0f);
+
+void printMeshLODs(const char* label, const MeshLODChain& lods);
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "meshstream.h"
+#include "gpumemory.h"
+#include "glstate.h"
+
+bool StreamingMesh::Open(const char* filename, size_t budget_bytes)
+{
+	Close();
+	if(!File.Open(filename))
+	{
+		printf("Could not open chunk file %s\n", filename);
+		return false;
+	}
+
+	MeshBuffers empty;
+	memset(&empty, 0, sizeof(empty));
+	Buffers.assign(File.GetChunkCount(), empty);
+	Residency.Init(File.GetChunkCount(), budget_bytes);
+
+	unsigned long long total = 0;
+	for(unsigned int i = 0; i < File.GetChunkCount(); i++)
+		total += File.GetChunkDataSize(i);
+	printf("Streaming %s: %u chunks, %.1f MB on disk, %.1f MB budget\n", filename,
+		File.GetChunkCount(), total / (1024.0 * 1024.0), budget_bytes / (1024.0 * 1024.0));
+	return true;
+}
+
+void StreamingMesh::Close()
+{
+	for(size_t i = 0; i < Buffers.size(); i++)
+		Release(i);
+	Buffers.clear();
+	File.Close();
+	Residency.Init(0, 0);
+}
+
+void StreamingMesh::Upload(unsigned int chunk)
+{
+	if(!File.ReadChunk(chunk, Staging))
+	{
+		printf("Chunk %u could not be read, it won't be drawn\n", chunk);
+		Residency.MarkFailed(chunk);
+		return;
+	}
+
+	const ChunkFileEntry& entry = File.GetChunk(chunk);
+	size_t vertex_size = File.GetChunkVertexSize(chunk);
+	MeshBuffers& buffers = Buffers[chunk];
+	buffers.IndexCount = entry.IndexCount;
+	buffers.VertexCount = entry.VertexCount;
+	buffers.Stride = File.GetHeader().VertexStride;
+	memcpy(buffers.BoundsMin, entry.BoundsMin, sizeof(buffers.BoundsMin));
+	memcpy(buffers.BoundsMax, entry.BoundsMax, sizeof(buffers.BoundsMax));
+
+	// the chunk fits the stream's own budget, createBuffer reserves in the whole GPU's
+	buffers.VertexBuffer = createBuffer(GL_ARRAY_BUFFER, &Staging[0], vertex_size);
+	buffers.ElementBuffer = createBuffer(GL_ELEMENT_ARRAY_BUFFER, &Staging[vertex_size], Staging.size() - vertex_size);
+	Residency.MarkResident(chunk, Staging.size());
+}
+
+void StreamingMesh::Release(unsigned int chunk)
+{
+	if(Buffers[chunk].VertexBuffer)
+		deleteMeshBuffers(Buffers[chunk]);
+}
+
+int StreamingMesh::Draw(VertexLayout& layout, const glm::mat4& mvp, const glm::vec3& camera)
+{
+	Residency.BeginFrame();
+	sortVisibleChunks(File, mvp, camera, MaxDistance, Wanted);
+
+	int uploads = 0, drawn = 0;
+	for(size_t i = 0; i < Wanted.size(); i++)
+	{
+		unsigned int chunk = Wanted[i];
+		if(Residency.IsFailed(chunk))
+			continue;
+		if(!Residency.Touch(chunk))
+		{
+			// the rest wait for a later frame, or for room once the camera moves on
+			if(uploads >= MaxUploadsPerFrame)
+				continue;
+			Evicted.clear();
+			if(!Residency.Reserve(File.GetChunkDataSize(chunk), Evicted))
+				continue;
+			for(size_t e = 0; e < Evicted.size(); e++)
+				Release(Evicted[e]);
+			Upload(chunk);
+			uploads++;
+			if(!Residency.IsResident(chunk))
+				continue;
+		}
+
+		const MeshBuffers& buffers = Buffers[chunk];
+		layout.Enable(buffers.VertexBuffer);
+		GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ElementBuffer);
+		glDrawElements(GL_TRIANGLES, buffers.IndexCount, GL_UNSIGNED_SHORT, 0);
+		drawn++;
+	}
+	return drawn;
+}
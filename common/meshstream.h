@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GLES2/gl2.h"
+#include "chunkfile.h"
+#include "residency.h"
+#include "meshloader.h"
+
+// Draws a chunk file (see chunkfile.h, made with objconvert model.obj model.obj.chunks) while
+// keeping only the chunks near the camera in GL buffers, within a fixed budget of bytes.
+// Chunks are streamed in nearest first, a few per frame so a fast camera move doesn't stall
+// a frame, and the least recently drawn ones are evicted to make room.
+class StreamingMesh
+{
+	ChunkFile File;
+	ResidencyManager Residency;
+	std::vector<MeshBuffers> Buffers;   // per chunk, zeroed while not resident
+	std::vector<unsigned int> Wanted;
+	std::vector<unsigned int> Evicted;
+	std::vector<unsigned char> Staging;
+	int MaxUploadsPerFrame;
+	float MaxDistance;
+
+	void Upload(unsigned int chunk);
+	void Release(unsigned int chunk);
+
+public:
+
+	StreamingMesh() : MaxUploadsPerFrame(4), MaxDistance(1e30f) {}
+	~StreamingMesh() { Close(); }
+
+	bool Open(const char* filename, size_t budget_bytes);
+	void Close();
+
+	void SetMaxUploadsPerFrame(int count) { MaxUploadsPerFrame = count; }
+	// Chunks further than this from the camera are neither streamed nor drawn
+	void SetMaxDistance(float distance) { MaxDistance = distance; }
+
+	// Streams what this view needs and draws the resident visible chunks with a
+	// describeMeshVertex layout. camera is the eye position in model space.
+	// Returns the number of chunks drawn.
+	int Draw(VertexLayout& layout, const glm::mat4& mvp, const glm::vec3& camera);
+
+	ResidencyManager& GetResidency() { return Residency; }
+};
@@ -0,0 +1,228 @@
+#include <math.h>
+#include <string.h>
+
+#include "mipchain.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MIPS_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#define MIPS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// Size of the table going back from linear light to sRGB bytes. It needs to be fine near
+// black where sRGB steps are small in linear terms.
+#define LINEAR_TO_SRGB_SIZE 16384
+
+#define KAISER_TAPS 8
+#define KAISER_ALPHA 4.0
+
+// The 256 and LINEAR_TO_SRGB_SIZE entry conversion tables, built on first use
+struct GammaTables
+{
+	float ToLinear[256];
+	unsigned char ToSRGB[LINEAR_TO_SRGB_SIZE];
+
+	GammaTables()
+	{
+		for(int i = 0; i < 256; i++)
+		{
+			double c = i / 255.0;
+			ToLinear[i] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+		}
+		for(int i = 0; i < LINEAR_TO_SRGB_SIZE; i++)
+		{
+			double l = (i + 0.5) / LINEAR_TO_SRGB_SIZE;
+			double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+			ToSRGB[i] = (unsigned char)(c * 255.0 + 0.5);
+		}
+	}
+};
+
+static const GammaTables& gammaTables()
+{
+	static GammaTables tables;
+	return tables;
+}
+
+// Filter weights for halving, taps start at 2x - (taps/2 - 1) for output x
+struct MipKernel
+{
+	int Taps;
+	float Weights[KAISER_TAPS];
+};
+
+// Zeroth order modified Bessel function, for the Kaiser window
+static double besselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for(int k = 1; k < 32; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+static void makeKernel(MipFilter filter, MipKernel& kernel)
+{
+	if(filter == MIP_FILTER_BOX)
+	{
+		kernel.Taps = 2;
+		kernel.Weights[0] = kernel.Weights[1] = 0.5f;
+		return;
+	}
+
+	// sinc cut off at half the source rate, under a Kaiser window as wide as the taps.
+	// The taps sit at half sample offsets around the centre of each output pixel.
+	kernel.Taps = KAISER_TAPS;
+	double half = KAISER_TAPS / 2.0, sum = 0.0, weights[KAISER_TAPS];
+	for(int i = 0; i < KAISER_TAPS; i++)
+	{
+		double t = i - half + 0.5;
+		double x = M_PI * t / 2.0;
+		double sinc = x == 0.0 ? 1.0 : sin(x) / x;
+		double r = t / half;
+		double window = besselI0(KAISER_ALPHA * sqrt(1.0 - r * r)) / besselI0(KAISER_ALPHA);
+		weights[i] = sinc * window;
+		sum += weights[i];
+	}
+	for(int i = 0; i < KAISER_TAPS; i++)
+		kernel.Weights[i] = (float)(weights[i] / sum);
+}
+
+static inline unsigned int clampIndex(int i, unsigned int size)
+{
+	return i < 0 ? 0 : ((unsigned int)i >= size ? size - 1 : (unsigned int)i);
+}
+
+// dst[i] = sum of weights[k] * rows[k][i], the part worth vectorising as it runs along whole rows
+static void weightedRowSum(const float* const* rows, const float* weights, int taps, float* dst, size_t count)
+{
+	size_t i = 0;
+#if MIPS_NEON
+	for(; i + 4 <= count; i += 4)
+	{
+		float32x4_t sum = vmulq_n_f32(vld1q_f32(rows[0] + i), weights[0]);
+		for(int k = 1; k < taps; k++)
+			sum = vmlaq_n_f32(sum, vld1q_f32(rows[k] + i), weights[k]);
+		vst1q_f32(dst + i, sum);
+	}
+#elif MIPS_SSE
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + i), _mm_set1_ps(weights[0]));
+		for(int k = 1; k < taps; k++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+		_mm_storeu_ps(dst + i, sum);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		float sum = 0.0f;
+		for(int k = 0; k < taps; k++)
+			sum += weights[k] * rows[k][i];
+		dst[i] = sum;
+	}
+}
+
+// Halves a float image, first along the rows then down the columns
+static void halveImage(const std::vector<float>& src, unsigned int width, unsigned int height, int channels,
+	const MipKernel& kernel, std::vector<float>& dst, unsigned int out_width, unsigned int out_height)
+{
+	int first = -(kernel.Taps / 2 - 1);
+
+	std::vector<float> rows(height * out_width * channels);
+	for(unsigned int y = 0; y < height; y++)
+	{
+		const float* in = &src[y * width * channels];
+		float* out = &rows[y * out_width * channels];
+		for(unsigned int x = 0; x < out_width; x++)
+		{
+			for(int c = 0; c < channels; c++)
+			{
+				float sum = 0.0f;
+				for(int k = 0; k < kernel.Taps; k++)
+					sum += kernel.Weights[k] * in[ clampIndex(x * 2 + first + k, width) * channels + c ];
+				out[x * channels + c] = sum;
+			}
+		}
+	}
+
+	dst.resize(out_width * out_height * channels);
+	size_t rowFloats = out_width * channels;
+	const float* taps[KAISER_TAPS];
+	for(unsigned int y = 0; y < out_height; y++)
+	{
+		for(int k = 0; k < kernel.Taps; k++)
+			taps[k] = &rows[ clampIndex(y * 2 + first + k, height) * rowFloats ];
+		weightedRowSum(taps, kernel.Weights, kernel.Taps, &dst[y * rowFloats], rowFloats);
+	}
+}
+
+static void storeLevel(const std::vector<float>& linear, int channels, MipLevel& level)
+{
+	const GammaTables& tables = gammaTables();
+	level.Pixels.resize(linear.size());
+	for(size_t i = 0; i < linear.size(); i++)
+	{
+		// the Kaiser lobes can overshoot
+		float v = linear[i];
+		v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+		if(channels == 4 && i % 4 == 3)
+			level.Pixels[i] = (unsigned char)(v * 255.0f + 0.5f);
+		else
+			level.Pixels[i] = tables.ToSRGB[ (int)(v * (LINEAR_TO_SRGB_SIZE - 1)) ];
+	}
+}
+
+void buildMipChain(const unsigned char* pixels, unsigned int width, unsigned int height, int channels,
+	MipFilter filter, std::vector<MipLevel>& out_levels)
+{
+	out_levels.clear();
+	if(width == 0 || height == 0)
+		return;
+
+	MipLevel top;
+	top.Width = width;
+	top.Height = height;
+	top.Pixels.assign(pixels, pixels + width * height * channels);
+	out_levels.push_back(top);
+
+	const GammaTables& tables = gammaTables();
+	std::vector<float> linear(width * height * channels), next;
+	for(size_t i = 0; i < linear.size(); i++)
+		linear[i] = channels == 4 && i % 4 == 3 ? pixels[i] / 255.0f : tables.ToLinear[ pixels[i] ];
+
+	MipKernel kernel;
+	makeKernel(filter, kernel);
+	while(width > 1 || height > 1)
+	{
+		unsigned int nextWidth = width > 1 ? width / 2 : 1;
+		unsigned int nextHeight = height > 1 ? height / 2 : 1;
+		halveImage(linear, width, height, channels, kernel, next, nextWidth, nextHeight);
+		linear.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+
+		MipLevel level;
+		level.Width = width;
+		level.Height = height;
+		storeLevel(linear, channels, level);
+		out_levels.push_back(level);
+	}
+}
+
+const char* mipChainBackend()
+{
+#if MIPS_NEON
+	return "NEON";
+#elif MIPS_SSE
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
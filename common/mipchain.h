@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+// Mip chain generation on the CPU, for baking into texture files so the loaders can upload
+// every level instead of calling glGenerateMipmap at startup. Colour channels are filtered
+// in linear light (sRGB decoded, filtered, encoded again), alpha is filtered as it is.
+// Each level is made from the float copy of the one above, never from rounded bytes.
+// The vertical pass has NEON and SSE versions, chosen when compiling. No GL here.
+
+enum MipFilter
+{
+	MIP_FILTER_BOX,      // 2x2 average, cheap, a little blurry and aliases on fine detail
+	MIP_FILTER_KAISER,   // 8 tap Kaiser windowed sinc, sharper with less aliasing
+};
+
+struct MipLevel
+{
+	unsigned int Width, Height;
+	std::vector<unsigned char> Pixels;   // tightly packed, same layout as the input
+};
+
+// Fills out_levels with level 0 (a copy of pixels) down to 1x1, channels is 3 (RGB) or 4 (RGBA).
+// Odd sizes round down, the last row/column repeats.
+void buildMipChain(const unsigned char* pixels, unsigned int width, unsigned int height, int channels,
+	MipFilter filter, std::vector<MipLevel>& out_levels);
+
+// Which SIMD version was compiled in, "NEON", "SSE" or "scalar"
+const char* mipChainBackend();
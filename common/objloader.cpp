@@ -1,110 +1,771 @@
-#include <vector>
-#include <stdio.h>
-#include <string>
-#include <cstring>
-
-#include <glm/glm.hpp>
-
-#include "objloader.h"
-
-// Very, VERY simple OBJ loader.
-// Here is a short list of features a real function would provide : 
-// - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime. In short : OBJ is not very great.
-// - Animations & bones (includes bones weights)
-// - Multiple UVs
-// - All attributes should be optional, not "forced"
-// - More stable. Change a line in the OBJ file and it crashes.
-// - More secure. Change another line and you can inject code.
-// - Loading from memory, stream, etc
-
-bool loadOBJ(
-	const char * path, 
-	std::vector<glm::vec3> & out_vertices, 
-	std::vector<glm::vec2> & out_uvs,
-	std::vector<glm::vec3> & out_normals
-){
-	printf("Loading OBJ file %s...\n", path);
-
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices; 
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-
-
-	FILE * file = fopen(path, "r");
-	if( file == NULL ){
-		printf("Impossible to open the file ! Are you in the right path ? See Tutorial 1 for details\n");
-		getchar();
-		return false;
-	}
-
-	while( 1 ){
-
-		char lineHeader[128];
-		// read the first word of the line
-		int res = fscanf(file, "%s", lineHeader);
-		if (res == EOF)
-			break; // EOF = End Of File. Quit the loop.
-
-		// else : parse lineHeader
-		
-		if ( strcmp( lineHeader, "v" ) == 0 ){
-			glm::vec3 vertex;
-			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z );
-			temp_vertices.push_back(vertex);
-		}else if ( strcmp( lineHeader, "vt" ) == 0 ){
-			glm::vec2 uv;
-			fscanf(file, "%f %f\n", &uv.x, &uv.y );
-			uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
-			temp_uvs.push_back(uv);
-		}else if ( strcmp( lineHeader, "vn" ) == 0 ){
-			glm::vec3 normal;
-			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z );
-			temp_normals.push_back(normal);
-		}else if ( strcmp( lineHeader, "f" ) == 0 ){
-			std::string vertex1, vertex2, vertex3;
-			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
-			if (matches != 9){
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				return false;
-			}
-			vertexIndices.push_back(vertexIndex[0]);
-			vertexIndices.push_back(vertexIndex[1]);
-			vertexIndices.push_back(vertexIndex[2]);
-			uvIndices    .push_back(uvIndex[0]);
-			uvIndices    .push_back(uvIndex[1]);
-			uvIndices    .push_back(uvIndex[2]);
-			normalIndices.push_back(normalIndex[0]);
-			normalIndices.push_back(normalIndex[1]);
-			normalIndices.push_back(normalIndex[2]);
-		}else{
-			// Probably a comment, eat up the rest of the line
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file);
-		}
-
-	}
-
-	// For each vertex of each triangle
-	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
-
-		// Get the indices of its attributes
-		unsigned int vertexIndex = vertexIndices[i];
-		unsigned int uvIndex = uvIndices[i];
-		unsigned int normalIndex = normalIndices[i];
-		
-		// Get the attributes thanks to the index
-		glm::vec3 vertex = temp_vertices[ vertexIndex-1 ];
-		glm::vec2 uv = temp_uvs[ uvIndex-1 ];
-		glm::vec3 normal = temp_normals[ normalIndex-1 ];
-		
-		// Put the attributes in buffers
-		out_vertices.push_back(vertex);
-		out_uvs     .push_back(uv);
-		out_normals .push_back(normal);
-	
-	}
-
-	return true;
-}
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <glm/glm.hpp>
+
+#include "mappedfile.h"
+#include "meshfile.h"
+#include "chunkfile.h"
+#include "meshoptimize.h"
+#include "objloader.h"
+
+// Very, VERY simple OBJ loader.
+// Here is a short list of features a real function would provide :
+// - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime. In short : OBJ is not very great.
+//   (done, see the .mesh cache below)
+// - Animations & bones (includes bones weights)
+// - Multiple UVs
+// - All attributes should be optional, not "forced"
+// - More stable. Change a line in the OBJ file and it crashes.
+// - More secure. Change another line and you can inject code.
+// - Loading from memory, stream, etc
+//
+// The file is mmapped and scanned in place, no stdio per line. Big files are cut into
+// line aligned chunks that are parsed on several threads and then stitched back together.
+// loadOBJIndexed caches its result next to the model (see meshfile.h) and reuses it while
+// it is newer than the .obj, loadOBJ only does with setOBJCache(true). Faces with more
+// than 3 corners are split into a triangle fan, negative (relative) indices are allowed.
+
+// Everything we read from the file (or from one chunk of it), indices are 0 based
+struct OBJData
+{
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<unsigned int> corners; // v,vt,vn for each triangle corner
+	std::vector<size_t> relative;      // corners[] entries counted from the start of the chunk
+};
+
+// One face corner while parsing, bit i of relative is set when index[i] came from
+// a negative OBJ index and so depends on how much the earlier chunks read
+struct OBJCorner
+{
+	unsigned int index[3];
+	unsigned int relative;
+};
+
+// Files smaller than this are not worth starting threads for
+#define OBJ_MIN_CHUNK_SIZE (256 * 1024)
+
+static int GOBJLoaderThreads = 0;
+static bool GOBJCache = false;
+
+void setOBJLoaderThreads(int count)
+{
+	GOBJLoaderThreads = count;
+}
+
+void setOBJCache(bool enabled)
+{
+	GOBJCache = enabled;
+}
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* skipBlanks(const char* p, const char* end)
+{
+	while(p < end && isBlank(*p))
+		p++;
+	return p;
+}
+
+static inline const char* skipLine(const char* p, const char* end)
+{
+	const char* nl = (const char*)memchr(p, '\n', end - p);
+	return nl ? nl + 1 : end;
+}
+
+// exact powers of ten, anything bigger than 1e22 is not exact in a double anyway
+static const double GPow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double pow10i(int e)
+{
+	double r = 1.0;
+	while(e > 22) { r *= GPow10[22]; e -= 22; }
+	return r * GPow10[e];
+}
+
+// Hand rolled replacement for strtof, returns NULL if there is no number at p
+static const char* parseFloat(const char* p, const char* end, float& out)
+{
+	bool neg = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		neg = *p == '-';
+		p++;
+	}
+
+	// collect up to 19 significant digits, that is all an unsigned 64 bit int holds
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool any = false;
+	for(; p < end && *p >= '0' && *p <= '9'; p++, any = true)
+	{
+		if(digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if(mantissa) digits++; }
+		else exponent++;
+	}
+	if(p < end && *p == '.')
+	{
+		for(p++; p < end && *p >= '0' && *p <= '9'; p++, any = true)
+		{
+			if(digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if(mantissa) digits++; exponent--; }
+		}
+	}
+	if(!any)
+		return NULL;
+
+	if(p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		bool eneg = false;
+		if(q < end && (*q == '-' || *q == '+'))
+		{
+			eneg = *q == '-';
+			q++;
+		}
+		if(q < end && *q >= '0' && *q <= '9')
+		{
+			int e = 0;
+			for(; q < end && *q >= '0' && *q <= '9'; q++)
+				if(e < 10000) e = e * 10 + (*q - '0');
+			exponent += eneg ? -e : e;
+			p = q;
+		}
+	}
+
+	// dividing by an exact power of ten rounds correctly, multiplying by 1e-n would not
+	double value = (double)mantissa;
+	if(exponent < 0)
+		value = exponent < -300 ? 0.0 : value / pow10i(-exponent);
+	else if(exponent > 0)
+		value *= pow10i(exponent > 300 ? 300 : exponent);
+
+	out = (float)(neg ? -value : value);
+	return p;
+}
+
+static const char* parseInt(const char* p, const char* end, int& out)
+{
+	bool neg = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		neg = *p == '-';
+		p++;
+	}
+	if(p >= end || *p < '0' || *p > '9')
+		return NULL;
+
+	int value = 0;
+	for(; p < end && *p >= '0' && *p <= '9'; p++)
+		value = value * 10 + (*p - '0');
+	out = neg ? -value : value;
+	return p;
+}
+
+// OBJ indices are 1 based, negative ones count back from the last element read so far.
+// Those can only be resolved within the chunk, the merge adds the chunk's offset later.
+// Range checks also wait for the merge, when the totals are known.
+static unsigned int chunkIndex(int index, size_t count, unsigned int bit, unsigned int& relative)
+{
+	if(index > 0)
+		return index - 1;
+	if(index == 0)
+		return 0xFFFFFFFF; // never valid
+	relative |= bit;
+	return (unsigned int)(count + index); // may wrap, the offset brings it back
+}
+
+// Parses one "v/vt/vn" face corner
+static const char* parseCorner(const char* p, const char* end, const OBJData& data, OBJCorner& corner)
+{
+	int v, vt, vn;
+	if(!(p = parseInt(p, end, v)) || p >= end || *p++ != '/') return NULL;
+	if(!(p = parseInt(p, end, vt)) || p >= end || *p++ != '/') return NULL;
+	if(!(p = parseInt(p, end, vn))) return NULL;
+
+	corner.relative = 0;
+	corner.index[0] = chunkIndex(v, data.vertices.size(), 1, corner.relative);
+	corner.index[1] = chunkIndex(vt, data.uvs.size(), 2, corner.relative);
+	corner.index[2] = chunkIndex(vn, data.normals.size(), 4, corner.relative);
+	return p;
+}
+
+static void pushCorner(OBJData& data, const OBJCorner& corner)
+{
+	for(int i = 0; corner.relative && i < 3; i++)
+		if(corner.relative & (1 << i))
+			data.relative.push_back(data.corners.size() + i);
+	data.corners.insert(data.corners.end(), corner.index, corner.index + 3);
+}
+
+static const char* parseFloats(const char* p, const char* end, float* out, int count)
+{
+	for(int i = 0; i < count; i++)
+	{
+		p = skipBlanks(p, end);
+		if(!(p = parseFloat(p, end, out[i])))
+			return NULL;
+	}
+	return p;
+}
+
+// Single pass over [p,end) filling data, returns false on anything we can't read
+static bool parseOBJ(const char* p, const char* end, OBJData& data)
+{
+	while(p < end)
+	{
+		p = skipBlanks(p, end);
+		if(p >= end)
+			break;
+
+		const char* ok = NULL;
+		if(p[0] == 'v' && p + 1 < end && isBlank(p[1]))
+		{
+			glm::vec3 vertex;
+			if((ok = parseFloats(p + 1, end, &vertex.x, 3)))
+				data.vertices.push_back(vertex);
+		}
+		else if(p[0] == 'v' && p + 2 < end && p[1] == 't' && isBlank(p[2]))
+		{
+			glm::vec2 uv;
+			if((ok = parseFloats(p + 2, end, &uv.x, 2)))
+			{
+				uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
+				data.uvs.push_back(uv);
+			}
+		}
+		else if(p[0] == 'v' && p + 2 < end && p[1] == 'n' && isBlank(p[2]))
+		{
+			glm::vec3 normal;
+			if((ok = parseFloats(p + 2, end, &normal.x, 3)))
+				data.normals.push_back(normal);
+		}
+		else if(p[0] == 'f' && p + 1 < end && isBlank(p[1]))
+		{
+			// read the polygon as a fan around its first corner
+			OBJCorner first, prev, cur;
+			int n = 0;
+			ok = p + 1;
+			for(;;)
+			{
+				const char* q = skipBlanks(ok, end);
+				if(q >= end || *q == '\n' || *q == '#')
+					break;
+				if(!(q = parseCorner(q, end, data, n == 0 ? first : cur)))
+				{
+					ok = NULL;
+					break;
+				}
+				ok = q;
+				if(n >= 2)
+				{
+					pushCorner(data, first);
+					pushCorner(data, prev);
+					pushCorner(data, cur);
+				}
+				if(n >= 1)
+					prev = cur;
+				n++;
+			}
+			if(ok && n < 3)
+				ok = NULL;
+		}
+		else
+		{
+			// Probably a comment, eat up the rest of the line
+			ok = p;
+		}
+
+		if(!ok)
+		{
+			printf("File can't be read by our simple parser :-( Try exporting with other options\n");
+			return false;
+		}
+		p = skipLine(ok, end);
+	}
+	return true;
+}
+
+// Every corner has to point at something that was actually read
+static bool checkCorners(const OBJData & data, const unsigned int* corners, size_t count)
+{
+	size_t limits[3] = { data.vertices.size(), data.uvs.size(), data.normals.size() };
+	for( size_t i=0; i<count; i++ ){
+		if( corners[i] >= limits[i % 3] ){
+			printf("File can't be read by our simple parser :-( Try exporting with other options\n");
+			return false;
+		}
+	}
+	return true;
+}
+
+// A line aligned piece of the file and what came out of it
+struct OBJChunk
+{
+	const char* begin;
+	const char* end;
+	OBJData data;
+	size_t offsets[4]; // where vertices, uvs, normals and corners go in the merged result
+	OBJData* merged;
+	bool ok;
+};
+
+static void* parseChunk(void* arg)
+{
+	OBJChunk* chunk = (OBJChunk*)arg;
+	chunk->ok = parseOBJ(chunk->begin, chunk->end, chunk->data);
+	return NULL;
+}
+
+// Copies a chunk to its prefix summed offsets and turns its relative indices absolute
+static void* mergeChunk(void* arg)
+{
+	OBJChunk* chunk = (OBJChunk*)arg;
+	OBJData & src = chunk->data;
+	OBJData & dst = *chunk->merged;
+
+	std::copy(src.vertices.begin(), src.vertices.end(), dst.vertices.begin() + chunk->offsets[0]);
+	std::copy(src.uvs     .begin(), src.uvs     .end(), dst.uvs     .begin() + chunk->offsets[1]);
+	std::copy(src.normals .begin(), src.normals .end(), dst.normals .begin() + chunk->offsets[2]);
+
+	if( !src.corners.empty() ){
+		unsigned int* corners = &dst.corners[ chunk->offsets[3] ];
+		std::copy(src.corners.begin(), src.corners.end(), corners);
+		for( size_t i=0; i<src.relative.size(); i++ ){
+			size_t slot = src.relative[i];
+			corners[slot] += (unsigned int)chunk->offsets[slot % 3];
+		}
+		chunk->ok = checkCorners(dst, corners, src.corners.size());
+	}
+
+	// the chunk's own copy is not needed any more
+	std::vector<glm::vec3>().swap(src.vertices);
+	std::vector<glm::vec2>().swap(src.uvs);
+	std::vector<glm::vec3>().swap(src.normals);
+	std::vector<unsigned int>().swap(src.corners);
+	return NULL;
+}
+
+// Runs fn on every chunk, one thread each, the calling thread takes the first
+static bool runChunks(void* (*fn)(void*), std::vector<OBJChunk> & chunks)
+{
+	std::vector<pthread_t> threads(chunks.size());
+	std::vector<bool> started(chunks.size(), false);
+	for( size_t i=1; i<chunks.size(); i++ )
+		started[i] = pthread_create(&threads[i], NULL, fn, &chunks[i]) == 0;
+
+	fn(&chunks[0]);
+
+	bool ok = chunks[0].ok;
+	for( size_t i=1; i<chunks.size(); i++ ){
+		// couldn't get a thread, do it here
+		if( started[i] )
+			pthread_join(threads[i], NULL);
+		else
+			fn(&chunks[i]);
+		ok = ok && chunks[i].ok;
+	}
+	return ok;
+}
+
+static int objLoaderThreads()
+{
+	if( GOBJLoaderThreads > 0 )
+		return GOBJLoaderThreads;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (int)cores : 1;
+}
+
+// Maps and parses the whole file
+static bool readOBJ(const char * path, OBJData & data)
+{
+	printf("Loading OBJ file %s...\n", path);
+
+	MappedFile file;
+	if( !file.Open(path) ){
+		printf("Impossible to open the file ! Are you in the right path ? See Tutorial 1 for details\n");
+		getchar();
+		return false;
+	}
+
+	const char* begin = file.GetData();
+	const char* end = begin + file.GetSize();
+	size_t count = objLoaderThreads();
+	if( count > file.GetSize() / OBJ_MIN_CHUNK_SIZE )
+		count = file.GetSize() / OBJ_MIN_CHUNK_SIZE;
+
+	if( count <= 1 )
+		return parseOBJ(begin, end, data) && (data.corners.empty() || checkCorners(data, &data.corners[0], data.corners.size()));
+
+	// cut at the first newline after each even split point, a line running past the
+	// next split point leaves that chunk empty instead of cutting into the line
+	std::vector<OBJChunk> chunks(count);
+	const char* p = begin;
+	for( size_t i=0; i<count; i++ ){
+		chunks[i].begin = p;
+		if( i + 1 < count ){
+			const char* split = begin + file.GetSize() * (i + 1) / count;
+			if( split >= p ){
+				const char* nl = (const char*)memchr(split, '\n', end - split);
+				p = nl ? nl + 1 : end;
+			}
+		}else{
+			p = end;
+		}
+		chunks[i].end = p;
+		chunks[i].merged = &data;
+	}
+
+	if( !runChunks(parseChunk, chunks) )
+		return false;
+
+	size_t totals[4] = { 0, 0, 0, 0 };
+	for( size_t i=0; i<count; i++ ){
+		OBJData & d = chunks[i].data;
+		size_t sizes[4] = { d.vertices.size(), d.uvs.size(), d.normals.size(), d.corners.size() };
+		for( int k=0; k<4; k++ ){
+			chunks[i].offsets[k] = totals[k];
+			totals[k] += sizes[k];
+		}
+	}
+	data.vertices.resize(totals[0]);
+	data.uvs     .resize(totals[1]);
+	data.normals .resize(totals[2]);
+	data.corners .resize(totals[3]);
+
+	return runChunks(mergeChunk, chunks);
+}
+
+static inline unsigned int hashCorner(const unsigned int* c)
+{
+	return (c[0] * 73856093u) ^ (c[1] * 19349663u) ^ (c[2] * 83492791u);
+}
+
+// Gives every distinct v/vt/vn triple one output vertex, out_indices refers to them.
+// Open addressing hash, slots hold (output vertex + 1) and 0 means empty.
+template<typename Index>
+static bool buildIndexed(
+	const OBJData & data,
+	unsigned int max_vertices,
+	std::vector<Index> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	size_t count = data.corners.size() / 3;
+	size_t slots = 16;
+	while( slots < count * 2 )
+		slots <<= 1;
+	std::vector<unsigned int> table(slots, 0);
+	std::vector<const unsigned int*> unique; // first corner that produced each output vertex
+
+	size_t base = out_vertices.size();
+	out_indices.reserve(out_indices.size() + count);
+
+	for( size_t i=0; i<count; i++ ){
+		const unsigned int* corner = &data.corners[i * 3];
+		size_t slot = hashCorner(corner) & (slots - 1);
+		while( table[slot] && memcmp(unique[table[slot] - 1], corner, 3 * sizeof(unsigned int)) != 0 )
+			slot = (slot + 1) & (slots - 1);
+
+		if( !table[slot] ){
+			if( base + unique.size() >= max_vertices ){
+				printf("Model has more than %u unique vertices, too many for the index type\n", max_vertices);
+				return false;
+			}
+			unique.push_back(corner);
+			table[slot] = unique.size();
+			out_vertices.push_back(data.vertices[ corner[0] ]);
+			out_uvs     .push_back(data.uvs     [ corner[1] ]);
+			out_normals .push_back(data.normals [ corner[2] ]);
+		}
+		out_indices.push_back((Index)(base + table[slot] - 1));
+	}
+
+	printf("Indexed %u corners into %u vertices\n", (unsigned)count, (unsigned)unique.size());
+	return true;
+}
+
+// Reorders what buildIndexed just appended for the post-transform cache and then for
+// linear vertex fetch. The cache and every caller get the optimised order.
+template<typename Index>
+static void optimizeIndexed(
+	size_t first_index,
+	size_t base,
+	std::vector<Index> & indices,
+	std::vector<glm::vec3> & vertices,
+	std::vector<glm::vec2> & uvs,
+	std::vector<glm::vec3> & normals
+){
+	size_t index_count = indices.size() - first_index;
+	size_t vertex_count = vertices.size() - base;
+	if( index_count == 0 )
+		return;
+
+	Index* local = &indices[first_index];
+	for( size_t i=0; i<index_count; i++ )
+		local[i] = (Index)(local[i] - base);
+
+	VertexCacheStats before = analyzeVertexCache(local, index_count, vertex_count);
+	optimizeVertexCache(local, index_count, vertex_count);
+
+	std::vector<unsigned int> remap;
+	optimizeVertexFetch(local, index_count, vertex_count, remap);
+	std::vector<glm::vec3> old_vertices(vertices.begin() + base, vertices.end());
+	std::vector<glm::vec2> old_uvs     (uvs     .begin() + base, uvs     .end());
+	std::vector<glm::vec3> old_normals (normals .begin() + base, normals .end());
+	for( size_t v=0; v<vertex_count; v++ ){
+		vertices[base + remap[v]] = old_vertices[v];
+		uvs     [base + remap[v]] = old_uvs     [v];
+		normals [base + remap[v]] = old_normals [v];
+	}
+
+	VertexCacheStats after = analyzeVertexCache(local, index_count, vertex_count);
+	printf("Vertex cache ACMR %.3f -> %.3f\n", before.ACMR, after.ACMR);
+
+	for( size_t i=0; i<index_count; i++ )
+		local[i] = (Index)(local[i] + base);
+}
+
+// Best effort, a read only model directory just means we parse every time
+static void writeOBJCache(
+	const char * path,
+	const std::vector<unsigned short> & indices,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals
+){
+	std::string cache = meshCachePath(path);
+	if( writeMeshFile(cache.c_str(), indices, vertices, uvs, normals) )
+		printf("Wrote mesh cache %s\n", cache.c_str());
+	else
+		printf("Could not write mesh cache %s\n", cache.c_str());
+}
+
+// Maps the cache if it is up to date
+static bool openOBJCache(const char * path, MeshFile & cache)
+{
+	if( !isMeshCacheFresh(path) || !cache.Open(meshCachePath(path).c_str()) )
+		return false;
+	printf("Loading mesh cache for %s\n", path);
+	return true;
+}
+
+// Appends one vertex per index, the triangle list loadOBJ hands out. map turns an
+// index into a vertex of the arrays (a chunk's vertex table), NULL when it already is one.
+static void unrollIndexed(
+	const unsigned short * indices, size_t count, const unsigned int * map,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	for( size_t i=0; i<count; i++ ){
+		unsigned int v = map ? map[ indices[i] ] : indices[i];
+		out_vertices.push_back(vertices[v]);
+		out_uvs     .push_back(uvs     [v]);
+		out_normals .push_back(normals [v]);
+	}
+}
+
+// Same from the MeshVertex arrays of a .mesh or .chunks file
+static void unrollMeshVertices(
+	const MeshVertex * vertices, const unsigned short * indices, size_t count,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	for( size_t i=0; i<count; i++ ){
+		const MeshVertex & v = vertices[ indices[i] ];
+		out_vertices.push_back(glm::vec3(v.Position[0], v.Position[1], v.Position[2]));
+		out_uvs     .push_back(glm::vec2(v.UV[0], v.UV[1]));
+		out_normals .push_back(glm::vec3(v.Normal[0], v.Normal[1], v.Normal[2]));
+	}
+}
+
+// Unrolls the up to date .mesh or .chunks cache of path, false when there is none
+static bool loadOBJCache(
+	const char * path,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	MeshFile cache;
+	if( openOBJCache(path, cache) ){
+		unrollMeshVertices(cache.GetVertices(), cache.GetIndices(), cache.GetHeader()->IndexCount,
+			out_vertices, out_uvs, out_normals);
+		return true;
+	}
+
+	std::string chunkpath = chunkFilePath(path);
+	ChunkFile chunks;
+	if( !isCacheFresh(path, chunkpath) || !chunks.Open(chunkpath.c_str()) )
+		return false;
+	printf("Loading chunk cache for %s\n", path);
+	size_t base = out_vertices.size();
+	std::vector<unsigned char> data;
+	for( unsigned int c=0; c<chunks.GetChunkCount(); c++ ){
+		if( !chunks.ReadChunk(c, data) ){
+			// take what is left from the .obj
+			out_vertices.resize(base);
+			out_uvs     .resize(base);
+			out_normals .resize(base);
+			return false;
+		}
+		if( data.empty() )
+			continue;
+		unrollMeshVertices((const MeshVertex*)&data[0], (const unsigned short*)&data[ chunks.GetChunkVertexSize(c) ],
+			chunks.GetChunk(c).IndexCount, out_vertices, out_uvs, out_normals);
+	}
+	return true;
+}
+
+// Indexes and optimises the model, writes the cache and unrolls what was written, so
+// the triangles come out in the order a later cache hit gives them in. Models past 65535
+// vertices go into a chunk file the way objconvert makes them.
+static bool buildOBJCache(
+	const char * path,
+	const OBJData & data,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if( !buildIndexed(data, 0xFFFFFFFF, indices, vertices, uvs, normals) || indices.empty() )
+		return false;
+
+	if( vertices.size() <= 0xFFFF ){
+		std::vector<unsigned short> short_indices(indices.begin(), indices.end());
+		optimizeIndexed(0, 0, short_indices, vertices, uvs, normals);
+		writeOBJCache(path, short_indices, vertices, uvs, normals);
+		unrollIndexed(&short_indices[0], short_indices.size(), NULL, vertices, uvs, normals,
+			out_vertices, out_uvs, out_normals);
+		return true;
+	}
+
+	std::vector<MeshChunk> chunks;
+	partitionMesh(&indices[0], indices.size(), vertices, DEFAULT_CHUNK_VERTICES, chunks);
+	std::string chunkpath = chunkFilePath(path);
+	if( writeChunkFile(chunkpath.c_str(), chunks, vertices, uvs, normals) )
+		printf("Wrote chunk cache %s\n", chunkpath.c_str());
+	else
+		printf("Could not write chunk cache %s\n", chunkpath.c_str());
+	for( size_t c=0; c<chunks.size(); c++ ){
+		const MeshChunk & chunk = chunks[c];
+		if( !chunk.Indices.empty() )
+			unrollIndexed(&chunk.Indices[0], chunk.Indices.size(), &chunk.Vertices[0], vertices, uvs, normals,
+				out_vertices, out_uvs, out_normals);
+	}
+	return true;
+}
+
+bool loadOBJ(
+	const char * path,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	if( GOBJCache && loadOBJCache(path, out_vertices, out_uvs, out_normals) )
+		return true;
+
+	OBJData data;
+	if( !readOBJ(path, data) )
+		return false;
+
+	if( GOBJCache && buildOBJCache(path, data, out_vertices, out_uvs, out_normals) )
+		return true;
+
+	size_t count = data.corners.size() / 3;
+	size_t base = out_vertices.size();
+	out_vertices.resize(base + count);
+	out_uvs     .resize(base + count);
+	out_normals .resize(base + count);
+
+	// For each vertex of each triangle, put the attributes in buffers
+	const unsigned int* corner = count ? &data.corners[0] : NULL;
+	for( size_t i=0; i<count; i++, corner += 3 ){
+		out_vertices[base + i] = data.vertices[ corner[0] ];
+		out_uvs     [base + i] = data.uvs     [ corner[1] ];
+		out_normals [base + i] = data.normals [ corner[2] ];
+	}
+	return true;
+}
+
+bool loadOBJIndexed(
+	const char * path,
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	size_t base = out_vertices.size();
+	bool empty = base == 0 && out_indices.empty();
+
+	MeshFile cache;
+	if( openOBJCache(path, cache) ){
+		const MeshFileHeader* header = cache.GetHeader();
+		if( base + header->VertexCount > 0xFFFF ){
+			printf("Model has more than %u unique vertices, too many for the index type\n", 0xFFFF);
+			return false;
+		}
+		const MeshVertex* vertices = cache.GetVertices();
+		for( unsigned int i=0; i<header->VertexCount; i++ ){
+			const MeshVertex & v = vertices[i];
+			out_vertices.push_back(glm::vec3(v.Position[0], v.Position[1], v.Position[2]));
+			out_uvs     .push_back(glm::vec2(v.UV[0], v.UV[1]));
+			out_normals .push_back(glm::vec3(v.Normal[0], v.Normal[1], v.Normal[2]));
+		}
+		const unsigned short* indices = cache.GetIndices();
+		out_indices.reserve(out_indices.size() + header->IndexCount);
+		for( unsigned int i=0; i<header->IndexCount; i++ )
+			out_indices.push_back((unsigned short)(base + indices[i]));
+		return true;
+	}
+
+	OBJData data;
+	if( !readOBJ(path, data) )
+		return false;
+
+	// 0xFFFF is left alone, some drivers treat it as a restart index
+	size_t first_index = out_indices.size();
+	if( !buildIndexed(data, 0xFFFF, out_indices, out_vertices, out_uvs, out_normals) )
+		return false;
+	optimizeIndexed(first_index, base, out_indices, out_vertices, out_uvs, out_normals);
+
+	// only cache what came out of this file alone
+	if( empty )
+		writeOBJCache(path, out_indices, out_vertices, out_uvs, out_normals);
+	return true;
+}
+
+bool loadOBJIndexed(
+	const char * path,
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	OBJData data;
+	if( !readOBJ(path, data) )
+		return false;
+
+	// no cache reordering here, partitionMesh sorts the triangles and optimises each chunk
+	return buildIndexed(data, 0xFFFFFFFF, out_indices, out_vertices, out_uvs, out_normals);
+}
@@ -8,4 +8,33 @@ bool loadOBJ(
 	std::vector<glm::vec3> & out_normals
 );
 
+// Threads used to parse big files, 0 (the default) means one per core
+void setOBJLoaderThreads(int count);
+
+// With this on, loadOBJ reads the model's .mesh cache, or its .chunks file past 65535
+// vertices, and writes it when it is missing or older than the .obj. The triangles then
+// come out in the cache's optimised order, on the first load as well as later ones.
+// Off by default, the first load would otherwise pay for indexing and writing the cache.
+void setOBJCache(bool enabled);
+
+// Same as loadOBJ but every distinct v/vt/vn combination is stored once,
+// draw with glDrawElements(GL_TRIANGLES, out_indices.size(), GL_UNSIGNED_SHORT, 0)
+bool loadOBJIndexed(
+	const char * path,
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+);
+
+// 32 bit indices for models past 65535 vertices. GLES2 can't draw these directly,
+// split them with partitionMesh (meshpartition.h). Not cached, indices in file order.
+bool loadOBJIndexed(
+	const char * path,
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+);
+
 #endif
@@ -0,0 +1,175 @@
+#include <string.h>
+#include <vector>
+
+#include "pixelconvert.h"
+#include "pixelconvert_simd.h"
+
+// PIXELS_NEON and PIXELS_SSSE3 come from common/CMakeLists.txt when it builds the kernels
+#if PIXELS_NEON && !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+enum PixelBackend
+{
+	BACKEND_SCALAR,
+	BACKEND_NEON,
+	BACKEND_SSSE3,
+};
+
+static PixelBackend detectBackend()
+{
+#if PIXELS_NEON && defined(__aarch64__)
+	return BACKEND_NEON;
+#elif PIXELS_NEON
+	// a Pi 1 or Zero is ARMv6 and has no NEON
+	return (getauxval(AT_HWCAP) & HWCAP_NEON) ? BACKEND_NEON : BACKEND_SCALAR;
+#elif PIXELS_SSSE3
+	return __builtin_cpu_supports("ssse3") ? BACKEND_SSSE3 : BACKEND_SCALAR;
+#else
+	return BACKEND_SCALAR;
+#endif
+}
+
+// Asked once, every thread gets the same answer so racing on it is harmless
+static PixelBackend pixelBackend()
+{
+	static int backend = -1;
+	if(backend < 0)
+		backend = detectBackend();
+	return (PixelBackend)backend;
+}
+
+int pixelLayoutSize(PixelLayout layout)
+{
+	return layout == PIXELS_RGBA ? 4 : 3;
+}
+
+void convertBGRToRGB_scalar(const unsigned char* src, unsigned char* dst, size_t pixels)
+{
+	for(size_t i = 0; i < pixels; i++, src += 3, dst += 3)
+	{
+		unsigned char b = src[0], g = src[1], r = src[2];
+		dst[0] = r;
+		dst[1] = g;
+		dst[2] = b;
+	}
+}
+
+void convertRGBToRGBA_scalar(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha)
+{
+	for(size_t i = 0; i < pixels; i++, src += 3, dst += 4)
+	{
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst[3] = alpha;
+	}
+}
+
+void convertBGRToRGBA_scalar(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha)
+{
+	for(size_t i = 0; i < pixels; i++, src += 3, dst += 4)
+	{
+		dst[0] = src[2];
+		dst[1] = src[1];
+		dst[2] = src[0];
+		dst[3] = alpha;
+	}
+}
+
+void convertRGBAToRGB565_scalar(const unsigned char* src, unsigned short* dst, size_t pixels)
+{
+	for(size_t i = 0; i < pixels; i++, src += 4)
+		dst[i] = (unsigned short)(((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3));
+}
+
+// The SIMD versions do whole blocks and leave the tail to the scalar ones
+
+void convertBGRToRGB(const unsigned char* src, unsigned char* dst, size_t pixels)
+{
+	size_t i = 0;
+#if PIXELS_NEON
+	if(pixelBackend() == BACKEND_NEON)
+		i = convertBGRToRGB_neon(src, dst, pixels);
+#elif PIXELS_SSSE3
+	if(pixelBackend() == BACKEND_SSSE3)
+		i = convertBGRToRGB_ssse3(src, dst, pixels);
+#endif
+	convertBGRToRGB_scalar(src + i * 3, dst + i * 3, pixels - i);
+}
+
+static void toRGBA(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha, bool swap_rb)
+{
+	size_t i = 0;
+#if PIXELS_NEON
+	if(pixelBackend() == BACKEND_NEON)
+		i = convertToRGBA_neon(src, dst, pixels, alpha, swap_rb);
+#elif PIXELS_SSSE3
+	if(pixelBackend() == BACKEND_SSSE3)
+		i = convertToRGBA_ssse3(src, dst, pixels, alpha, swap_rb);
+#endif
+	if(swap_rb)
+		convertBGRToRGBA_scalar(src + i * 3, dst + i * 4, pixels - i, alpha);
+	else
+		convertRGBToRGBA_scalar(src + i * 3, dst + i * 4, pixels - i, alpha);
+}
+
+void convertRGBToRGBA(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha)
+{
+	toRGBA(src, dst, pixels, alpha, false);
+}
+
+void convertBGRToRGBA(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha)
+{
+	toRGBA(src, dst, pixels, alpha, true);
+}
+
+// No x86 version, the compiler already vectorises the scalar loop and a hand written
+// SSE2 one came out slower
+void convertRGBAToRGB565(const unsigned char* src, unsigned short* dst, size_t pixels)
+{
+	size_t i = 0;
+#if PIXELS_NEON
+	if(pixelBackend() == BACKEND_NEON)
+		i = convertRGBAToRGB565_neon(src, dst, pixels);
+#endif
+	convertRGBAToRGB565_scalar(src + i * 4, dst + i, pixels - i);
+}
+
+void flipRows(void* data, size_t row_bytes, size_t rows)
+{
+	// memcpy is already as wide as the machine goes
+	std::vector<unsigned char> tmp(row_bytes);
+	unsigned char* top = (unsigned char*)data;
+	unsigned char* bottom = top + (rows ? rows - 1 : 0) * row_bytes;
+	for(; top < bottom; top += row_bytes, bottom -= row_bytes)
+	{
+		memcpy(&tmp[0], top, row_bytes);
+		memcpy(top, bottom, row_bytes);
+		memcpy(bottom, &tmp[0], row_bytes);
+	}
+}
+
+void convertToRGBA(const void* src, PixelLayout layout, unsigned char* dst, int width, int height, bool flip)
+{
+	size_t pixels = (size_t)width * height;
+	switch(layout)
+	{
+	case PIXELS_RGB: convertRGBToRGBA((const unsigned char*)src, dst, pixels); break;
+	case PIXELS_BGR: convertBGRToRGBA((const unsigned char*)src, dst, pixels); break;
+	default:         memmove(dst, src, pixels * 4); break;
+	}
+	if(flip)
+		flipRows(dst, (size_t)width * 4, height);
+}
+
+const char* pixelConvertBackend()
+{
+	switch(pixelBackend())
+	{
+	case BACKEND_NEON:  return "NEON";
+	case BACKEND_SSSE3: return "SSSE3";
+	default:            return "scalar";
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+
+// Pixel layout conversions between what image files and cameras hand us and what GLES2
+// takes (it has no GL_BGR). Each kernel has a NEON (ARM) or SSSE3 (x86) version besides the
+// scalar one, the first call asks the CPU which it can run, so one ARM build works on a Pi 1
+// without NEON as well as on the later ones. The scalar versions stay callable as *_scalar
+// for checking and benchmarking.
+//
+// Pixels are tightly packed bytes in memory order: RGB is r,g,b; RGBA is r,g,b,a.
+
+enum PixelLayout
+{
+	PIXELS_RGBA,
+	PIXELS_RGB,
+	PIXELS_BGR,
+};
+
+int pixelLayoutSize(PixelLayout layout);
+
+// Swaps the first and third byte of every pixel, src and dst may be the same buffer
+void convertBGRToRGB(const unsigned char* src, unsigned char* dst, size_t pixels);
+// Adds an alpha byte, src and dst must not overlap
+void convertRGBToRGBA(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha = 255);
+void convertBGRToRGBA(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha = 255);
+// Truncates to GL_UNSIGNED_SHORT_5_6_5 (red in the top bits), alpha is dropped.
+// dst may be src itself, the output is half the size and never overtakes the input
+void convertRGBAToRGB565(const unsigned char* src, unsigned short* dst, size_t pixels);
+// Reverses the order of rows in place, for bottom-up images (BMP) and glReadPixels output
+void flipRows(void* data, size_t row_bytes, size_t rows);
+
+// Any layout above to RGBA in dst, optionally flipping rows on the way
+void convertToRGBA(const void* src, PixelLayout layout, unsigned char* dst, int width, int height, bool flip);
+
+// Which versions run on this CPU: "NEON", "SSSE3" or "scalar"
+const char* pixelConvertBackend();
+
+void convertBGRToRGB_scalar(const unsigned char* src, unsigned char* dst, size_t pixels);
+void convertRGBToRGBA_scalar(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha);
+void convertBGRToRGBA_scalar(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha);
+void convertRGBAToRGB565_scalar(const unsigned char* src, unsigned short* dst, size_t pixels);
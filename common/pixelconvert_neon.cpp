@@ -0,0 +1,54 @@
+// Built with -mfpu=neon on 32 bit ARM, see common/CMakeLists.txt
+#include <arm_neon.h>
+
+#include "pixelconvert_simd.h"
+
+size_t convertBGRToRGB_neon(const unsigned char* src, unsigned char* dst, size_t pixels)
+{
+	size_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		uint8x16x3_t v = vld3q_u8(src + i * 3);
+		uint8x16_t t = v.val[0];
+		v.val[0] = v.val[2];
+		v.val[2] = t;
+		vst3q_u8(dst + i * 3, v);
+	}
+	return i;
+}
+
+size_t convertToRGBA_neon(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha, bool swap_rb)
+{
+	size_t i = 0;
+	uint8x16_t a = vdupq_n_u8(alpha);
+	for(; i + 16 <= pixels; i += 16)
+	{
+		uint8x16x3_t v = vld3q_u8(src + i * 3);
+		uint8x16x4_t out;
+		out.val[0] = swap_rb ? v.val[2] : v.val[0];
+		out.val[1] = v.val[1];
+		out.val[2] = swap_rb ? v.val[0] : v.val[2];
+		out.val[3] = a;
+		vst4q_u8(dst + i * 4, out);
+	}
+	return i;
+}
+
+size_t convertRGBAToRGB565_neon(const unsigned char* src, unsigned short* dst, size_t pixels)
+{
+	size_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		uint8x16x4_t v = vld4q_u8(src + i * 4);
+		// widen each channel into the top byte, then shift-insert green and blue below red
+		uint16x8_t lo = vshll_n_u8(vget_low_u8(v.val[0]), 8);
+		lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(v.val[1]), 8), 5);
+		lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(v.val[2]), 8), 11);
+		uint16x8_t hi = vshll_n_u8(vget_high_u8(v.val[0]), 8);
+		hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(v.val[1]), 8), 5);
+		hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(v.val[2]), 8), 11);
+		vst1q_u16(dst + i, lo);
+		vst1q_u16(dst + i + 8, hi);
+	}
+	return i;
+}
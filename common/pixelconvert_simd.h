@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+
+// The SIMD kernels behind pixelconvert.h. Each set lives in its own file, built with the
+// flags it needs (common/CMakeLists.txt), and pixelconvert.cpp only calls it once the CPU
+// has said it has the instructions. They do whole blocks and return how many pixels they
+// did, the scalar versions do the rest.
+
+size_t convertBGRToRGB_neon(const unsigned char* src, unsigned char* dst, size_t pixels);
+size_t convertToRGBA_neon(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha, bool swap_rb);
+size_t convertRGBAToRGB565_neon(const unsigned char* src, unsigned short* dst, size_t pixels);
+
+size_t convertBGRToRGB_ssse3(const unsigned char* src, unsigned char* dst, size_t pixels);
+size_t convertToRGBA_ssse3(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha, bool swap_rb);
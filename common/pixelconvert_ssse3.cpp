@@ -0,0 +1,34 @@
+// Built with -mssse3 on x86, see common/CMakeLists.txt
+#include <tmmintrin.h>
+
+#include "pixelconvert_simd.h"
+
+size_t convertBGRToRGB_ssse3(const unsigned char* src, unsigned char* dst, size_t pixels)
+{
+	size_t i = 0;
+	// 5 pixels per 16 byte load, the 16th byte is written back unchanged
+	// so working in place is still fine
+	const __m128i swap = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+	for(; (i + 5) * 3 + 1 <= pixels * 3; i += 5)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+		_mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(v, swap));
+	}
+	return i;
+}
+
+size_t convertToRGBA_ssse3(const unsigned char* src, unsigned char* dst, size_t pixels, unsigned char alpha, bool swap_rb)
+{
+	size_t i = 0;
+	// 4 pixels from each 16 byte load, the last 4 bytes read are the next pixels
+	const __m128i shuffle = swap_rb ?
+		_mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+		_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i a = _mm_set1_epi32((int)((unsigned int)alpha << 24));
+	for(; i * 3 + 16 <= pixels * 3; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), a));
+	}
+	return i;
+}
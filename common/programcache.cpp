@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <vector>
+
+#include "programcache.h"
+#include "EGL/egl.h"
+#include "GLES2/gl2ext.h"
+
+ProgramCache GProgramCache;
+
+static PFNGLGETPROGRAMBINARYOESPROC GGetProgramBinary;
+static PFNGLPROGRAMBINARYOESPROC GProgramBinary;
+
+static const char GMagic[4] = { 'P', 'G', 'M', 'B' };
+
+struct ProgramFileHeader
+{
+	char Magic[4];
+	unsigned int Format;
+	unsigned int Length;
+};
+
+// FNV-1a, a different driver build must not load the binary another one wrote
+static unsigned long long hashString(unsigned long long hash, const char* s)
+{
+	if(!s)
+		s = "";
+	for(; *s; s++)
+	{
+		hash ^= (unsigned char)*s;
+		hash *= 1099511628211ULL;
+	}
+	// a separator so "ab" + "c" and "a" + "bc" differ
+	hash ^= 0xff;
+	hash *= 1099511628211ULL;
+	return hash;
+}
+
+ProgramCache::ProgramCache()
+	: Directory("shadercache"), Supported(-1), Hits(0), Misses(0), Rejected(0), Saved(0)
+{
+}
+
+bool ProgramCache::IsSupported()
+{
+	if(Supported >= 0)
+		return Supported != 0;
+
+	Supported = 0;
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	if(!extensions || !strstr(extensions, "GL_OES_get_program_binary"))
+		return false;
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+	GGetProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+	GProgramBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+	Supported = formats > 0 && GGetProgramBinary && GProgramBinary;
+	return Supported != 0;
+}
+
+std::string ProgramCache::PathFor(unsigned long long key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.bin", key);
+	return Directory + name;
+}
+
+unsigned long long ProgramCache::Key(const char* vertex_source, const char* fragment_source)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+	hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+	hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+	hash = hashString(hash, vertex_source);
+	hash = hashString(hash, fragment_source);
+	return hash;
+}
+
+GLuint ProgramCache::Load(unsigned long long key)
+{
+	if(Directory.empty() || !IsSupported())
+	{
+		Misses++;
+		return 0;
+	}
+
+	std::string path = PathFor(key);
+	FILE* f = fopen(path.c_str(), "rb");
+	if(!f)
+	{
+		Misses++;
+		return 0;
+	}
+	ProgramFileHeader header;
+	std::vector<unsigned char> binary;
+	bool ok = fread(&header, sizeof(header), 1, f) == 1 && memcmp(header.Magic, GMagic, 4) == 0
+		&& header.Length && header.Length < (64u << 20);
+	if(ok)
+	{
+		binary.resize(header.Length);
+		ok = fread(&binary[0], 1, binary.size(), f) == binary.size();
+	}
+	fclose(f);
+
+	GLuint program = 0;
+	GLint linked = 0;
+	if(ok)
+	{
+		program = glCreateProgram();
+		GProgramBinary(program, header.Format, &binary[0], header.Length);
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	}
+	if(!linked)
+	{
+		// a driver update can invalidate a binary the key didn't catch, rebuild it
+		printf("Program binary %s was not accepted, compiling\n", path.c_str());
+		if(program)
+			glDeleteProgram(program);
+		// clear whatever error the refused binary left for the caller's check()
+		while(glGetError() != GL_NO_ERROR)
+			;
+		remove(path.c_str());
+		Rejected++;
+		Misses++;
+		return 0;
+	}
+	Hits++;
+	return program;
+}
+
+void ProgramCache::Save(unsigned long long key, GLuint program)
+{
+	if(Directory.empty() || !IsSupported())
+		return;
+	GLint linked = 0, length = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+	if(!linked || length <= 0)
+		return;
+
+	ProgramFileHeader header;
+	memcpy(header.Magic, GMagic, 4);
+	std::vector<unsigned char> binary(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	GGetProgramBinary(program, length, &written, &format, &binary[0]);
+	if(written <= 0)
+		return;
+	header.Format = format;
+	header.Length = written;
+
+	// written under another name first, a run killed half way leaves no broken binary
+	mkdir(Directory.c_str(), 0755);
+	std::string path = PathFor(key);
+	std::string temp = path + ".tmp";
+	FILE* f = fopen(temp.c_str(), "wb");
+	if(!f)
+	{
+		printf("Could not write %s\n", temp.c_str());
+		return;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(&binary[0], 1, written, f) == (size_t)written;
+	ok = fclose(f) == 0 && ok;
+	if(ok && rename(temp.c_str(), path.c_str()) == 0)
+		Saved++;
+	else
+		remove(temp.c_str());
+}
+
+void ProgramCache::Remove(unsigned long long key)
+{
+	if(!Directory.empty())
+		remove(PathFor(key).c_str());
+}
+
+void ProgramCache::PrintStats(const char* label)
+{
+	printf("%s: program binaries %s, %llu hits, %llu misses (%llu rejected), %llu saved\n", label,
+		Supported < 0 ? "not checked yet" : Supported ? "supported" : "not supported",
+		Hits, Misses, Rejected, Saved);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+#include "GLES2/gl2.h"
+
+// Linked program binaries kept on disk through GL_OES_get_program_binary, so a later run
+// skips compiling and linking. The key is a hash of both shader sources and the driver's
+// vendor, renderer and version strings, a driver update or an edited shader misses.
+// Without the extension (or with no binary formats) every Load misses and Save does
+// nothing, the caller compiles as usual. A file the driver refuses is deleted.
+class ProgramCache
+{
+	std::string Directory;
+	int Supported;          // -1 until the extension has been checked
+
+	bool IsSupported();
+	std::string PathFor(unsigned long long key);
+
+public:
+
+	unsigned long long Hits;
+	unsigned long long Misses;
+	unsigned long long Rejected;   // files the driver didn't take, counted in Misses too
+	unsigned long long Saved;
+
+	ProgramCache();
+
+	// "" turns the cache off, the default is "shadercache" in the working directory
+	void SetDirectory(const char* directory) { Directory = directory; }
+
+	unsigned long long Key(const char* vertex_source, const char* fragment_source);
+	// A linked program, 0 when it has to be built from source
+	GLuint Load(unsigned long long key);
+	// Keeps a successfully linked program for the next run
+	void Save(unsigned long long key, GLuint program);
+	// Deletes the saved binary, the next Load misses
+	void Remove(unsigned long long key);
+
+	void PrintStats(const char* label);
+};
+
+extern ProgramCache GProgramCache;
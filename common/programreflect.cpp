@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "programreflect.h"
+
+// "lights[0]" is reported for an array, the name it is looked up by is "lights"
+static void copyName(const char* name, char* out)
+{
+	strncpy(out, name, MAX_PROGRAM_NAME - 1);
+	out[MAX_PROGRAM_NAME - 1] = 0;
+	char* bracket = strchr(out, '[');
+	if(bracket)
+		*bracket = 0;
+}
+
+void ProgramReflection::Reflect(GLuint program)
+{
+	NumUniforms = 0;
+	NumAttribs = 0;
+
+	GLint count = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	if(count > MAX_PROGRAM_UNIFORMS)
+		printf("Program %d has %d uniforms, only the first %d are reflected\n", program, count, MAX_PROGRAM_UNIFORMS);
+	for(GLint i = 0; i < count && NumUniforms < MAX_PROGRAM_UNIFORMS; i++)
+	{
+		char name[256];
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(program, i, sizeof(name), NULL, &size, &type, name);
+		ProgramUniform& u = Uniforms[NumUniforms];
+		u.Location = glGetUniformLocation(program, name);
+		if(u.Location < 0)
+			continue;
+		copyName(name, u.Name);
+		u.Type = type;
+		u.Size = size;
+		u.Known = false;
+		NumUniforms++;
+	}
+
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+	if(count > MAX_PROGRAM_ATTRIBS)
+		printf("Program %d has %d attributes, only the first %d are reflected\n", program, count, MAX_PROGRAM_ATTRIBS);
+	for(GLint i = 0; i < count && NumAttribs < MAX_PROGRAM_ATTRIBS; i++)
+	{
+		char name[256];
+		GLint size;
+		GLenum type;
+		glGetActiveAttrib(program, i, sizeof(name), NULL, &size, &type, name);
+		ProgramAttrib& a = Attribs[NumAttribs];
+		a.Location = glGetAttribLocation(program, name);
+		if(a.Location < 0)
+			continue;
+		copyName(name, a.Name);
+		a.Type = type;
+		NumAttribs++;
+	}
+}
+
+int ProgramReflection::FindUniform(const char* name) const
+{
+	for(int i = 0; i < NumUniforms; i++)
+		if(strcmp(Uniforms[i].Name, name) == 0)
+			return i;
+	return -1;
+}
+
+GLint ProgramReflection::FindAttrib(const char* name) const
+{
+	for(int i = 0; i < NumAttribs; i++)
+		if(strcmp(Attribs[i].Name, name) == 0)
+			return Attribs[i].Location;
+	return -1;
+}
+
+bool ProgramReflection::Changed(int uniform, const void* value, size_t bytes)
+{
+	ProgramUniform& u = Uniforms[uniform];
+	if(u.Size == 1 && u.Known && memcmp(u.Value, value, bytes) == 0)
+	{
+		Skipped++;
+		return false;
+	}
+	memcpy(u.Value, value, bytes);
+	u.Known = u.Size == 1;
+	Uploads++;
+	return true;
+}
+
+void ProgramReflection::SetInt(int uniform, GLint value)
+{
+	if(uniform >= 0 && Changed(uniform, &value, sizeof(value)))
+		glUniform1i(Uniforms[uniform].Location, value);
+}
+
+void ProgramReflection::SetFloat(int uniform, GLfloat value)
+{
+	if(uniform >= 0 && Changed(uniform, &value, sizeof(value)))
+		glUniform1f(Uniforms[uniform].Location, value);
+}
+
+void ProgramReflection::SetVec2(int uniform, GLfloat x, GLfloat y)
+{
+	GLfloat v[2] = { x, y };
+	if(uniform >= 0 && Changed(uniform, v, sizeof(v)))
+		glUniform2fv(Uniforms[uniform].Location, 1, v);
+}
+
+void ProgramReflection::SetVec3(int uniform, GLfloat x, GLfloat y, GLfloat z)
+{
+	GLfloat v[3] = { x, y, z };
+	if(uniform >= 0 && Changed(uniform, v, sizeof(v)))
+		glUniform3fv(Uniforms[uniform].Location, 1, v);
+}
+
+void ProgramReflection::SetVec4(int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+	GLfloat v[4] = { x, y, z, w };
+	if(uniform >= 0 && Changed(uniform, v, sizeof(v)))
+		glUniform4fv(Uniforms[uniform].Location, 1, v);
+}
+
+void ProgramReflection::SetMat3(int uniform, const GLfloat* m)
+{
+	if(uniform >= 0 && Changed(uniform, m, 9 * sizeof(GLfloat)))
+		glUniformMatrix3fv(Uniforms[uniform].Location, 1, GL_FALSE, m);
+}
+
+void ProgramReflection::SetMat4(int uniform, const GLfloat* m)
+{
+	if(uniform >= 0 && Changed(uniform, m, 16 * sizeof(GLfloat)))
+		glUniformMatrix4fv(Uniforms[uniform].Location, 1, GL_FALSE, m);
+}
+
+void ProgramReflection::Forget()
+{
+	for(int i = 0; i < NumUniforms; i++)
+		Uniforms[i].Known = false;
+}
+
+void ProgramReflection::Print(const char* label) const
+{
+	printf("%s: %d uniforms, %d attributes, %llu uploads, %llu skipped\n", label, NumUniforms, NumAttribs, Uploads, Skipped);
+	for(int i = 0; i < NumUniforms; i++)
+		printf("  uniform %-24s location %2d type 0x%04x size %d\n", Uniforms[i].Name, Uniforms[i].Location, Uniforms[i].Type, Uniforms[i].Size);
+	for(int i = 0; i < NumAttribs; i++)
+		printf("  attrib  %-24s location %2d type 0x%04x\n", Attribs[i].Name, Attribs[i].Location, Attribs[i].Type);
+}
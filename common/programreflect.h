@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "GLES2/gl2.h"
+
+#define MAX_PROGRAM_UNIFORMS 16
+#define MAX_PROGRAM_ATTRIBS 8
+#define MAX_PROGRAM_NAME 32
+
+struct ProgramUniform
+{
+	char Name[MAX_PROGRAM_NAME];   // without the "[0]" of arrays
+	GLint Location;
+	GLenum Type;
+	GLint Size;                     // array length
+	bool Known;                     // Value holds what was uploaded last
+	unsigned char Value[16 * sizeof(GLfloat)];
+};
+
+struct ProgramAttrib
+{
+	char Name[MAX_PROGRAM_NAME];
+	GLint Location;
+	GLenum Type;
+};
+
+// The active uniforms and attributes of a linked program, enumerated once so draws don't
+// go through glGetUniformLocation / glGetAttribLocation, which are string lookups in the
+// driver. Uniforms are referred to by their index in the table (FindUniform), -1 for one
+// the program doesn't have, which the setters ignore like GL does location -1.
+//
+// The setters remember what they uploaded and skip a value the program already holds.
+// Uniform values belong to the program, so the program must be current when a setter is
+// called, the same as for glUniform*. Arrays are always uploaded.
+class ProgramReflection
+{
+	ProgramUniform Uniforms[MAX_PROGRAM_UNIFORMS];
+	ProgramAttrib Attribs[MAX_PROGRAM_ATTRIBS];
+	int NumUniforms;
+	int NumAttribs;
+
+	// true when the value differs from the last upload, and remembers it
+	bool Changed(int uniform, const void* value, size_t bytes);
+
+public:
+
+	unsigned long long Uploads;
+	unsigned long long Skipped;
+
+	ProgramReflection() : NumUniforms(0), NumAttribs(0), Uploads(0), Skipped(0) {}
+
+	// Call after a successful link, and again after a relink
+	void Reflect(GLuint program);
+
+	int FindUniform(const char* name) const;
+	// The attribute location, -1 when the program doesn't use it
+	GLint FindAttrib(const char* name) const;
+
+	void SetInt(int uniform, GLint value);
+	void SetFloat(int uniform, GLfloat value);
+	void SetVec2(int uniform, GLfloat x, GLfloat y);
+	void SetVec3(int uniform, GLfloat x, GLfloat y, GLfloat z);
+	void SetVec4(int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+	// column major, like glm's &m[0][0]
+	void SetMat3(int uniform, const GLfloat* m);
+	void SetMat4(int uniform, const GLfloat* m);
+	// Next set of each uniform uploads, for when something else changed them
+	void Forget();
+
+	int GetNumUniforms() const { return NumUniforms; }
+	const ProgramUniform& GetUniform(int i) const { return Uniforms[i]; }
+	int GetNumAttribs() const { return NumAttribs; }
+	const ProgramAttrib& GetAttrib(int i) const { return Attribs[i]; }
+
+	void Print(const char* label) const;
+};
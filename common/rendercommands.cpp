@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "rendercommands.h"
+#include "programreflect.h"
+#include "vertexlayout.h"
+#include "glstate.h"
+
+enum CommandType
+{
+	COMMAND_USE_PROGRAM,
+	COMMAND_BIND_TEXTURE,
+	COMMAND_BIND_BUFFER,
+	COMMAND_ENABLE_LAYOUT,
+	COMMAND_ENABLE,
+	COMMAND_DISABLE,
+	COMMAND_BLEND_FUNC,
+	COMMAND_DEPTH_FUNC,
+	COMMAND_VIEWPORT,
+	COMMAND_CLEAR,
+	COMMAND_UNIFORM,
+	COMMAND_DRAW_ARRAYS,
+	COMMAND_DRAW_ELEMENTS
+};
+
+enum UniformKind
+{
+	UNIFORM_INT,
+	UNIFORM_FLOAT,
+	UNIFORM_VEC2,
+	UNIFORM_VEC3,
+	UNIFORM_VEC4,
+	UNIFORM_MAT3,
+	UNIFORM_MAT4
+};
+
+// Every command starts with this, Size takes the reader to the next one
+struct CommandHeader
+{
+	unsigned short Type;
+	unsigned short Size;
+};
+
+// Commands start on this boundary so the pointers in them are aligned
+static const size_t GCommandAlign = 8;
+
+struct NameCommand                // UseProgram, Enable, Disable, DepthFunc, Clear
+{
+	CommandHeader Header;
+	GLuint Value;
+};
+
+struct BindCommand                // BindTexture, BindBuffer
+{
+	CommandHeader Header;
+	GLenum Unit;
+	GLenum Target;
+	GLuint Name;
+};
+
+struct LayoutCommand
+{
+	CommandHeader Header;
+	GLuint Buffer;
+	VertexLayout* Layout;
+};
+
+struct PairCommand                // BlendFunc
+{
+	CommandHeader Header;
+	GLenum First, Second;
+};
+
+struct ViewportCommand
+{
+	CommandHeader Header;
+	GLint Rect[4];
+};
+
+// Recorded with only as many of Values as the kind needs
+struct UniformCommand
+{
+	CommandHeader Header;
+	int Kind;
+	int Uniform;
+	ProgramReflection* Program;
+	GLfloat Values[16];
+};
+
+struct DrawCommand
+{
+	CommandHeader Header;
+	GLenum Mode;
+	GLenum Type;               // DrawElements only
+	GLint First;               // DrawArrays only
+	GLsizei Count;
+	size_t Offset;             // DrawElements only
+};
+
+CommandBuffer::CommandBuffer(size_t bytes)
+	: Arena(bytes), Used(0), Count(0), Grows(0)
+{
+}
+
+void* CommandBuffer::Record(unsigned short type, size_t bytes)
+{
+	bytes = (bytes + GCommandAlign - 1) & ~(GCommandAlign - 1);
+	if(Used + bytes > Arena.size())
+	{
+		size_t grown = Arena.size() * 2;
+		Arena.resize(grown > Used + bytes ? grown : Used + bytes);
+		Grows++;
+	}
+	CommandHeader* header = (CommandHeader*)&Arena[Used];
+	header->Type = type;
+	header->Size = (unsigned short)bytes;
+	Used += bytes;
+	Count++;
+	return header;
+}
+
+void CommandBuffer::UseProgram(GLuint program)
+{
+	NameCommand* c = (NameCommand*)Record(COMMAND_USE_PROGRAM, sizeof(NameCommand));
+	c->Value = program;
+}
+
+void CommandBuffer::BindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+	BindCommand* c = (BindCommand*)Record(COMMAND_BIND_TEXTURE, sizeof(BindCommand));
+	c->Unit = unit;
+	c->Target = target;
+	c->Name = texture;
+}
+
+void CommandBuffer::BindBuffer(GLenum target, GLuint buffer)
+{
+	BindCommand* c = (BindCommand*)Record(COMMAND_BIND_BUFFER, sizeof(BindCommand));
+	c->Unit = 0;
+	c->Target = target;
+	c->Name = buffer;
+}
+
+void CommandBuffer::EnableLayout(VertexLayout* layout, GLuint buffer)
+{
+	LayoutCommand* c = (LayoutCommand*)Record(COMMAND_ENABLE_LAYOUT, sizeof(LayoutCommand));
+	c->Layout = layout;
+	c->Buffer = buffer;
+}
+
+void CommandBuffer::Enable(GLenum cap)
+{
+	NameCommand* c = (NameCommand*)Record(COMMAND_ENABLE, sizeof(NameCommand));
+	c->Value = cap;
+}
+
+void CommandBuffer::Disable(GLenum cap)
+{
+	NameCommand* c = (NameCommand*)Record(COMMAND_DISABLE, sizeof(NameCommand));
+	c->Value = cap;
+}
+
+void CommandBuffer::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	PairCommand* c = (PairCommand*)Record(COMMAND_BLEND_FUNC, sizeof(PairCommand));
+	c->First = sfactor;
+	c->Second = dfactor;
+}
+
+void CommandBuffer::DepthFunc(GLenum func)
+{
+	NameCommand* c = (NameCommand*)Record(COMMAND_DEPTH_FUNC, sizeof(NameCommand));
+	c->Value = func;
+}
+
+void CommandBuffer::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	ViewportCommand* c = (ViewportCommand*)Record(COMMAND_VIEWPORT, sizeof(ViewportCommand));
+	c->Rect[0] = x;
+	c->Rect[1] = y;
+	c->Rect[2] = width;
+	c->Rect[3] = height;
+}
+
+void CommandBuffer::Clear(GLbitfield mask)
+{
+	NameCommand* c = (NameCommand*)Record(COMMAND_CLEAR, sizeof(NameCommand));
+	c->Value = mask;
+}
+
+void CommandBuffer::RecordUniform(ProgramReflection* program, int uniform, int kind, const GLfloat* values, int count)
+{
+	if(uniform < 0)
+		return;
+	UniformCommand* c = (UniformCommand*)Record(COMMAND_UNIFORM, offsetof(UniformCommand, Values) + count * sizeof(GLfloat));
+	c->Kind = kind;
+	c->Uniform = uniform;
+	c->Program = program;
+	memcpy(c->Values, values, count * sizeof(GLfloat));
+}
+
+void CommandBuffer::SetInt(ProgramReflection* program, int uniform, GLint value)
+{
+	// the bits go through as they are, Execute reads them back as an int
+	GLfloat bits;
+	memcpy(&bits, &value, sizeof(bits));
+	RecordUniform(program, uniform, UNIFORM_INT, &bits, 1);
+}
+
+void CommandBuffer::SetFloat(ProgramReflection* program, int uniform, GLfloat value)
+{
+	RecordUniform(program, uniform, UNIFORM_FLOAT, &value, 1);
+}
+
+void CommandBuffer::SetVec2(ProgramReflection* program, int uniform, GLfloat x, GLfloat y)
+{
+	GLfloat v[2] = { x, y };
+	RecordUniform(program, uniform, UNIFORM_VEC2, v, 2);
+}
+
+void CommandBuffer::SetVec3(ProgramReflection* program, int uniform, GLfloat x, GLfloat y, GLfloat z)
+{
+	GLfloat v[3] = { x, y, z };
+	RecordUniform(program, uniform, UNIFORM_VEC3, v, 3);
+}
+
+void CommandBuffer::SetVec4(ProgramReflection* program, int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+	GLfloat v[4] = { x, y, z, w };
+	RecordUniform(program, uniform, UNIFORM_VEC4, v, 4);
+}
+
+void CommandBuffer::SetMat3(ProgramReflection* program, int uniform, const GLfloat* m)
+{
+	RecordUniform(program, uniform, UNIFORM_MAT3, m, 9);
+}
+
+void CommandBuffer::SetMat4(ProgramReflection* program, int uniform, const GLfloat* m)
+{
+	RecordUniform(program, uniform, UNIFORM_MAT4, m, 16);
+}
+
+void CommandBuffer::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	DrawCommand* c = (DrawCommand*)Record(COMMAND_DRAW_ARRAYS, sizeof(DrawCommand));
+	c->Mode = mode;
+	c->First = first;
+	c->Count = count;
+}
+
+void CommandBuffer::DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset)
+{
+	DrawCommand* c = (DrawCommand*)Record(COMMAND_DRAW_ELEMENTS, sizeof(DrawCommand));
+	c->Mode = mode;
+	c->Type = type;
+	c->Count = count;
+	c->Offset = offset;
+}
+
+static void executeUniform(const UniformCommand* c)
+{
+	const GLfloat* v = c->Values;
+	switch(c->Kind)
+	{
+	case UNIFORM_INT:
+	{
+		GLint value;
+		memcpy(&value, v, sizeof(value));
+		c->Program->SetInt(c->Uniform, value);
+		break;
+	}
+	case UNIFORM_FLOAT: c->Program->SetFloat(c->Uniform, v[0]); break;
+	case UNIFORM_VEC2: c->Program->SetVec2(c->Uniform, v[0], v[1]); break;
+	case UNIFORM_VEC3: c->Program->SetVec3(c->Uniform, v[0], v[1], v[2]); break;
+	case UNIFORM_VEC4: c->Program->SetVec4(c->Uniform, v[0], v[1], v[2], v[3]); break;
+	case UNIFORM_MAT3: c->Program->SetMat3(c->Uniform, v); break;
+	case UNIFORM_MAT4: c->Program->SetMat4(c->Uniform, v); break;
+	}
+}
+
+void CommandBuffer::Execute() const
+{
+	size_t at = 0;
+	while(at < Used)
+	{
+		const CommandHeader* header = (const CommandHeader*)&Arena[at];
+		switch(header->Type)
+		{
+		case COMMAND_USE_PROGRAM:
+			GGLState.UseProgram(((const NameCommand*)header)->Value);
+			break;
+		case COMMAND_BIND_TEXTURE:
+		{
+			const BindCommand* c = (const BindCommand*)header;
+			GGLState.ActiveTexture(c->Unit);
+			GGLState.BindTexture(c->Target, c->Name);
+			break;
+		}
+		case COMMAND_BIND_BUFFER:
+		{
+			const BindCommand* c = (const BindCommand*)header;
+			GGLState.BindBuffer(c->Target, c->Name);
+			break;
+		}
+		case COMMAND_ENABLE_LAYOUT:
+		{
+			const LayoutCommand* c = (const LayoutCommand*)header;
+			c->Layout->Enable(c->Buffer);
+			break;
+		}
+		case COMMAND_ENABLE:
+			GGLState.Enable(((const NameCommand*)header)->Value);
+			break;
+		case COMMAND_DISABLE:
+			GGLState.Disable(((const NameCommand*)header)->Value);
+			break;
+		case COMMAND_BLEND_FUNC:
+		{
+			const PairCommand* c = (const PairCommand*)header;
+			GGLState.BlendFunc(c->First, c->Second);
+			break;
+		}
+		case COMMAND_DEPTH_FUNC:
+			GGLState.DepthFunc(((const NameCommand*)header)->Value);
+			break;
+		case COMMAND_VIEWPORT:
+		{
+			const ViewportCommand* c = (const ViewportCommand*)header;
+			GGLState.Viewport(c->Rect[0], c->Rect[1], c->Rect[2], c->Rect[3]);
+			break;
+		}
+		case COMMAND_CLEAR:
+			glClear(((const NameCommand*)header)->Value);
+			break;
+		case COMMAND_UNIFORM:
+			executeUniform((const UniformCommand*)header);
+			break;
+		case COMMAND_DRAW_ARRAYS:
+		{
+			const DrawCommand* c = (const DrawCommand*)header;
+			glDrawArrays(c->Mode, c->First, c->Count);
+			break;
+		}
+		case COMMAND_DRAW_ELEMENTS:
+		{
+			const DrawCommand* c = (const DrawCommand*)header;
+			glDrawElements(c->Mode, c->Count, c->Type, (const void*)c->Offset);
+			break;
+		}
+		default:
+			printf("Unknown render command %d, the rest of the buffer is skipped\n", header->Type);
+			return;
+		}
+		at += header->Size;
+	}
+}
+
+CommandQueue::CommandQueue()
+	: Recorded(0), Executed(0), Stopping(false)
+{
+	pthread_mutex_init(&Lock, NULL);
+	pthread_cond_init(&Wake, NULL);
+}
+
+CommandQueue::~CommandQueue()
+{
+	pthread_cond_destroy(&Wake);
+	pthread_mutex_destroy(&Lock);
+}
+
+CommandBuffer* CommandQueue::BeginRecord()
+{
+	pthread_mutex_lock(&Lock);
+	// every buffer holds a frame the GL thread hasn't finished
+	while(Recorded - Executed >= COMMAND_QUEUE_FRAMES && !Stopping)
+		pthread_cond_wait(&Wake, &Lock);
+	CommandBuffer* buffer = Stopping ? NULL : &Buffers[Recorded % COMMAND_QUEUE_FRAMES];
+	pthread_mutex_unlock(&Lock);
+	if(buffer)
+		buffer->Reset();
+	return buffer;
+}
+
+void CommandQueue::EndRecord()
+{
+	pthread_mutex_lock(&Lock);
+	Recorded++;
+	pthread_cond_broadcast(&Wake);
+	pthread_mutex_unlock(&Lock);
+}
+
+CommandBuffer* CommandQueue::BeginExecute()
+{
+	pthread_mutex_lock(&Lock);
+	while(Executed == Recorded && !Stopping)
+		pthread_cond_wait(&Wake, &Lock);
+	CommandBuffer* buffer = Executed == Recorded ? NULL : &Buffers[Executed % COMMAND_QUEUE_FRAMES];
+	pthread_mutex_unlock(&Lock);
+	return buffer;
+}
+
+void CommandQueue::EndExecute()
+{
+	pthread_mutex_lock(&Lock);
+	Executed++;
+	pthread_cond_broadcast(&Wake);
+	pthread_mutex_unlock(&Lock);
+}
+
+void CommandQueue::Stop()
+{
+	pthread_mutex_lock(&Lock);
+	Stopping = true;
+	pthread_cond_broadcast(&Wake);
+	pthread_mutex_unlock(&Lock);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <pthread.h>
+#include <stddef.h>
+#include <vector>
+
+#include "GLES2/gl2.h"
+
+class ProgramReflection;
+class VertexLayout;
+
+#define COMMAND_QUEUE_FRAMES 2
+
+// GL work written down to be done later. Any thread can record, only the GL thread
+// executes; one thread records into a buffer at a time. Commands are packed one after
+// the other in one block of memory that is kept between frames, so recording is a copy
+// and no command allocates. The block doubles when a frame outgrows it.
+//
+// Uniforms go through the program's ProgramReflection when executed, so their redundant
+// uploads are still skipped, and state through GGLState. Programs, layouts, buffers and
+// textures are referred to, not copied, and have to live until the buffer has executed.
+//   commands.UseProgram(program->GetId());
+//   commands.SetMat4(&program->GetReflection(), mvp, &MVP[0][0]);
+//   commands.DrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, 0);
+//   ...later, on the GL thread
+//   commands.Execute();
+class CommandBuffer
+{
+	std::vector<unsigned char> Arena;
+	size_t Used;
+	unsigned int Count;
+
+	void* Record(unsigned short type, size_t bytes);
+	void RecordUniform(ProgramReflection* program, int uniform, int kind, const GLfloat* values, int count);
+
+public:
+
+	CommandBuffer(size_t bytes = 64 * 1024);
+	~CommandBuffer() {}
+
+	// Empties it for the next frame, the memory stays
+	void Reset() { Used = 0; Count = 0; }
+
+	void UseProgram(GLuint program);
+	// unit is GL_TEXTURE0 + n
+	void BindTexture(GLenum unit, GLenum target, GLuint texture);
+	void BindBuffer(GLenum target, GLuint buffer);
+	// layout.Enable(buffer) when executed
+	void EnableLayout(VertexLayout* layout, GLuint buffer);
+	void Enable(GLenum cap);
+	void Disable(GLenum cap);
+	void BlendFunc(GLenum sfactor, GLenum dfactor);
+	void DepthFunc(GLenum func);
+	void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	void Clear(GLbitfield mask);
+
+	// Same arguments as the ProgramReflection setters plus the program, uniform -1 records nothing
+	void SetInt(ProgramReflection* program, int uniform, GLint value);
+	void SetFloat(ProgramReflection* program, int uniform, GLfloat value);
+	void SetVec2(ProgramReflection* program, int uniform, GLfloat x, GLfloat y);
+	void SetVec3(ProgramReflection* program, int uniform, GLfloat x, GLfloat y, GLfloat z);
+	void SetVec4(ProgramReflection* program, int uniform, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+	void SetMat3(ProgramReflection* program, int uniform, const GLfloat* m);
+	void SetMat4(ProgramReflection* program, int uniform, const GLfloat* m);
+
+	void DrawArrays(GLenum mode, GLint first, GLsizei count);
+	// offset in bytes into the bound element buffer
+	void DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset);
+
+	// Runs the commands in the order they were recorded, GL thread only
+	void Execute() const;
+
+	unsigned int GetCount() const { return Count; }
+	size_t GetUsed() const { return Used; }
+	size_t GetCapacity() const { return Arena.size(); }
+	// Times the block had to grow, it should stop once the frames are sized
+	unsigned int Grows;
+};
+
+// Hands recorded frames from one recording thread to the GL thread in order, with
+// COMMAND_QUEUE_FRAMES buffers so frame N+1 is recorded while frame N executes.
+//   recording thread                    GL thread
+//   while((c = queue.BeginRecord()))    while((c = queue.BeginExecute()))
+//   { record(c); queue.EndRecord(); }   { c->Execute(); queue.EndExecute(); swap }
+class CommandQueue
+{
+	pthread_mutex_t Lock;
+	pthread_cond_t Wake;
+	CommandBuffer Buffers[COMMAND_QUEUE_FRAMES];
+	unsigned int Recorded;       // frames handed over
+	unsigned int Executed;       // frames the GL thread is done with
+	bool Stopping;
+
+public:
+
+	CommandQueue();
+	~CommandQueue();
+
+	// Waits for a free buffer and empties it, NULL once stopped
+	CommandBuffer* BeginRecord();
+	void EndRecord();
+	// Waits for the next recorded frame, NULL once stopped and every recorded frame is out
+	CommandBuffer* BeginExecute();
+	void EndExecute();
+	// Wakes both sides, the frames already recorded still come out of BeginExecute
+	void Stop();
+};
@@ -0,0 +1,96 @@
+#include <stdio.h>
+
+#include "residency.h"
+
+void ResidencyManager::Init(size_t item_count, size_t budget_bytes)
+{
+	Sizes.assign(item_count, 0);
+	LastUsed.assign(item_count, 0);
+	Failed.assign(item_count, false);
+	LRU.clear();
+	Position.assign(item_count, LRU.end());
+	Budget = budget_bytes;
+	ResidentBytes = 0;
+	PeakBytes = 0;
+	// items start out "used" in frame 0, which is never current
+	Frame = 1;
+	ResetStats();
+}
+
+bool ResidencyManager::Touch(unsigned int item)
+{
+	LastUsed[item] = Frame;
+	if(!Sizes[item])
+	{
+		Misses++;
+		return false;
+	}
+	Hits++;
+	LRU.splice(LRU.begin(), LRU, Position[item]);
+	return true;
+}
+
+bool ResidencyManager::Reserve(size_t bytes, std::vector<unsigned int>& out_evicted)
+{
+	if(bytes > Budget)
+		return false;
+
+	// check first so a failed reserve leaves everything in place
+	size_t freeable = Budget - ResidentBytes;
+	std::list<unsigned int>::reverse_iterator it = LRU.rbegin();
+	for(; freeable < bytes && it != LRU.rend() && LastUsed[*it] != Frame; ++it)
+		freeable += Sizes[*it];
+	if(freeable < bytes)
+		return false;
+
+	while(Budget - ResidentBytes < bytes)
+	{
+		unsigned int victim = LRU.back();
+		out_evicted.push_back(victim);
+		MarkEvicted(victim);
+		Evictions++;
+	}
+	return true;
+}
+
+void ResidencyManager::MarkResident(unsigned int item, size_t bytes)
+{
+	if(Sizes[item])
+		MarkEvicted(item);
+	// zero means "not resident", an empty item still takes a byte of budget
+	Sizes[item] = bytes ? bytes : 1;
+	ResidentBytes += Sizes[item];
+	if(ResidentBytes > PeakBytes)
+		PeakBytes = ResidentBytes;
+	LRU.push_front(item);
+	Position[item] = LRU.begin();
+	LastUsed[item] = Frame;
+	BytesStreamed += bytes;
+}
+
+void ResidencyManager::MarkEvicted(unsigned int item)
+{
+	if(!Sizes[item])
+		return;
+	ResidentBytes -= Sizes[item];
+	Sizes[item] = 0;
+	LRU.erase(Position[item]);
+	Position[item] = LRU.end();
+}
+
+void ResidencyManager::PrintStats(const char* label)
+{
+	unsigned long long touches = Hits + Misses;
+	printf("%s: %llu hits, %llu misses (%.1f%% hit rate), %.2f MB streamed, %llu evictions, %.2f / %.2f MB resident (peak %.2f)\n",
+		label, Hits, Misses, touches ? 100.0 * Hits / touches : 0.0,
+		BytesStreamed / (1024.0 * 1024.0), Evictions,
+		ResidentBytes / (1024.0 * 1024.0), Budget / (1024.0 * 1024.0), PeakBytes / (1024.0 * 1024.0));
+}
+
+void ResidencyManager::ResetStats()
+{
+	Hits = 0;
+	Misses = 0;
+	BytesStreamed = 0;
+	Evictions = 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <list>
+#include <vector>
+
+// Book keeping for a fixed set of items (chunks, textures...) that are paged in and out of a
+// memory budget. It decides what to evict, the owner does the actual loading and freeing.
+// Least recently used goes first, but never something already used in the current frame.
+class ResidencyManager
+{
+	std::vector<size_t> Sizes;          // 0 when not resident
+	std::vector<unsigned int> LastUsed;
+	std::vector<bool> Failed;
+	std::list<unsigned int> LRU;        // most recently used at the front
+	std::vector<std::list<unsigned int>::iterator> Position;
+	size_t Budget;
+	size_t ResidentBytes;
+	size_t PeakBytes;
+	unsigned int Frame;
+
+public:
+
+	unsigned long long Hits;
+	unsigned long long Misses;
+	unsigned long long BytesStreamed;
+	unsigned long long Evictions;
+
+	ResidencyManager() { Init(0, 0); }
+
+	void Init(size_t item_count, size_t budget_bytes);
+	void BeginFrame() { Frame++; }
+
+	// Counts a hit and refreshes the item when it is resident, otherwise counts a miss
+	bool Touch(unsigned int item);
+	// Makes room for bytes by evicting items not used this frame, adding them to out_evicted.
+	// False when they can't be made to fit, nothing is evicted then.
+	bool Reserve(size_t bytes, std::vector<unsigned int>& out_evicted);
+	// The owner has loaded item into the room made by Reserve
+	void MarkResident(unsigned int item, size_t bytes);
+	// The owner dropped item by itself
+	void MarkEvicted(unsigned int item);
+	// The owner couldn't load item and won't try again, it stays out until the next Init
+	void MarkFailed(unsigned int item) { MarkEvicted(item); Failed[item] = true; }
+
+	bool IsResident(unsigned int item) { return Sizes[item] != 0; }
+	bool IsFailed(unsigned int item) { return Failed[item]; }
+	size_t GetResidentBytes() { return ResidentBytes; }
+	size_t GetPeakBytes() { return PeakBytes; }
+	size_t GetBudget() { return Budget; }
+
+	void PrintStats(const char* label);
+	void ResetStats();
+};
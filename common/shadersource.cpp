@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "shadersource.h"
+
+bool readShaderFile(const char* path, std::string& out)
+{
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return false;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	out.resize(size);
+	bool ok = size == 0 || fread(&out[0], 1, size, f) == (size_t)size;
+	fclose(f);
+	return ok;
+}
+
+bool findShaderSource(const EmbeddedShader* shaders, const char* name, std::string& out)
+{
+	const char* directory = getenv("SHADER_DIR");
+	if(directory && *directory)
+	{
+		std::string path = std::string(directory) + "/" + name;
+		if(readShaderFile(path.c_str(), out))
+		{
+			printf("Shader %s read from %s\n", name, path.c_str());
+			return true;
+		}
+		printf("%s not found, using the built in %s\n", path.c_str(), name);
+	}
+
+	for(; shaders && shaders->Name; shaders++)
+	{
+		if(strcmp(shaders->Name, name) == 0)
+		{
+			out = shaders->Source;
+			return true;
+		}
+	}
+	printf("No shader %s\n", name);
+	return false;
+}
+
+static bool isIdentifier(char c)
+{
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+static bool isOperator(char c)
+{
+	return strchr("+-*/%<>=!&|^", c) != NULL;
+}
+
+// A comment becomes a space, or a line break when it spanned lines, so a directive after
+// it still starts its own line
+static std::string stripComments(const char* s)
+{
+	std::string out;
+	while(*s)
+	{
+		if(s[0] == '/' && s[1] == '/')
+		{
+			while(*s && *s != '\n')
+				s++;
+		}
+		else if(s[0] == '/' && s[1] == '*')
+		{
+			bool lines = false;
+			for(s += 2; *s && !(s[0] == '*' && s[1] == '/'); s++)
+				lines = lines || *s == '\n';
+			if(*s)
+				s += 2;
+			out += lines ? '\n' : ' ';
+		}
+		else
+			out += *s++;
+	}
+	return out;
+}
+
+void minifyShaderSource(const char* source, std::string& out)
+{
+	std::string text = stripComments(source);
+	out.clear();
+	bool space = false;   // whitespace seen since the last character written
+	size_t start = 0;
+	while(start < text.size())
+	{
+		size_t end = text.find('\n', start);
+		if(end == std::string::npos)
+			end = text.size();
+		size_t first = start;
+		while(first < end && isspace((unsigned char)text[first]))
+			first++;
+
+		if(first < end && text[first] == '#')
+		{
+			// "#define F(x)" and "#define F (x)" differ, only runs of whitespace go
+			if(!out.empty() && out[out.size() - 1] != '\n')
+				out += '\n';
+			space = false;
+			for(size_t i = first; i < end; i++)
+			{
+				if(isspace((unsigned char)text[i]))
+					space = true;
+				else
+				{
+					if(space && out[out.size() - 1] != '\n')
+						out += ' ';
+					out += text[i];
+					space = false;
+				}
+			}
+			out += '\n';
+			space = false;
+		}
+		else
+		{
+			for(size_t i = first; i < end; i++)
+			{
+				char c = text[i];
+				if(isspace((unsigned char)c))
+				{
+					space = true;
+					continue;
+				}
+				if(space && !out.empty())
+				{
+					char last = out[out.size() - 1];
+					if((isIdentifier(last) && isIdentifier(c)) || (isOperator(last) && isOperator(c)))
+						out += ' ';
+				}
+				out += c;
+				space = false;
+			}
+			space = true;
+		}
+		start = end + 1;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+// One shader compiled into the program by tools/shaderembed (the embed_shaders CMake
+// function). The generated header holds a table of these ended by { NULL, NULL }.
+struct EmbeddedShader
+{
+	const char* Name;     // file name without its directory
+	const char* Source;   // comments and extra whitespace stripped
+};
+
+// The source of a shader by file name. When SHADER_DIR is set in the environment the file
+// is read from that directory instead of the table, so shaders can be edited without a
+// rebuild. False when it is in neither.
+bool findShaderSource(const EmbeddedShader* shaders, const char* name, std::string& out);
+
+bool readShaderFile(const char* path, std::string& out);
+
+// Strips comments and the whitespace the GLSL parser doesn't need. Preprocessor lines
+// keep their own line.
+void minifyShaderSource(const char* source, std::string& out);
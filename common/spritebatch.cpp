@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "spritebatch.h"
+#include "textureatlas.h"
+#include "glstate.h"
+#include "gpumemory.h"
+
+static const char* GSpriteVertexSource =
+	"attribute vec2 position;\n"
+	"attribute vec2 texcoord;\n"
+	"attribute vec4 color;\n"
+	"varying vec2 tcoord;\n"
+	"varying vec4 tint;\n"
+	"void main(void)\n"
+	"{\n"
+	"	tcoord = texcoord;\n"
+	"	tint = color;\n"
+	"	gl_Position = vec4(position, 1.0, 1.0);\n"
+	"}\n";
+
+static const char* GSpriteFragmentSource =
+	"precision mediump float;\n"
+	"varying vec2 tcoord;\n"
+	"varying vec4 tint;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"	gl_FragColor = texture2D(tex, tcoord) * tint;\n"
+	"}\n";
+
+static GLuint compileShader(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint compiled = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if(!compiled)
+	{
+		char log[512];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		printf("Sprite shader did not compile:\n%s\n", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+SpriteBatch::SpriteBatch()
+	: MaxSprites(0), Count(0), VertexBuffer(0), IndexBuffer(0), DefaultProgram(0), Program(0), Texture(0),
+	LocatedProgram(0), PositionAttrib(-1), TexcoordAttrib(-1), ColorAttrib(-1), Drawing(false), Sprites(0), Flushes(0)
+{
+}
+
+bool SpriteBatch::Create(int max_sprites)
+{
+	Release();
+	if(max_sprites < 1 || max_sprites > 16384)
+	{
+		printf("A sprite batch holds 1 to 16384 sprites, not %d\n", max_sprites);
+		return false;
+	}
+
+	GLuint vs = compileShader(GL_VERTEX_SHADER, GSpriteVertexSource);
+	GLuint fs = compileShader(GL_FRAGMENT_SHADER, GSpriteFragmentSource);
+	if(!vs || !fs)
+		return false;
+	DefaultProgram = glCreateProgram();
+	glAttachShader(DefaultProgram, vs);
+	glAttachShader(DefaultProgram, fs);
+	glLinkProgram(DefaultProgram);
+	// flagged now, they go with the program
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+	GLint linked = 0;
+	glGetProgramiv(DefaultProgram, GL_LINK_STATUS, &linked);
+	if(!linked)
+	{
+		printf("Sprite program did not link\n");
+		Release();
+		return false;
+	}
+	GGLState.UseProgram(DefaultProgram);
+	glUniform1i(glGetUniformLocation(DefaultProgram, "tex"), 0);
+
+	// two triangles per quad, the indices never change
+	MaxSprites = max_sprites;
+	std::vector<GLushort> indices(MaxSprites * 6);
+	for(int i = 0; i < MaxSprites; i++)
+	{
+		GLushort v = (GLushort)(i * 4);
+		GLushort* q = &indices[i * 6];
+		q[0] = v; q[1] = v + 1; q[2] = v + 2;
+		q[3] = v + 2; q[4] = v + 1; q[5] = v + 3;
+	}
+	size_t index_bytes = indices.size() * sizeof(GLushort);
+	size_t vertex_bytes = MaxSprites * 4 * sizeof(SpriteVertex);
+	IndexBuffer = createBuffer(GL_ELEMENT_ARRAY_BUFFER, &indices[0], index_bytes);
+	VertexBuffer = createBuffer(GL_ARRAY_BUFFER, NULL, vertex_bytes, GL_STREAM_DRAW);
+
+	Vertices.resize(MaxSprites * 4);
+	Count = 0;
+	return true;
+}
+
+void SpriteBatch::Release()
+{
+	deleteBuffer(VertexBuffer);
+	VertexBuffer = 0;
+	deleteBuffer(IndexBuffer);
+	IndexBuffer = 0;
+	if(DefaultProgram)
+	{
+		GGLState.DeleteProgram(DefaultProgram);
+		DefaultProgram = 0;
+	}
+	Vertices.clear();
+	MaxSprites = 0;
+	Count = 0;
+	LocatedProgram = 0;
+}
+
+void SpriteBatch::Begin(GLuint program)
+{
+	assert(!Drawing);
+	Drawing = true;
+	Count = 0;
+	Texture = 0;
+	Program = program ? program : DefaultProgram;
+}
+
+void SpriteBatch::SetProgram(GLuint program)
+{
+	if(!program)
+		program = DefaultProgram;
+	if(program == Program)
+		return;
+	Flush();
+	Program = program;
+}
+
+void SpriteBatch::Draw(GLuint texture, float x0, float y0, float x1, float y1,
+	float u0, float v0, float u1, float v1, unsigned int tint)
+{
+	assert(Drawing);
+	if(texture != Texture || Count == MaxSprites)
+	{
+		Flush();
+		Texture = texture;
+	}
+
+	SpriteVertex* v = &Vertices[Count * 4];
+	// same corner order as the triangle strip DrawTextureRect used to draw
+	v[0].X = x0; v[0].Y = y0; v[0].U = u0; v[0].V = v0;
+	v[1].X = x1; v[1].Y = y0; v[1].U = u1; v[1].V = v0;
+	v[2].X = x0; v[2].Y = y1; v[2].U = u0; v[2].V = v1;
+	v[3].X = x1; v[3].Y = y1; v[3].U = u1; v[3].V = v1;
+	GLubyte color[4] = { (GLubyte)(tint >> 24), (GLubyte)(tint >> 16), (GLubyte)(tint >> 8), (GLubyte)tint };
+	for(int i = 0; i < 4; i++)
+	{
+		v[i].Color[0] = color[0];
+		v[i].Color[1] = color[1];
+		v[i].Color[2] = color[2];
+		v[i].Color[3] = color[3];
+	}
+	Count++;
+}
+
+void SpriteBatch::Draw(const TextureAtlas& atlas, const AtlasRegion& region, float x0, float y0, float x1, float y1,
+	unsigned int tint)
+{
+	Draw(atlas.GetPage(region.Page), x0, y0, x1, y1, region.U0, region.V0, region.U1, region.V1, tint);
+}
+
+void SpriteBatch::Flush()
+{
+	if(!Count)
+		return;
+
+	GGLState.UseProgram(Program);
+	if(Program != LocatedProgram)
+	{
+		PositionAttrib = glGetAttribLocation(Program, "position");
+		TexcoordAttrib = glGetAttribLocation(Program, "texcoord");
+		ColorAttrib = glGetAttribLocation(Program, "color");
+		LocatedProgram = Program;
+	}
+	if(PositionAttrib < 0)
+	{
+		printf("Sprite program %u has no position attribute\n", Program);
+		Count = 0;
+		return;
+	}
+
+	// a new store each flush, the driver doesn't wait for draws still reading the old one.
+	// It is always the full size, the one GGpuMemory tracked in Create.
+	GGLState.BindBuffer(GL_ARRAY_BUFFER, VertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, MaxSprites * 4 * sizeof(SpriteVertex), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, Count * 4 * sizeof(SpriteVertex), &Vertices[0]);
+	GLsizei stride = sizeof(SpriteVertex);
+	glVertexAttribPointer(PositionAttrib, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteVertex, X));
+	GGLState.EnableVertexAttribArray(PositionAttrib);
+	if(TexcoordAttrib >= 0)
+	{
+		glVertexAttribPointer(TexcoordAttrib, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteVertex, U));
+		GGLState.EnableVertexAttribArray(TexcoordAttrib);
+	}
+	if(ColorAttrib >= 0)
+	{
+		glVertexAttribPointer(ColorAttrib, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(SpriteVertex, Color));
+		GGLState.EnableVertexAttribArray(ColorAttrib);
+	}
+
+	GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBuffer);
+	GGLState.ActiveTexture(GL_TEXTURE0);
+	GGLState.BindTexture(GL_TEXTURE_2D, Texture);
+	GGLState.Enable(GL_BLEND);
+	GGLState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDrawElements(GL_TRIANGLES, Count * 6, GL_UNSIGNED_SHORT, 0);
+
+	Sprites += Count;
+	Flushes++;
+	Count = 0;
+}
+
+void SpriteBatch::End()
+{
+	assert(Drawing);
+	Flush();
+	Drawing = false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+#include "GLES2/gl2.h"
+#include "atlaspacker.h"
+
+class TextureAtlas;
+
+struct SpriteVertex
+{
+	GLfloat X, Y;
+	GLfloat U, V;
+	GLubyte Color[4];
+};
+
+// Collects textured rectangles and draws them as indexed quads from one streaming vertex
+// buffer. The quads go out in order, a flush happens when the texture or program changes,
+// at End and when the buffer is full. Rects are in clip space, (u0,v0) lands on (x0,y0).
+// Blending is on (source alpha) while they draw. GL thread only.
+//   batch.Begin();
+//   batch.Draw(texture, -1, -1, 0, 0);
+//   batch.Draw(atlas, *atlas.Find("icon"), 0.5f, 0.5f, 0.6f, 0.6f, 0xff8080ff);
+//   batch.End();
+class SpriteBatch
+{
+	std::vector<SpriteVertex> Vertices;
+	int MaxSprites;
+	int Count;
+	GLuint VertexBuffer;
+	GLuint IndexBuffer;
+	GLuint DefaultProgram;
+	GLuint Program;
+	GLuint Texture;
+	GLuint LocatedProgram;       // the program the attribute locations below belong to
+	GLint PositionAttrib, TexcoordAttrib, ColorAttrib;
+	bool Drawing;
+
+public:
+
+	SpriteBatch();
+	~SpriteBatch() {}
+
+	// GL objects for up to max_sprites quads per flush, 16384 at most with 16 bit indices.
+	// Release is not left to the destructor, GSpriteBatch outlives the context.
+	bool Create(int max_sprites = 1024);
+	void Release();
+
+	// program 0 is the built in one: texture times tint. Another program takes the
+	// attributes "position" (vec2), "texcoord" (vec2) and "color" (vec4) and samples unit 0.
+	void Begin(GLuint program = 0);
+	void SetProgram(GLuint program);
+	// tint is 0xRRGGBBAA
+	void Draw(GLuint texture, float x0, float y0, float x1, float y1,
+		float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f, unsigned int tint = 0xffffffff);
+	void Draw(const TextureAtlas& atlas, const AtlasRegion& region, float x0, float y0, float x1, float y1,
+		unsigned int tint = 0xffffffff);
+	void Flush();
+	void End();
+
+	// quads drawn and the draw calls they took
+	unsigned long long Sprites;
+	unsigned long long Flushes;
+};
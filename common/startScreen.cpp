@@ -8,8 +8,9 @@
 #include <iostream>
 #include "bcm_host.h"
 #include "startScreen.h"
-
-#define check() assert(glGetError() == 0)
+#include "gpumemory.h"
+#include "glstate.h"
+#include "glcheck.h"
 
 uint32_t GScreenWidth;
 uint32_t GScreenHeight;
@@ -116,7 +117,7 @@ void InitGraphics()
 	glClearColor(0.15f, 0.25f, 0.35f, 1.0f);
 	glClear( GL_COLOR_BUFFER_BIT );
 
-   glViewport ( 0, 0, GScreenWidth, GScreenHeight );
+   GGLState.Viewport ( 0, 0, GScreenWidth, GScreenHeight );
 
    check();
 
@@ -124,8 +125,11 @@ void InitGraphics()
 
 void updateScreen() {
    eglSwapBuffers(GDisplay,GSurface);
+   GGpuMemory.BeginFrame();
+   GGLState.BeginFrame();
+   GGLCheck.BeginFrame();
 }
 
 void setViewport() {
-   glViewport ( 0, 0, GScreenWidth, GScreenHeight );
+   GGLState.Viewport ( 0, 0, GScreenWidth, GScreenHeight );
 }
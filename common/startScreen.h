@@ -3,6 +3,11 @@
 #include "GLES2/gl2.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
+#include <stdint.h>
+
+// Size of the display, set by InitGraphics
+extern uint32_t GScreenWidth;
+extern uint32_t GScreenHeight;
 
 void InitGraphics();
 
@@ -2,72 +2,38 @@
 #include <stdlib.h>
 #include <string.h>
 #include "texture.h"
+#include <vector>
+#include "GLES2/gl2ext.h"
+#include "bmpfile.h"
+#include "ktxfile.h"
+#include "gpumemory.h"
+#include "glstate.h"
 
-GLuint loadBMP_custom(const char * imagepath){
+GLuint loadBMP_custom(const char * imagepath, TextureInfo * out_info){
 
-	printf("Reading image %s\n", imagepath);
-
-	// Data read from the header of the BMP file
-	unsigned char header[54];
-	unsigned int dataPos;
-	unsigned int imageSize;
+	// Actual RGB data, bottom row first
+	std::vector<unsigned char> data;
 	unsigned int width, height;
-	// Actual RGB data
-	unsigned char * data;
-
-	// Open the file
-	FILE * file = fopen(imagepath,"rb");
-	if (!file){
-            printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath); getchar(); return 0;
-        }
-
-	// Read the header, i.e. the 54 first bytes
-
-	// If less than 54 bytes are read, problem
-	if ( fread(header, 1, 54, file)!=54 ){ 
-		printf("Not a correct BMP file\n");
+	if (!readBMP(imagepath, data, width, height)){
+		getchar();
 		return 0;
 	}
-	// A BMP files always begins with "BM"
-	if ( header[0]!='B' || header[1]!='M' ){
-		printf("Not a correct BMP file\n");
-		return 0;
-	}
-	// Make sure this is a 24bpp file
-	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    return 0;}
-	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    return 0;}
-
-	// Read the information about the image
-	dataPos    = *(int*)&(header[0x0A]);
-	imageSize  = *(int*)&(header[0x22]);
-	width      = *(int*)&(header[0x12]);
-	height     = *(int*)&(header[0x16]);
 
-	// Some BMP files are misformatted, guess missing information
-	if (imageSize==0)    imageSize=width*height*3; // 3 : one byte for each Red, Green and Blue component
-	if (dataPos==0)      dataPos=54; // The BMP header is done that way
-
-	// Create a buffer
-	data = new unsigned char [imageSize];
-
-	// Read the actual data from the file into the buffer
-	fread(data,1,imageSize,file);
-
-	// Everything is in memory now, the file wan be closed
-	fclose (file);
+	// glGenerateMipmap fills in the whole chain
+	size_t bytes = gpuImageBytes(width, height, 3, 0);
+	GGpuMemory.Reserve(bytes);
 
 	// Create one OpenGL texture
 	GLuint textureID;
 	glGenTextures(1, &textureID);
 	
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
-
-	// Give the image to OpenGL
-	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data); //GL_BGR barfs
+	GGLState.BindTexture(GL_TEXTURE_2D, textureID);
 
-	// OpenGL has now copied the data. Free our own version
-	delete [] data;
+	// Give the image to OpenGL, the rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, &data[0]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
 	// Poor filtering, or ...
 	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -79,13 +45,130 @@ GLuint loadBMP_custom(const char * imagepath){
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
 	glGenerateMipmap(GL_TEXTURE_2D);
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, textureID, GPU_TEXTURES, bytes);
 
         printf("Returning textureID %d\n", textureID);
 
+	if (out_info){
+		out_info->Width = width;
+		out_info->Height = height;
+		out_info->Levels = 1;
+		for (unsigned int w=width, h=height; w>1 || h>1; w = w>1 ? w/2 : 1, h = h>1 ? h/2 : 1)
+			out_info->Levels++;
+		out_info->Bytes = bytes;
+	}
+
 	// Return the ID of the texture we just created
 	return textureID;
 }
 
+static bool hasETC1(){
+	const char * extensions = (const char *)glGetString(GL_EXTENSIONS);
+	return extensions && strstr(extensions, "GL_OES_compressed_ETC1_RGB8_texture");
+}
+
+bool canUploadTextureImage(const TextureImage & image){
+	if (image.Levels.empty())
+		return false;
+	return image.InternalFormat != GL_ETC1_RGB8_OES || hasETC1();
+}
+
+void uploadTextureLevel(const TextureImage & image, size_t level){
+	// Uncompressed rows are padded to 4 bytes, the default GL_UNPACK_ALIGNMENT
+	const TextureLevel & l = image.Levels[level];
+	if (image.Type == 0)
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, image.InternalFormat, l.Width, l.Height, 0, l.Data.size(), &l.Data[0]);
+	else
+		glTexImage2D(GL_TEXTURE_2D, level, image.InternalFormat, l.Width, l.Height, 0, image.Format, image.Type, &l.Data[0]);
+}
+
+void finishTextureUpload(const TextureImage & image, TextureInfo * out_info){
+
+	// GLES2 has no GL_TEXTURE_MAX_LEVEL, only a chain down to 1x1 is complete for mip filtering
+	const TextureLevel & last = image.Levels.back();
+	bool fullChain = last.Width == 1 && last.Height == 1;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, fullChain ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+	if (out_info){
+		out_info->Width = image.Levels[0].Width;
+		out_info->Height = image.Levels[0].Height;
+		out_info->Levels = image.Levels.size();
+		out_info->Bytes = 0;
+		for (size_t level=0; level<image.Levels.size(); level++)
+			out_info->Bytes += image.Levels[level].Data.size();
+	}
+}
+
+// Uploads every level as it is in the file, the mip chain was built offline
+static GLuint uploadTextureImage(const TextureImage & image, TextureInfo * out_info){
+
+	TextureInfo info;
+	size_t bytes = 0;
+	for (size_t level=0; level<image.Levels.size(); level++)
+		bytes += image.Levels[level].Data.size();
+	GGpuMemory.Reserve(bytes);
+
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	GGLState.BindTexture(GL_TEXTURE_2D, textureID);
+
+	for (size_t level=0; level<image.Levels.size(); level++)
+		uploadTextureLevel(image, level);
+	finishTextureUpload(image, &info);
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, textureID, GPU_TEXTURES, info.Bytes);
+	if (out_info)
+		*out_info = info;
+	return textureID;
+}
+
+void deleteTexture(GLuint texture){
+	if (!texture)
+		return;
+	GGpuMemory.Untrack(GPU_OBJECT_TEXTURE, texture);
+	GGLState.DeleteTextures(1, &texture);
+}
+
+GLuint loadKTX(const char * imagepath, TextureInfo * out_info){
+
+	TextureImage image;
+	if (!readTextureFile(imagepath, image))
+		return 0;
+	if (image.InternalFormat == GL_ETC1_RGB8_OES && !hasETC1()){
+		printf("No ETC1 support, not loading %s\n", imagepath);
+		return 0;
+	}
+
+	GLuint textureID = uploadTextureImage(image, out_info);
+	printf("Loaded %s, %ux%u, %u levels, textureID %d\n", imagepath,
+		image.Levels[0].Width, image.Levels[0].Height, (unsigned)image.Levels.size(), textureID);
+	return textureID;
+}
+
+GLuint loadETC1(const char * imagepath, TextureInfo * out_info){
+
+	// don't read the file when it can't be used
+	if (!hasETC1()){
+		printf("No ETC1 support, not loading %s\n", imagepath);
+		return 0;
+	}
+
+	TextureImage image;
+	if (!readTextureFile(imagepath, image))
+		return 0;
+	if (image.InternalFormat != GL_ETC1_RGB8_OES){
+		printf("%s is not ETC1\n", imagepath);
+		return 0;
+	}
+
+	GLuint textureID = uploadTextureImage(image, out_info);
+	printf("Loaded %s, %ux%u ETC1, %u levels, textureID %d\n", imagepath,
+		image.Levels[0].Width, image.Levels[0].Height, (unsigned)image.Levels.size(), textureID);
+	return textureID;
+}
+
 /*  no glfw not in a window
 GLuint loadTGA_glfw(const char * imagepath){
 
@@ -94,7 +177,7 @@ GLuint loadTGA_glfw(const char * imagepath){
 	glGenTextures(1, &textureID);
 
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GGLState.BindTexture(GL_TEXTURE_2D, textureID);
 
 	// Read the file, call glTexImage2D with the right parameters
 	glfwLoadTexture2D(imagepath, 0);
@@ -182,7 +265,7 @@ GLuint loadDDS(const char * imagepath){
 	glGenTextures(1, &textureID);
 
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GGLState.BindTexture(GL_TEXTURE_2D, textureID);
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);	
 	
 	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
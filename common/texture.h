@@ -3,12 +3,40 @@
 #include "GLES2/gl2.h"
 #include "EGL/egl.h"
 #include "EGL/eglext.h"
+#include <stddef.h>
 
 #ifndef TEXTURE_HPP
 #define TEXTURE_HPP
 
+// What a loader put on the GPU, for the texture manager's book keeping
+struct TextureInfo
+{
+	unsigned int Width, Height, Levels;
+	size_t Bytes;   // all levels, as uploaded
+};
+
 // Load a .BMP file using our custom loader
-GLuint loadBMP_custom(const char * imagepath);
+GLuint loadBMP_custom(const char * imagepath, TextureInfo * out_info = NULL);
+
+// Load a pre-compressed ETC1 .KTX (with its mip chain) or .PKM made by tools/etc1convert.
+// Returns 0 when the file is missing or the GPU has no ETC1, so the caller can fall back.
+GLuint loadETC1(const char * imagepath, TextureInfo * out_info = NULL);
+
+// Load a .KTX with its mip chain built offline (tools/mipconvert or tools/etc1convert),
+// every level is uploaded as it is instead of running glGenerateMipmap. Returns 0 on failure.
+GLuint loadKTX(const char * imagepath, TextureInfo * out_info = NULL);
+
+// Pieces of the loaders for images decoded elsewhere (ktxfile.h, texturedecode.h).
+// False when the GPU can't take the image's format.
+struct TextureImage;
+bool canUploadTextureImage(const TextureImage & image);
+// Uploads one level into the bound texture
+void uploadTextureLevel(const TextureImage & image, size_t level);
+// Sets wrap and filtering on the bound texture once all its levels are in
+void finishTextureUpload(const TextureImage & image, TextureInfo * out_info = NULL);
+
+// Deletes a texture made by the loaders and takes it off the GPU memory accounting (gpumemory.h)
+void deleteTexture(GLuint texture);
 
 // Load a .TGA file using GLFW's own loader
 // openGLES 2.0 on RPi without windows
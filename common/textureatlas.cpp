@@ -0,0 +1,84 @@
+#include <stdio.h>
+
+#include "textureatlas.h"
+#include "gpumemory.h"
+#include "glstate.h"
+
+static void setPageParameters()
+{
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+}
+
+void TextureAtlas::Index()
+{
+	ByName.clear();
+	for(size_t i = 0; i < Regions.size(); i++)
+		ByName[ Regions[i].Name ] = i;
+}
+
+bool TextureAtlas::Load(const char* path)
+{
+	Release();
+	std::vector<std::string> pages;
+	if(!readAtlas(path, pages, Regions))
+		return false;
+
+	for(size_t i = 0; i < pages.size(); i++)
+	{
+		GLuint page = loadKTX(pages[i].c_str());
+		if(!page)
+		{
+			Release();
+			return false;
+		}
+		GGLState.BindTexture(GL_TEXTURE_2D, page);
+		setPageParameters();
+		Pages.push_back(page);
+	}
+	Index();
+	return true;
+}
+
+bool TextureAtlas::Create(const std::vector<AtlasSource>& sources, int page_size, int padding)
+{
+	Release();
+	AtlasLayout layout;
+	if(!buildAtlas(sources, page_size, padding, layout))
+		return false;
+	// no sources, an empty atlas with nothing to upload
+	if(layout.Pages.empty())
+		return true;
+
+	Pages.resize(layout.Pages.size());
+	glGenTextures(Pages.size(), &Pages[0]);
+	for(size_t i = 0; i < Pages.size(); i++)
+	{
+		const AtlasPage& page = layout.Pages[i];
+		GGpuMemory.Reserve(page.Pixels.size());
+		GGLState.BindTexture(GL_TEXTURE_2D, Pages[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page.Width, page.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &page.Pixels[0]);
+		setPageParameters();
+		GGpuMemory.Track(GPU_OBJECT_TEXTURE, Pages[i], GPU_TEXTURES, page.Pixels.size());
+	}
+	Regions.swap(layout.Regions);
+	Index();
+	return true;
+}
+
+void TextureAtlas::Release()
+{
+	for(size_t i = 0; i < Pages.size(); i++)
+		deleteTexture(Pages[i]);
+	Pages.clear();
+	Regions.clear();
+	ByName.clear();
+}
+
+const AtlasRegion* TextureAtlas::Find(const char* name) const
+{
+	std::map<std::string, size_t>::const_iterator it = ByName.find(name);
+	return it == ByName.end() ? NULL : &Regions[it->second];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "texture.h"
+#include "atlaspacker.h"
+
+// Atlas pages on the GPU plus the UV rect of every image in them, so a batch of quads
+// can draw many sprites with one bind per page. Pages are clamped, linear filtered, no mips.
+// GL thread only.
+class TextureAtlas
+{
+	std::vector<GLuint> Pages;
+	std::vector<AtlasRegion> Regions;
+	std::map<std::string, size_t> ByName;
+
+	void Index();
+
+public:
+
+	TextureAtlas() {}
+	~TextureAtlas() {}
+
+	// Release is not left to the destructor, a global atlas would outlive the context.
+	// From a .atlas written by tools/atlaspack
+	bool Load(const char* path);
+	// Packs the sources here and now, for images only known at runtime
+	bool Create(const std::vector<AtlasSource>& sources, int page_size, int padding);
+	void Release();
+
+	// NULL when there is no such image
+	const AtlasRegion* Find(const char* name) const;
+	const std::vector<AtlasRegion>& GetRegions() const { return Regions; }
+	GLuint GetPage(unsigned int page) const { return Pages[page]; }
+	size_t GetPageCount() const { return Pages.size(); }
+};
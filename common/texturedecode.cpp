@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "texturedecode.h"
+#include "bmpfile.h"
+#include "mipchain.h"
+
+static bool endsWith(const char* s, const char* suffix)
+{
+	size_t n = strlen(s), m = strlen(suffix);
+	return n >= m && strcasecmp(s + n - m, suffix) == 0;
+}
+
+bool decodeTextureFile(const char* path, TextureImage& out_image)
+{
+	if(endsWith(path, ".ktx") || endsWith(path, ".pkm"))
+		return readTextureFile(path, out_image);
+
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(path, rgb, width, height))
+		return false;
+
+	std::vector<MipLevel> mips;
+	buildMipChain(&rgb[0], width, height, 3, MIP_FILTER_BOX, mips);
+	out_image.InternalFormat = KTX_RGB;
+	out_image.Format = KTX_RGB;
+	out_image.Type = KTX_UNSIGNED_BYTE;
+	out_image.Levels.resize(mips.size());
+	for(size_t i = 0; i < mips.size(); i++)
+		setLevelPixels(out_image.Levels[i], &mips[i].Pixels[0], mips[i].Width, mips[i].Height, 3);
+	return true;
+}
+
+TextureDecoder::TextureDecoder()
+	: Busy(0), Stopping(false)
+{
+	pthread_mutex_init(&Lock, NULL);
+	pthread_cond_init(&Wake, NULL);
+}
+
+TextureDecoder::~TextureDecoder()
+{
+	Stop();
+	pthread_cond_destroy(&Wake);
+	pthread_mutex_destroy(&Lock);
+}
+
+bool TextureDecoder::Start(int threads)
+{
+	if(IsStarted())
+		return true;
+	if(threads <= 0)
+	{
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 1 ? (int)cores - 1 : 1;
+	}
+
+	Stopping = false;
+	for(int i = 0; i < threads; i++)
+	{
+		pthread_t thread;
+		if(pthread_create(&thread, NULL, threadMain, this) != 0)
+			break;
+		Threads.push_back(thread);
+	}
+	if(Threads.empty())
+	{
+		printf("Could not start any texture decode threads\n");
+		return false;
+	}
+	return true;
+}
+
+void TextureDecoder::Stop()
+{
+	pthread_mutex_lock(&Lock);
+	Stopping = true;
+	pthread_cond_broadcast(&Wake);
+	pthread_mutex_unlock(&Lock);
+
+	for(size_t i = 0; i < Threads.size(); i++)
+		pthread_join(Threads[i], NULL);
+	Threads.clear();
+
+	// nothing will decode what is left, hand it back failed
+	pthread_mutex_lock(&Lock);
+	while(!Queue.empty())
+	{
+		Queue.front()->Ok = false;
+		Finished.push_back(Queue.front());
+		Queue.pop_front();
+	}
+	pthread_mutex_unlock(&Lock);
+}
+
+void* TextureDecoder::threadMain(void* arg)
+{
+	TextureDecoder* decoder = (TextureDecoder*)arg;
+	pthread_mutex_lock(&decoder->Lock);
+	for(;;)
+	{
+		while(decoder->Queue.empty() && !decoder->Stopping)
+			pthread_cond_wait(&decoder->Wake, &decoder->Lock);
+		if(decoder->Stopping)
+			break;
+
+		TextureDecodeJob* job = decoder->Queue.front();
+		decoder->Queue.pop_front();
+		decoder->Busy++;
+		pthread_mutex_unlock(&decoder->Lock);
+
+		job->Ok = decodeTextureFile(job->Path.c_str(), job->Image);
+
+		pthread_mutex_lock(&decoder->Lock);
+		decoder->Busy--;
+		decoder->Finished.push_back(job);
+	}
+	pthread_mutex_unlock(&decoder->Lock);
+	return NULL;
+}
+
+void TextureDecoder::Push(TextureDecodeJob* job)
+{
+	pthread_mutex_lock(&Lock);
+	Queue.push_back(job);
+	pthread_cond_signal(&Wake);
+	pthread_mutex_unlock(&Lock);
+}
+
+void TextureDecoder::TakeFinished(std::vector<TextureDecodeJob*>& out_jobs)
+{
+	pthread_mutex_lock(&Lock);
+	out_jobs.insert(out_jobs.end(), Finished.begin(), Finished.end());
+	Finished.clear();
+	pthread_mutex_unlock(&Lock);
+}
+
+size_t TextureDecoder::GetPendingCount()
+{
+	pthread_mutex_lock(&Lock);
+	size_t count = Queue.size() + Busy;
+	pthread_mutex_unlock(&Lock);
+	return count;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <pthread.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ktxfile.h"
+
+// Reads a texture file into memory ready for uploading, with a full mip chain.
+// .ktx and .pkm come as stored, anything else is read as a .bmp and its mip chain is
+// box filtered on the CPU (mipchain.h), so the GL thread never runs glGenerateMipmap.
+// No GL here, it runs on the decode threads.
+bool decodeTextureFile(const char* path, TextureImage& out_image);
+
+struct TextureDecodeJob
+{
+	std::string Path;
+	void* UserData;        // the owner's, untouched
+	TextureImage Image;    // filled in by the decode thread
+	bool Ok;
+};
+
+// A pool of threads running decodeTextureFile on queued jobs, first in first out.
+// Jobs are owned by the caller, they come back through TakeFinished.
+class TextureDecoder
+{
+	pthread_mutex_t Lock;
+	pthread_cond_t Wake;
+	std::deque<TextureDecodeJob*> Queue;
+	std::vector<TextureDecodeJob*> Finished;
+	std::vector<pthread_t> Threads;
+	size_t Busy;
+	bool Stopping;
+
+	static void* threadMain(void* arg);
+
+public:
+
+	TextureDecoder();
+	~TextureDecoder();
+
+	// threads <= 0 uses one less than the number of cores, leaving one for the GL thread
+	bool Start(int threads);
+	// Waits for the jobs being decoded, queued ones are dropped into the finished list with Ok false
+	void Stop();
+	bool IsStarted() { return !Threads.empty(); }
+
+	void Push(TextureDecodeJob* job);
+	// Appends the jobs done since the last call, never blocks
+	void TakeFinished(std::vector<TextureDecodeJob*>& out_jobs);
+	// Queued plus being decoded
+	size_t GetPendingCount();
+};
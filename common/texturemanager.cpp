@@ -0,0 +1,396 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include "texturemanager.h"
+#include "gpumemory.h"
+#include "glstate.h"
+
+struct TextureEntry
+{
+	std::string Key;
+	std::string Path;      // as given, to reload it after an eviction
+	GLuint Texture;
+	unsigned int Flags;
+	TextureInfo Info;
+	unsigned int References;
+	bool Pending;          // async load in flight, Texture is the placeholder
+	bool Evicted;          // freed to fit the GPU memory budget, reloaded by the next Get
+};
+
+TextureHandle::TextureHandle(TextureManager* manager, TextureEntry* entry)
+	: Manager(manager), Entry(entry)
+{
+	if(Entry)
+		Manager->AddReference(Entry);
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other)
+	: Manager(other.Manager), Entry(other.Entry)
+{
+	if(Entry)
+		Manager->AddReference(Entry);
+}
+
+TextureHandle& TextureHandle::operator=(const TextureHandle& other)
+{
+	// take the new reference first, other may be holding the last one to our entry
+	if(other.Entry)
+		other.Manager->AddReference(other.Entry);
+	Reset();
+	Manager = other.Manager;
+	Entry = other.Entry;
+	return *this;
+}
+
+void TextureHandle::Reset()
+{
+	if(Entry)
+		Manager->Release(Entry);
+	Manager = NULL;
+	Entry = NULL;
+}
+
+GLuint TextureHandle::Get() const
+{
+	if(!Entry)
+		return 0;
+	if(Entry->Evicted)
+		Manager->Reload(Entry);
+	else
+		GGpuMemory.Touch(GPU_OBJECT_TEXTURE, Entry->Texture);
+	return Entry->Texture;
+}
+
+const TextureInfo& TextureHandle::GetInfo() const
+{
+	static const TextureInfo empty = { 0, 0, 0, 0 };
+	return Entry ? Entry->Info : empty;
+}
+
+bool TextureHandle::IsReady() const
+{
+	// a failed async load keeps the placeholder and no levels
+	return Entry && Entry->Info.Levels != 0;
+}
+
+static bool endsWith(const char* s, const char* suffix)
+{
+	size_t n = strlen(s), m = strlen(suffix);
+	return n >= m && strcasecmp(s + n - m, suffix) == 0;
+}
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static GLuint loadTexture(const char* path, TextureInfo* out_info)
+{
+	if(endsWith(path, ".ktx"))
+		return loadKTX(path, out_info);
+	if(endsWith(path, ".pkm"))
+		return loadETC1(path, out_info);
+	return loadBMP_custom(path, out_info);
+}
+
+// "a.bmp", "./a.bmp" and "../dir/a.bmp" are one texture
+static std::string textureKey(const char* path, unsigned int flags)
+{
+	char canonical[PATH_MAX];
+	std::string key = realpath(path, canonical) ? canonical : path;
+	char options[16];
+	snprintf(options, sizeof(options), "|%x", flags);
+	return key + options;
+}
+
+// On the bound texture, after the loader has set its own wrap and filtering
+static void applyFlags(unsigned int flags)
+{
+	if(flags & TEXTURE_CLAMP)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	if(flags & TEXTURE_NEAREST)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	}
+}
+
+TextureManager::TextureManager()
+	: ResidentBytes(0), PeakBytes(0), DecodeThreads(0), PendingCount(0), Placeholder(0)
+{
+	ResetStats();
+}
+
+TextureManager::~TextureManager()
+{
+	// finish the decodes in flight and drop everything not uploaded yet
+	Decoder.Stop();
+	Decoder.TakeFinished(Decoded);
+	for(size_t i = 0; i < Decoded.size(); i++)
+		delete Decoded[i];
+	for(size_t i = 0; i < Uploads.size(); i++)
+	{
+		deleteTexture(Uploads[i].Texture);
+		delete Uploads[i].Job;
+	}
+
+	size_t referenced = 0;
+	for(std::map<std::string, TextureEntry*>::iterator it = Entries.begin(); it != Entries.end(); ++it)
+	{
+		TextureEntry* entry = it->second;
+		// loads in flight hold a reference of their own
+		referenced += entry->References > (entry->Pending ? 1u : 0u);
+		if(entry->Texture != Placeholder)
+			deleteTexture(entry->Texture);
+		delete entry;
+	}
+	if(referenced)
+		printf("TextureManager destroyed with %u textures still referenced\n", (unsigned)referenced);
+	deleteTexture(Placeholder);
+}
+
+TextureHandle TextureManager::Load(const char* path, unsigned int flags)
+{
+	std::string key = textureKey(path, flags);
+	std::map<std::string, TextureEntry*>::iterator found = Entries.find(key);
+	if(found != Entries.end())
+	{
+		Hits++;
+		return TextureHandle(this, found->second);
+	}
+
+	Misses++;
+	TextureInfo info;
+	GLuint texture = loadTexture(path, &info);
+	// failures are not cached, the file may turn up later
+	if(!texture)
+		return TextureHandle();
+	applyFlags(flags);
+
+	TextureEntry* entry = new TextureEntry;
+	entry->Key = key;
+	entry->Path = path;
+	entry->Flags = flags;
+	entry->References = 0;
+	entry->Pending = false;
+	entry->Evicted = false;
+	Entries[key] = entry;
+	FinishLoad(entry, texture, info);
+	return TextureHandle(this, entry);
+}
+
+TextureHandle TextureManager::LoadAsync(const char* path, unsigned int flags)
+{
+	std::string key = textureKey(path, flags);
+	std::map<std::string, TextureEntry*>::iterator found = Entries.find(key);
+	if(found != Entries.end())
+	{
+		Hits++;
+		return TextureHandle(this, found->second);
+	}
+
+	Misses++;
+	if(!Decoder.IsStarted() && !Decoder.Start(DecodeThreads))
+		return Load(path, flags);
+
+	TextureEntry* entry = new TextureEntry;
+	entry->Key = key;
+	entry->Path = path;
+	entry->Flags = flags;
+	entry->References = 0;
+	entry->Evicted = false;
+	Entries[key] = entry;
+	StartDecode(entry);
+	return TextureHandle(this, entry);
+}
+
+void TextureManager::StartDecode(TextureEntry* entry)
+{
+	if(!Placeholder)
+	{
+		static const unsigned char grey[3] = { 128, 128, 128 };
+		glGenTextures(1, &Placeholder);
+		GGLState.BindTexture(GL_TEXTURE_2D, Placeholder);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		GGpuMemory.Track(GPU_OBJECT_TEXTURE, Placeholder, GPU_TEXTURES, sizeof(grey));
+	}
+
+	// the load holds a reference until it is done, so the entry outlives its handles if need be
+	entry->Texture = Placeholder;
+	memset(&entry->Info, 0, sizeof(entry->Info));
+	entry->References++;
+	entry->Pending = true;
+
+	TextureDecodeJob* job = new TextureDecodeJob;
+	job->Path = entry->Path;
+	job->UserData = entry;
+	job->Ok = false;
+	Decoder.Push(job);
+	PendingCount++;
+}
+
+void TextureManager::Reload(TextureEntry* entry)
+{
+	entry->Evicted = false;
+	Reloads++;
+	if(Decoder.IsStarted() || Decoder.Start(DecodeThreads))
+	{
+		StartDecode(entry);
+		return;
+	}
+
+	// no threads, load it now and keep the placeholder if that fails
+	TextureInfo info;
+	GLuint texture = loadTexture(entry->Path.c_str(), &info);
+	if(texture)
+	{
+		applyFlags(entry->Flags);
+		FinishLoad(entry, texture, info);
+	}
+}
+
+static void evictTexture(void* owner, unsigned int name)
+{
+	((TextureManager*)owner)->Evict(name);
+}
+
+void TextureManager::Evict(GLuint texture)
+{
+	// evictions are rare next to lookups, no need for a second map
+	for(std::map<std::string, TextureEntry*>::iterator it = Entries.begin(); it != Entries.end(); ++it)
+	{
+		TextureEntry* entry = it->second;
+		if(entry->Texture != texture || entry->Pending)
+			continue;
+
+		deleteTexture(texture);
+		ResidentBytes -= entry->Info.Bytes;
+		memset(&entry->Info, 0, sizeof(entry->Info));
+		entry->Texture = Placeholder;
+		entry->Evicted = true;
+		Evictions++;
+		return;
+	}
+}
+
+void TextureManager::Update(size_t max_bytes, double max_ms)
+{
+	if(!PendingCount)
+		return;
+
+	Decoder.TakeFinished(Decoded);
+	for(size_t i = 0; i < Decoded.size(); i++)
+	{
+		TextureDecodeJob* job = Decoded[i];
+		if(job->Ok && canUploadTextureImage(job->Image))
+		{
+			PendingUpload upload = { job, 0, 0 };
+			Uploads.push_back(upload);
+			continue;
+		}
+
+		// the placeholder stays, like a failed Load it is not cached
+		printf("Could not load %s\n", job->Path.c_str());
+		TextureEntry* entry = (TextureEntry*)job->UserData;
+		entry->Pending = false;
+		Entries.erase(entry->Key);
+		entry->Key.clear();
+		PendingCount--;
+		Release(entry);
+		delete job;
+	}
+	Decoded.clear();
+
+	double start = now();
+	size_t bytes = 0;
+	while(!Uploads.empty())
+	{
+		PendingUpload& upload = Uploads.front();
+		const TextureImage& image = upload.Job->Image;
+		size_t size = image.Levels[upload.NextLevel].Data.size();
+		if(bytes && (bytes + size > max_bytes || (now() - start) * 1000.0 >= max_ms))
+			break;
+
+		if(!upload.Texture)
+		{
+			size_t total = 0;
+			for(size_t level = 0; level < image.Levels.size(); level++)
+				total += image.Levels[level].Data.size();
+			GGpuMemory.Reserve(total);
+			glGenTextures(1, &upload.Texture);
+		}
+		GGLState.BindTexture(GL_TEXTURE_2D, upload.Texture);
+		uploadTextureLevel(image, upload.NextLevel++);
+		bytes += size;
+		BytesUploaded += size;
+		if(upload.NextLevel < image.Levels.size())
+			continue;
+
+		TextureEntry* entry = (TextureEntry*)upload.Job->UserData;
+		TextureInfo info;
+		finishTextureUpload(image, &info);
+		applyFlags(entry->Flags);
+		FinishLoad(entry, upload.Texture, info);
+		delete upload.Job;
+		Uploads.pop_front();
+		PendingCount--;
+		Release(entry);
+	}
+}
+
+void TextureManager::FinishLoad(TextureEntry* entry, GLuint texture, const TextureInfo& info)
+{
+	entry->Texture = texture;
+	entry->Info = info;
+	entry->Pending = false;
+	GGpuMemory.Track(GPU_OBJECT_TEXTURE, texture, GPU_TEXTURES, info.Bytes, evictTexture, this);
+	ResidentBytes += info.Bytes;
+	if(ResidentBytes > PeakBytes)
+		PeakBytes = ResidentBytes;
+}
+
+void TextureManager::AddReference(TextureEntry* entry)
+{
+	entry->References++;
+}
+
+void TextureManager::Release(TextureEntry* entry)
+{
+	if(--entry->References)
+		return;
+	if(entry->Texture != Placeholder)
+		deleteTexture(entry->Texture);
+	ResidentBytes -= entry->Info.Bytes;
+	// a failed async load has already left the map
+	if(!entry->Key.empty())
+		Entries.erase(entry->Key);
+	delete entry;
+}
+
+void TextureManager::PrintStats(const char* label)
+{
+	unsigned long long lookups = Hits + Misses;
+	printf("%s: %u textures (%u loading), %.1f KB resident (peak %.1f KB), %llu hits, %llu misses (%.1f%% hit rate), %llu evicted, %llu reloaded\n",
+		label, (unsigned)Entries.size(), (unsigned)PendingCount, ResidentBytes / 1024.0, PeakBytes / 1024.0, Hits, Misses,
+		lookups ? 100.0 * Hits / lookups : 0.0, Evictions, Reloads);
+}
+
+void TextureManager::ResetStats()
+{
+	Hits = 0;
+	Misses = 0;
+	BytesUploaded = 0;
+	Evictions = 0;
+	Reloads = 0;
+	PeakBytes = ResidentBytes;
+}
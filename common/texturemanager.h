@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "texture.h"
+#include "texturedecode.h"
+
+// Texture loading option bits, part of the cache key so one image can be
+// loaded twice with different settings
+enum TextureLoadFlags
+{
+	TEXTURE_CLAMP    = 1,   // GL_CLAMP_TO_EDGE instead of GL_REPEAT
+	TEXTURE_NEAREST  = 2,   // no filtering, for pixel art and lookup tables
+};
+
+class TextureManager;
+struct TextureEntry;
+
+// One reference to a texture owned by a TextureManager. Copies add a reference, the GL
+// texture is deleted when the last one goes. An empty handle (failed load) has Get() == 0.
+// While an async load is in flight Get() gives a 1x1 grey placeholder and IsReady() is false.
+// Get() marks the texture used for the GPU memory budget, call it each frame it is drawn.
+class TextureHandle
+{
+	friend class TextureManager;
+
+	TextureManager* Manager;
+	TextureEntry* Entry;
+
+	TextureHandle(TextureManager* manager, TextureEntry* entry);
+
+public:
+
+	TextureHandle() : Manager(NULL), Entry(NULL) {}
+	TextureHandle(const TextureHandle& other);
+	TextureHandle& operator=(const TextureHandle& other);
+	~TextureHandle() { Reset(); }
+
+	void Reset();
+	GLuint Get() const;
+	const TextureInfo& GetInfo() const;
+	bool IsValid() const { return Entry != NULL; }
+	bool IsReady() const;
+};
+
+// Loads each image once per set of flags, keyed by its canonical path, and hands out
+// refcounted handles. The loader goes by extension: .ktx (loadKTX), .pkm (loadETC1),
+// anything else as a .bmp. GL thread only, like the loaders.
+// Every handle must be gone before the manager is destroyed.
+//
+// LoadAsync hands the file to a pool of decode threads and returns at once. Update, called
+// once a frame on the GL thread, uploads what has been decoded a mip level at a time
+// within a byte and time budget, so streaming textures in doesn't hitch the frame.
+//
+// Loaded textures are evictable in GGpuMemory: when an allocation needs the room, the least
+// recently drawn is deleted and its handles fall back to the placeholder until the next Get
+// reloads it (asynchronously when the decode threads can be started).
+class TextureManager
+{
+	friend class TextureHandle;
+
+	// A decoded image part way through being uploaded
+	struct PendingUpload
+	{
+		TextureDecodeJob* Job;
+		GLuint Texture;
+		size_t NextLevel;
+	};
+
+	std::map<std::string, TextureEntry*> Entries;
+	size_t ResidentBytes;
+	size_t PeakBytes;
+
+	TextureDecoder Decoder;
+	int DecodeThreads;
+	std::deque<PendingUpload> Uploads;
+	std::vector<TextureDecodeJob*> Decoded;
+	size_t PendingCount;
+	GLuint Placeholder;
+
+	void AddReference(TextureEntry* entry);
+	void Release(TextureEntry* entry);
+	void FinishLoad(TextureEntry* entry, GLuint texture, const TextureInfo& info);
+	void StartDecode(TextureEntry* entry);
+	void Reload(TextureEntry* entry);
+
+public:
+
+	unsigned long long Hits;
+	unsigned long long Misses;
+	unsigned long long BytesUploaded;   // by Update
+	unsigned long long Evictions;
+	unsigned long long Reloads;
+
+	TextureManager();
+	~TextureManager();
+
+	TextureHandle Load(const char* path, unsigned int flags = 0);
+	TextureHandle LoadAsync(const char* path, unsigned int flags = 0);
+
+	// Uploads decoded textures until max_bytes or max_ms is used up. At least one mip level
+	// goes up per call so a level bigger than the budget still gets through.
+	void Update(size_t max_bytes, double max_ms);
+	// Async loads not yet uploaded
+	size_t GetPendingCount() { return PendingCount; }
+	// Decode threads to start on the first LoadAsync, 0 for one less than the number of cores
+	void SetDecodeThreads(int threads) { DecodeThreads = threads; }
+	// Called by GGpuMemory to free a texture for the budget
+	void Evict(GLuint texture);
+
+	size_t GetTextureCount() { return Entries.size(); }
+	size_t GetResidentBytes() { return ResidentBytes; }
+	size_t GetPeakBytes() { return PeakBytes; }
+
+	void PrintStats(const char* label);
+	void ResetStats();
+};
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vertexlayout.h"
+#include "glstate.h"
+
+GLsizei vertexTypeSize(GLenum type)
+{
+	switch(type)
+	{
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:  return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT: return 2;
+	case GL_FIXED:
+	case GL_FLOAT:          return 4;
+	}
+	assert(!"unknown vertex attribute type");
+	return 0;
+}
+
+void VertexLayout::Add(VertexSemantic semantic, const char* name, GLint size, GLenum type, GLboolean normalized, int offset)
+{
+	assert(NumAttribs < MAX_VERTEX_ATTRIBS);
+	if(offset < 0)
+		offset = Stride;
+
+	VertexAttrib& a = Attribs[NumAttribs++];
+	a.Semantic = semantic;
+	a.Name = name;
+	a.Size = size;
+	a.Type = type;
+	a.Normalized = normalized;
+	a.Offset = offset;
+	a.Location = -1;
+
+	// every attribute (and so every vertex) starts on a 4 byte boundary, the GPU fetches words
+	GLsizei end = (offset + size * vertexTypeSize(type) + 3) & ~3;
+	if(end > Stride)
+		Stride = end;
+}
+
+void VertexLayout::Bind(GLuint program)
+{
+	for(int i = 0; i < NumAttribs; i++)
+		Attribs[i].Location = Attribs[i].Name ? glGetAttribLocation(program, Attribs[i].Name) : -1;
+}
+
+void VertexLayout::Enable(GLuint buffer)
+{
+	GGLState.BindBuffer(GL_ARRAY_BUFFER, buffer);
+	for(int i = 0; i < NumAttribs; i++)
+	{
+		const VertexAttrib& a = Attribs[i];
+		if(a.Location < 0)
+			continue;
+		GGLState.EnableVertexAttribArray(a.Location);
+		glVertexAttribPointer(a.Location, a.Size, a.Type, a.Normalized, Stride, (void*)(size_t)a.Offset);
+	}
+}
+
+void VertexLayout::Disable()
+{
+	for(int i = 0; i < NumAttribs; i++)
+		if(Attribs[i].Location >= 0)
+			GGLState.DisableVertexAttribArray(Attribs[i].Location);
+}
+
+void buildInterleaved(
+	const VertexLayout & layout,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<unsigned char> & out
+){
+	size_t count = vertices.size();
+	GLsizei stride = layout.GetStride();
+	out.assign(count * stride, 0);
+
+	for(int a = 0; a < layout.GetNumAttribs(); a++)
+	{
+		const VertexAttrib& attrib = layout.GetAttrib(a);
+		// only float attributes can be copied straight from the loader output,
+		// integer formats go through quantizeMesh (meshquantize.h)
+		assert(attrib.Type == GL_FLOAT);
+
+		const float* src;
+		int components;
+		switch(attrib.Semantic)
+		{
+		case VERTEX_POSITION: src = count ? &vertices[0].x : NULL; components = 3; break;
+		case VERTEX_UV:       src = count ? &uvs[0].x : NULL;      components = 2; break;
+		default:              src = count ? &normals[0].x : NULL;  components = 3; break;
+		}
+		int copy = attrib.Size < components ? attrib.Size : components;
+
+		unsigned char* dst = count ? &out[attrib.Offset] : NULL;
+		for(size_t i = 0; i < count; i++, src += components, dst += stride)
+			memcpy(dst, src, copy * sizeof(float));
+	}
+}
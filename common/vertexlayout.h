@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GLES2/gl2.h"
+
+#define MAX_VERTEX_ATTRIBS 8
+
+// Which loader output an attribute is filled from
+enum VertexSemantic
+{
+	VERTEX_POSITION,
+	VERTEX_UV,
+	VERTEX_NORMAL
+};
+
+struct VertexAttrib
+{
+	VertexSemantic Semantic;
+	const char* Name;      // attribute name in the shader, NULL keeps the data but binds nothing
+	GLint Size;            // number of components
+	GLenum Type;
+	GLboolean Normalized;
+	GLuint Offset;         // bytes from the start of the vertex
+	GLint Location;        // set by Bind, -1 if the program doesn't use it
+};
+
+// Describes one interleaved vertex buffer, so all the glVertexAttribPointer
+// calls for it happen in one place
+class VertexLayout
+{
+	VertexAttrib Attribs[MAX_VERTEX_ATTRIBS];
+	int NumAttribs;
+	GLsizei Stride;
+
+public:
+
+	VertexLayout() : NumAttribs(0), Stride(0) {}
+	~VertexLayout() {}
+
+	// Appends an attribute, offset -1 packs it after the previous one on a 4 byte boundary
+	void Add(VertexSemantic semantic, const char* name, GLint size, GLenum type, GLboolean normalized = GL_FALSE, int offset = -1);
+	// Looks the attribute locations up once
+	void Bind(GLuint program);
+	// Binds the buffer and points and enables every attribute
+	void Enable(GLuint buffer);
+	void Disable();
+
+	int GetNumAttribs() const { return NumAttribs; }
+	const VertexAttrib& GetAttrib(int i) const { return Attribs[i]; }
+	GLsizei GetStride() const { return Stride; }
+};
+
+// Size in bytes of one component of a GL type
+GLsizei vertexTypeSize(GLenum type);
+
+// Packs loader output (see objloader.h) into one buffer laid out as described
+void buildInterleaved(
+	const VertexLayout & layout,
+	const std::vector<glm::vec3> & vertices,
+	const std::vector<glm::vec2> & uvs,
+	const std::vector<glm::vec3> & normals,
+	std::vector<unsigned char> & out
+);
@@ -0,0 +1,81 @@
+// Packs .bmp images into atlas pages for TextureAtlas::Load
+// usage: atlaspack output.atlas [-size N] [-padding N] image.bmp...
+// Pages are N x N at most (default 1024) and written next to the .atlas as output_0.ktx...
+// Images are named by their file name without the extension.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "../common/bmpfile.h"
+#include "../common/pixelconvert.h"
+#include "../common/atlaspacker.h"
+
+#define DEFAULT_PAGE_SIZE 1024
+#define DEFAULT_PADDING 2
+
+static std::string imageName(const char* path)
+{
+	std::string name = path;
+	size_t slash = name.rfind('/');
+	if(slash != std::string::npos)
+		name.erase(0, slash + 1);
+	size_t dot = name.rfind('.');
+	if(dot != std::string::npos)
+		name.erase(dot);
+	return name;
+}
+
+int main(int argc, const char **argv)
+{
+	int pageSize = DEFAULT_PAGE_SIZE, padding = DEFAULT_PADDING;
+	std::vector<const char*> inputs;
+	for(int i = 2; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+			pageSize = atoi(argv[++i]);
+		else if(strcmp(argv[i], "-padding") == 0 && i + 1 < argc)
+			padding = atoi(argv[++i]);
+		else
+			inputs.push_back(argv[i]);
+	}
+	if(inputs.empty())
+	{
+		printf("usage: %s output.atlas [-size N] [-padding N] image.bmp...\n", argv[0]);
+		return 1;
+	}
+
+	// the atlas is RGBA, .bmp has no alpha so it comes in opaque
+	std::vector<std::vector<unsigned char> > pixels(inputs.size());
+	std::vector<AtlasSource> sources(inputs.size());
+	for(size_t i = 0; i < inputs.size(); i++)
+	{
+		std::vector<unsigned char> rgb;
+		unsigned int width, height;
+		if(!readBMP(inputs[i], rgb, width, height))
+			return 1;
+		pixels[i].resize(width * height * 4);
+		convertRGBToRGBA(&rgb[0], &pixels[i][0], width * height);
+
+		sources[i].Name = imageName(inputs[i]);
+		sources[i].Width = width;
+		sources[i].Height = height;
+		sources[i].Pixels = &pixels[i][0];
+	}
+
+	AtlasLayout layout;
+	if(!buildAtlas(sources, pageSize, padding, layout))
+		return 1;
+	printAtlasReport(layout);
+
+	if(!writeAtlas(argv[1], layout))
+	{
+		printf("Could not write %s\n", argv[1]);
+		return 1;
+	}
+	printf("%s: %u images, %u pages, %u texture binds instead of %u\n", argv[1], (unsigned)layout.Regions.size(),
+		(unsigned)layout.Pages.size(), (unsigned)layout.Pages.size(), (unsigned)layout.Regions.size());
+	return 0;
+}
@@ -0,0 +1,116 @@
+// Compresses a 24 bit .bmp to ETC1 with a full mip chain, for loadETC1
+// usage: etc1convert image.bmp output.ktx [-fast] [-threads N] [-nomips] [-box]
+//        etc1convert image.bmp output.pkm [-fast] [-threads N]
+// .pkm holds level 0 only. -threads 0 (the default) uses every core.
+// The mip levels are Kaiser filtered in linear light, -box averages 2x2 instead.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "../common/bmpfile.h"
+#include "../common/etc1.h"
+#include "../common/ktxfile.h"
+#include "../common/mipchain.h"
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool endsWith(const std::string& s, const char* suffix)
+{
+	size_t n = strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+int main(int argc, const char **argv)
+{
+	if(argc < 3)
+	{
+		printf("usage: %s image.bmp output.ktx [-fast] [-threads N] [-nomips] [-box]\n"
+		       "       %s image.bmp output.pkm [-fast] [-threads N]\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	std::string output = argv[2];
+	bool pkm = endsWith(output, ".pkm");
+	ETC1Quality quality = ETC1_QUALITY_HIGH;
+	int threads = 0;
+	bool mips = !pkm;
+	MipFilter filter = MIP_FILTER_KAISER;
+	for(int i = 3; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-fast") == 0)
+			quality = ETC1_QUALITY_FAST;
+		else if(strcmp(argv[i], "-nomips") == 0)
+			mips = false;
+		else if(strcmp(argv[i], "-box") == 0)
+			filter = MIP_FILTER_BOX;
+		else if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else
+		{
+			printf("Unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(argv[1], rgb, width, height))
+		return 1;
+
+	std::vector<MipLevel> mipLevels;
+	if(mips)
+		buildMipChain(&rgb[0], width, height, 3, filter, mipLevels);
+	else
+	{
+		mipLevels.resize(1);
+		mipLevels[0].Width = width;
+		mipLevels[0].Height = height;
+		mipLevels[0].Pixels.swap(rgb);
+	}
+
+	TextureImage image;
+	image.InternalFormat = KTX_ETC1_RGB8_OES;
+	image.Format = image.Type = 0;
+	image.Levels.resize(mipLevels.size());
+	double encodeTime = 0.0;
+	size_t rawBytes = 0;
+	for(size_t i = 0; i < mipLevels.size(); i++)
+	{
+		const MipLevel& mip = mipLevels[i];
+		TextureLevel& level = image.Levels[i];
+		level.Width = mip.Width;
+		level.Height = mip.Height;
+		double t = now();
+		encodeETC1Image(&mip.Pixels[0], mip.Width, mip.Height, quality, threads, level.Data);
+		encodeTime += now() - t;
+		rawBytes += mip.Pixels.size();
+
+		std::vector<unsigned char> decoded;
+		decodeETC1Image(&level.Data[0], mip.Width, mip.Height, decoded);
+		printf("  level %u: %ux%u, PSNR %.2f dB\n", (unsigned)i, mip.Width, mip.Height,
+			imagePSNR(&mip.Pixels[0], &decoded[0], mip.Width, mip.Height));
+	}
+
+	size_t compressedBytes = 0;
+	for(size_t i = 0; i < image.Levels.size(); i++)
+		compressedBytes += image.Levels[i].Data.size();
+
+	if(!(pkm ? writePKM(output.c_str(), image) : writeKTX(output.c_str(), image)))
+	{
+		printf("Could not write %s\n", output.c_str());
+		return 1;
+	}
+	printf("%s: %u levels, %u bytes (%.1f:1), encoded in %.1f ms\n", output.c_str(),
+		(unsigned)image.Levels.size(), (unsigned)compressedBytes,
+		(double)rawBytes / compressedBytes, encodeTime * 1000.0);
+	return 0;
+}
@@ -0,0 +1,61 @@
+// Bakes the mip chain of a 24 bit .bmp into an uncompressed .ktx, for loadKTX
+// usage: mipconvert image.bmp output.ktx [-box]
+// The levels are Kaiser filtered in linear light, -box averages 2x2 instead.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "../common/bmpfile.h"
+#include "../common/ktxfile.h"
+#include "../common/mipchain.h"
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, const char **argv)
+{
+	if(argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], "-box") != 0))
+	{
+		printf("usage: %s image.bmp output.ktx [-box]\n", argv[0]);
+		return 1;
+	}
+	MipFilter filter = argc == 4 ? MIP_FILTER_BOX : MIP_FILTER_KAISER;
+
+	std::vector<unsigned char> rgb;
+	unsigned int width, height;
+	if(!readBMP(argv[1], rgb, width, height))
+		return 1;
+
+	double t = now();
+	std::vector<MipLevel> mips;
+	buildMipChain(&rgb[0], width, height, 3, filter, mips);
+	t = now() - t;
+
+	TextureImage image;
+	image.InternalFormat = KTX_RGB;
+	image.Format = KTX_RGB;
+	image.Type = KTX_UNSIGNED_BYTE;
+	image.Levels.resize(mips.size());
+	size_t bytes = 0;
+	for(size_t i = 0; i < mips.size(); i++)
+	{
+		setLevelPixels(image.Levels[i], &mips[i].Pixels[0], mips[i].Width, mips[i].Height, 3);
+		bytes += image.Levels[i].Data.size();
+	}
+
+	if(!writeKTX(argv[2], image))
+	{
+		printf("Could not write %s\n", argv[2]);
+		return 1;
+	}
+	printf("%s: %ux%u, %u levels, %u bytes, %s filtered in %.1f ms (%s)\n", argv[2], width, height,
+		(unsigned)mips.size(), (unsigned)bytes, filter == MIP_FILTER_BOX ? "box" : "Kaiser",
+		t * 1000.0, mipChainBackend());
+	return 0;
+}
@@ -0,0 +1,77 @@
+// Converts .obj models into the binary .mesh format loadOBJ caches,
+// or into a chunk file for models too big for one 16 bit index buffer or for memory
+// usage: objconvert model.obj [output.mesh]
+//        objconvert model.obj output.chunks [vertices per chunk]
+// without an output name the cache is written next to the model, where loadOBJ looks for it
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/objloader.h"
+#include "../common/meshfile.h"
+#include "../common/meshpartition.h"
+#include "../common/chunkfile.h"
+
+static bool endsWith(const std::string& s, const char* suffix)
+{
+	size_t n = strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static int convertChunks(const char* objpath, const std::string& output, unsigned int chunk_vertices)
+{
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(objpath, indices, vertices, uvs, normals) || indices.empty())
+		return 1;
+
+	std::vector<MeshChunk> chunks;
+	partitionMesh(&indices[0], indices.size(), vertices, chunk_vertices, chunks);
+	printPartitionReport(chunks, vertices.size());
+
+	if(!writeChunkFile(output.c_str(), chunks, vertices, uvs, normals))
+	{
+		printf("Could not write %s\n", output.c_str());
+		return 1;
+	}
+	printf("%s: %u chunks of up to %u vertices\n", output.c_str(), (unsigned)chunks.size(), chunk_vertices);
+	return 0;
+}
+
+int main(int argc, const char **argv)
+{
+	if(argc < 2 || argc > 4)
+	{
+		printf("usage: %s model.obj [output.mesh]\n"
+		       "       %s model.obj output.chunks [vertices per chunk]\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	std::string output = argc > 2 ? argv[2] : meshCachePath(argv[1]);
+	if(endsWith(output, ".chunks"))
+		return convertChunks(argv[1], output, argc > 3 ? atoi(argv[3]) : DEFAULT_CHUNK_VERTICES);
+
+	std::vector<unsigned short> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	if(!loadOBJIndexed(argv[1], indices, vertices, uvs, normals))
+		return 1;
+
+	if(!writeMeshFile(output.c_str(), indices, vertices, uvs, normals))
+	{
+		printf("Could not write %s\n", output.c_str());
+		return 1;
+	}
+
+	printf("%s: %u vertices, %u triangles, %u bytes\n", output.c_str(),
+		(unsigned)vertices.size(), (unsigned)indices.size() / 3,
+		(unsigned)(vertices.size() * sizeof(MeshVertex) + indices.size() * sizeof(unsigned short)));
+	return 0;
+}
@@ -0,0 +1,104 @@
+// Turns GLSL files into a header of string constants, so a program needs no shader files
+// at run time. Run by the embed_shaders CMake function.
+// usage: shaderembed output.h shader.glsl...
+// Comments and extra whitespace are stripped first (minifyShaderSource), the header holds
+// a table GEmbeddedShaders of { file name, source } for findShaderSource and LoadShaders.
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+#include "../common/shadersource.h"
+
+static std::string baseName(const char* path)
+{
+	const char* slash = strrchr(path, '/');
+	return slash ? slash + 1 : path;
+}
+
+// "TransformVertexShader.glsl" -> GShader_TransformVertexShader_glsl
+static std::string variableName(const std::string& name)
+{
+	std::string out = "GShader_";
+	for(size_t i = 0; i < name.size(); i++)
+		out += isalnum((unsigned char)name[i]) ? name[i] : '_';
+	return out;
+}
+
+// One literal per line of the source, long lines broken up, the compiler joins them
+static void writeLiteral(FILE* f, const std::string& s)
+{
+	const size_t width = 100;
+	size_t column = 0;
+	fprintf(f, "\t\"");
+	for(size_t i = 0; i < s.size(); i++)
+	{
+		char c = s[i];
+		if(c == '\n')
+			fprintf(f, "\\n");
+		else if(c == '"' || c == '\\')
+			fprintf(f, "\\%c", c);
+		else if(c == '\t')
+			fprintf(f, "\\t");
+		else
+			fputc(c, f);
+		column++;
+		if(i + 1 < s.size() && (c == '\n' || column >= width))
+		{
+			fprintf(f, "\"\n\t\"");
+			column = 0;
+		}
+	}
+	fprintf(f, "\";\n");
+}
+
+int main(int argc, const char **argv)
+{
+	if(argc < 3)
+	{
+		printf("usage: %s output.h shader.glsl...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<std::string> names, sources;
+	size_t before = 0, after = 0;
+	for(int i = 2; i < argc; i++)
+	{
+		std::string source, minified;
+		if(!readShaderFile(argv[i], source))
+		{
+			printf("Could not read %s\n", argv[i]);
+			return 1;
+		}
+		minifyShaderSource(source.c_str(), minified);
+		before += source.size();
+		after += minified.size();
+		names.push_back(baseName(argv[i]));
+		sources.push_back(minified);
+	}
+
+	FILE* f = fopen(argv[1], "w");
+	if(!f)
+	{
+		printf("Could not write %s\n", argv[1]);
+		return 1;
+	}
+	fprintf(f, "// Generated by tools/shaderembed, do not edit\n#pragma once\n\n#include \"shadersource.h\"\n\n");
+	for(size_t i = 0; i < names.size(); i++)
+	{
+		fprintf(f, "static const char %s[] =\n", variableName(names[i]).c_str());
+		writeLiteral(f, sources[i]);
+		fprintf(f, "\n");
+	}
+	fprintf(f, "static const EmbeddedShader GEmbeddedShaders[] =\n{\n");
+	for(size_t i = 0; i < names.size(); i++)
+		fprintf(f, "\t{ \"%s\", %s },\n", names[i].c_str(), variableName(names[i]).c_str());
+	fprintf(f, "\t{ NULL, NULL }\n};\n");
+	bool ok = fclose(f) == 0;
+
+	printf("Embedded %u shaders in %s, %u bytes of source down to %u\n",
+		(unsigned)names.size(), argv[1], (unsigned)before, (unsigned)after);
+	return ok ? 0 : 1;
+}
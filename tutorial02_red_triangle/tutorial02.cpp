@@ -2,13 +2,15 @@
 #include <unistd.h>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "embedded_shaders.h"
 
 int main(int argc, const char **argv)
 {
         InitGraphics();
         printf("Screen started\n");
         // Create and compile our GLSL program from the shaders
-        GLuint programID = LoadShaders( "simplevertshader.glsl", "simplefragshader.glsl" );
+        GLuint programID = LoadShaders( GEmbeddedShaders, "simplevertshader.glsl", "simplefragshader.glsl" );
         printf("Shaders loaded\n");
 
         GLfloat g_vertex_buffer_data[] = { 
@@ -26,7 +28,7 @@ int main(int argc, const char **argv)
                 glClear( GL_COLOR_BUFFER_BIT );
 
                 // Use our shader
-                glUseProgram(programID);
+                GGLState.UseProgram(programID);
 
                 // 1rst attribute buffer : vertices
 //                glEnableVertexAttribArray(vertexPosition_modelspaceID);
@@ -50,7 +52,7 @@ uint32_t GScreenWidth = 1920;
 uint32_t GScreenHeight = 1080;
 
         void* image = malloc(GScreenWidth*GScreenHeight*4);
-        glBindFramebuffer(GL_FRAMEBUFFER,0);
+        GGLState.BindFramebuffer(GL_FRAMEBUFFER,0);
         glReadPixels(0,0,GScreenWidth,GScreenHeight, GL_RGBA, GL_UNSIGNED_BYTE, image); //GScreenWidth,GScreenHeight,
 
         updateScreen();
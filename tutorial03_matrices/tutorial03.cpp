@@ -2,6 +2,9 @@
 #include <unistd.h>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "../common/gpumemory.h"
+#include "embedded_shaders.h"
 
 // Include GLM
 #include <glm/glm.hpp>
@@ -13,7 +16,7 @@ int main(int argc, const char **argv)
         InitGraphics();
         printf("Screen started\n");
         // Create and compile our GLSL program from the shaders
-        GLuint programID = LoadShaders( "simpletransformvertshader.glsl", "simplefragshader.glsl" );
+        GLuint programID = LoadShaders( GEmbeddedShaders, "simpletransformvertshader.glsl", "simplefragshader.glsl" );
         printf("Shaders loaded\n");
 
    // Get a handle for our "MVP" uniform
@@ -47,10 +50,7 @@ int main(int argc, const char **argv)
 
    // Set the viewport 
 //   glViewport ( 0, 0, GScreenWidth, GScreenHeight );
-        GLuint vertexbuffer;
-        glGenBuffers(1, &vertexbuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
+        GLuint vertexbuffer = createBuffer(GL_ARRAY_BUFFER, g_vertex_buffer_data, sizeof(g_vertex_buffer_data));
 
         do{
 
@@ -58,15 +58,15 @@ int main(int argc, const char **argv)
                 glClear( GL_COLOR_BUFFER_BIT );
 
                 // Use our shader
-                glUseProgram(programID);
+                GGLState.UseProgram(programID);
 
                 // Send our transformation to the currently bound shader, 
                 // in the "MVP" uniform
                 glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
 
                 // 1rst attribute buffer : vertices
-                glEnableVertexAttribArray(vertexPosition_modelspaceID);
-                glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+                GGLState.EnableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.BindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
                 glVertexAttribPointer(
                         vertexPosition_modelspaceID, // The attribute we want to configure
                         3,                  // size
@@ -82,15 +82,15 @@ int main(int argc, const char **argv)
                 // Draw the triangle !
                 glDrawArrays(GL_TRIANGLES, 0, 3); // 3 indices starting at 0 -> 1 triangle
 
-                glDisableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.DisableVertexAttribArray(vertexPosition_modelspaceID);
 
         updateScreen();
         }
         while(1);
 
         // Cleanup VBO
-        glDeleteBuffers(1, &vertexbuffer);
-        glDeleteProgram(programID);
+        deleteBuffer(vertexbuffer);
+        GGLState.DeleteProgram(programID);
 
 
 }
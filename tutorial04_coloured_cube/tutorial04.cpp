@@ -2,6 +2,9 @@
 #include <unistd.h>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "../common/gpumemory.h"
+#include "embedded_shaders.h"
 
 // Include GLM
 #include <glm/glm.hpp>
@@ -14,12 +17,12 @@ int main(int argc, const char **argv)
         printf("Screen started\n");
 
         // Enable depth test
-        glEnable(GL_DEPTH_TEST);
+        GGLState.Enable(GL_DEPTH_TEST);
         // Accept fragment if it closer to the camera than the former one
-        glDepthFunc(GL_LESS); 
+        GGLState.DepthFunc(GL_LESS); 
 
         // Create and compile our GLSL program from the shaders
-        GLuint programID = LoadShaders( "transformvertshader.glsl", "colourfragshader.glsl" );
+        GLuint programID = LoadShaders( GEmbeddedShaders, "transformvertshader.glsl", "colourfragshader.glsl" );
         printf("Shaders loaded\n");
 
    // Get a handle for our "MVP" uniform
@@ -128,15 +131,9 @@ int main(int argc, const char **argv)
 
    // Set the viewport 
 //   glViewport ( 0, 0, GScreenWidth, GScreenHeight );
-        GLuint vertexbuffer;
-        glGenBuffers(1, &vertexbuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
+        GLuint vertexbuffer = createBuffer(GL_ARRAY_BUFFER, g_vertex_buffer_data, sizeof(g_vertex_buffer_data));
 
-        GLuint colorbuffer;
-        glGenBuffers(1, &colorbuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_color_buffer_data), g_color_buffer_data, GL_STATIC_DRAW);
+        GLuint colorbuffer = createBuffer(GL_ARRAY_BUFFER, g_color_buffer_data, sizeof(g_color_buffer_data));
 
         do{
 
@@ -144,15 +141,15 @@ int main(int argc, const char **argv)
                 glClear( GL_COLOR_BUFFER_BIT| GL_DEPTH_BUFFER_BIT);
 
                 // Use our shader
-                glUseProgram(programID);
+                GGLState.UseProgram(programID);
 
                 // Send our transformation to the currently bound shader, 
                 // in the "MVP" uniform
                 glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
 
                 // 1rst attribute buffer : vertices
-                glEnableVertexAttribArray(vertexPosition_modelspaceID);
-                glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+                GGLState.EnableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.BindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
                 glVertexAttribPointer(
                         vertexPosition_modelspaceID, //vertexPosition_modelspaceID, // The attribute we want to configure
                         3,                  // size
@@ -163,8 +160,8 @@ int main(int argc, const char **argv)
                 );
 
                 // 2nd attribute buffer : colors
-                glEnableVertexAttribArray(vertexColorID);
-                glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
+                GGLState.EnableVertexAttribArray(vertexColorID);
+                GGLState.BindBuffer(GL_ARRAY_BUFFER, colorbuffer);
                 glVertexAttribPointer(
                         vertexColorID,               // The attribute we want to configure
                         3,                           // size
@@ -177,17 +174,17 @@ int main(int argc, const char **argv)
                 // Draw the triangle !
                 glDrawArrays(GL_TRIANGLES, 0, 12*3); // 3 indices starting at 0 -> 1 triangle
 
-                glDisableVertexAttribArray(vertexPosition_modelspaceID);
-                glDisableVertexAttribArray(vertexColorID);
+                GGLState.DisableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.DisableVertexAttribArray(vertexColorID);
 
                 updateScreen();
         }
         while(1);
 
         // Cleanup VBO
-        glDeleteBuffers(1, &vertexbuffer);
-        glDeleteBuffers(1, &colorbuffer);
-        glDeleteProgram(programID);
+        deleteBuffer(vertexbuffer);
+        deleteBuffer(colorbuffer);
+        GGLState.DeleteProgram(programID);
 
 
 }
@@ -71,8 +71,14 @@ int main(int argc, const char **argv)
 		BeginFrame();
 
                     DrawYUVTextureRect(&ytexture,&utexture,&vtexture,-1.f,-1.f,1.f,1.f,&rgbtextures[0],0);
-                    if(GfxTexture* tex = texture_grid[0])  
-                        DrawTextureRect(tex,-1,-1,1,1,NULL,0,0.0,0.0); // width and height set = 0.25 in graphics.cpp
+                    // the grid goes out side by side in one batch, one draw per texture
+                    GSpriteBatch.Begin();
+                    for(int i = 0; i < next_texture_grid_entry; i++)
+                    {
+                        float w = 2.0f / next_texture_grid_entry;
+                        GSpriteBatch.Draw(texture_grid[i]->GetId(),-1+i*w,-1,-1+(i+1)*w,1);
+                    }
+                    GSpriteBatch.End();
 
 		EndFrame();
 	}
@@ -2,6 +2,8 @@
 #include <unistd.h>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "embedded_shaders.h"
 #include "../common/texture.h"
 
 int main(int argc, const char **argv)
@@ -9,7 +11,7 @@ int main(int argc, const char **argv)
         InitGraphics();
         printf("Screen started\n");
         // Create and compile our GLSL program from the shaders
-        GLuint programID = LoadShaders( "simplevertshader.glsl", "texturefragshader.glsl" );
+        GLuint programID = LoadShaders( GEmbeddedShaders, "simplevertshader.glsl", "texturefragshader.glsl" );
         printf("Shaders loaded\n");
 
         // Load the texture using any two methods
@@ -35,11 +37,11 @@ int main(int argc, const char **argv)
                 glClear( GL_COLOR_BUFFER_BIT );
 
                 // Use our shader
-                glUseProgram(programID);
+                GGLState.UseProgram(programID);
 
                 // Bind our texture in Texture Unit 0
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, Texture);
+                GGLState.ActiveTexture(GL_TEXTURE0);
+                GGLState.BindTexture(GL_TEXTURE_2D, Texture);
                 // Set our "myTextureSampler" sampler to user Texture Unit 0
                 glUniform1i(TextureID, 0);
 
@@ -68,7 +70,7 @@ int main(int argc, const char **argv)
 
         // Cleanup VBO
 //      glDeleteBuffers(1, &vertexbuffer);
-        glDeleteProgram(programID);
-        glDeleteTextures(1, &TextureID);
+        GGLState.DeleteProgram(programID);
+        deleteTexture(Texture);
 }
 
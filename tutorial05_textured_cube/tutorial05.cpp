@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "../common/gpumemory.h"
+#include "embedded_shaders.h"
 #include "../common/texture.h"
 
 // Include GLM
@@ -16,12 +19,12 @@ int main(int argc, const char **argv)
         printf("Screen started\n");
 
         // Enable depth test
-        glEnable(GL_DEPTH_TEST);
+        GGLState.Enable(GL_DEPTH_TEST);
         // Accept fragment if it closer to the camera than the former one
-        glDepthFunc(GL_LESS); 
+        GGLState.DepthFunc(GL_LESS); 
 
         // Create and compile our GLSL program from the shaders
-        GLuint programID = LoadShaders( "transformvertshader.glsl", "texturefragshader.glsl" );
+        GLuint programID = LoadShaders( GEmbeddedShaders, "transformvertshader.glsl", "texturefragshader.glsl" );
         printf("Shaders loaded\n");
 
    // Get a handle for our "MVP" uniform
@@ -47,8 +50,10 @@ int main(int argc, const char **argv)
         // Our ModelViewProjection : multiplication of our 3 matrices
         glm::mat4 MVP        = Projection * View * Model; // Remember, matrix multiplication is the other way arou$
 
-        // Load the texture using any two methods
-        GLuint Texture = loadBMP_custom("uvtemplate.bmp");
+        // Load the texture using any two methods, the ETC1 one is built from the .bmp by etc1convert
+        GLuint Texture = loadETC1("uvtemplate.ktx");
+        if (!Texture)
+                Texture = loadBMP_custom("uvtemplate.bmp");
         //GLuint Texture =  loadDDS("uvtemplate.DDS"); //loadTGA_glfw("uvtemplate.tga"); 
 
         // Get a handle for our "myTextureSampler" uniform
@@ -137,15 +142,9 @@ int main(int argc, const char **argv)
 
    // Set the viewport 
 //   glViewport ( 0, 0, GScreenWidth, GScreenHeight );
-        GLuint vertexbuffer;
-        glGenBuffers(1, &vertexbuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
+        GLuint vertexbuffer = createBuffer(GL_ARRAY_BUFFER, g_vertex_buffer_data, sizeof(g_vertex_buffer_data));
 
-        GLuint uvbuffer;
-        glGenBuffers(1, &uvbuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_uv_buffer_data), g_uv_buffer_data, GL_STATIC_DRAW);
+        GLuint uvbuffer = createBuffer(GL_ARRAY_BUFFER, g_uv_buffer_data, sizeof(g_uv_buffer_data));
 
         do{
 
@@ -153,20 +152,20 @@ int main(int argc, const char **argv)
                 glClear( GL_COLOR_BUFFER_BIT| GL_DEPTH_BUFFER_BIT);
 
                 // Use our shader
-                glUseProgram(programID);
+                GGLState.UseProgram(programID);
 
                 // Send our transformation to the currently bound shader, 
                 // in the "MVP" uniform
                 glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
 
                 // Bind our texture in Texture Unit 0
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, Texture);
+                GGLState.ActiveTexture(GL_TEXTURE0);
+                GGLState.BindTexture(GL_TEXTURE_2D, Texture);
                 // Set our "myTextureSampler" sampler to user Texture Unit 0
                 glUniform1i(TextureID, 0);
                 // 1rst attribute buffer : vertices
-                glEnableVertexAttribArray(vertexPosition_modelspaceID);
-                glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+                GGLState.EnableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.BindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
                 glVertexAttribPointer(
                         vertexPosition_modelspaceID, //vertexPosition_modelspaceID, // The attribute we want to configure
                         3,                  // size
@@ -177,8 +176,8 @@ int main(int argc, const char **argv)
                 );
 
                 // 2nd attribute buffer : UVs
-                glEnableVertexAttribArray(vertexUVID);
-                glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
+                GGLState.EnableVertexAttribArray(vertexUVID);
+                GGLState.BindBuffer(GL_ARRAY_BUFFER, uvbuffer);
                 glVertexAttribPointer(
                         vertexUVID,               // The attribute we want to configure
                         2,                           // size
@@ -190,18 +189,18 @@ int main(int argc, const char **argv)
 
                 // Draw the triangle !
                 glDrawArrays(GL_TRIANGLES, 0, 12*3); // 3 indices starting at 0 -> 1 triangle
-                glDisableVertexAttribArray(vertexPosition_modelspaceID);
-                glDisableVertexAttribArray(vertexUVID);
+                GGLState.DisableVertexAttribArray(vertexPosition_modelspaceID);
+                GGLState.DisableVertexAttribArray(vertexUVID);
 
                 updateScreen();
         }
         while(1);
 
         // Cleanup VBO
-        glDeleteBuffers(1, &vertexbuffer);
-        glDeleteBuffers(1, &uvbuffer);
-        glDeleteProgram(programID);
-        glDeleteTextures(1, &TextureID);
+        deleteBuffer(vertexbuffer);
+        deleteBuffer(uvbuffer);
+        GGLState.DeleteProgram(programID);
+        deleteTexture(Texture);
 
 
 }
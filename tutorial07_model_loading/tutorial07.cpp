@@ -10,8 +10,11 @@ using namespace glm;
 #include <vector>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "embedded_shaders.h"
 #include "../common/texture.h"
 #include "../common/objloader.h"
+#include "../common/meshloader.h"
 
 int main( void )
 {
@@ -22,22 +25,24 @@ int main( void )
 	//glClearColor(0.0f, 0.0f, 0.4f, 0.0f);
 
 	// Enable depth test
-	glEnable(GL_DEPTH_TEST);
+	GGLState.Enable(GL_DEPTH_TEST);
 	// Accept fragment if it closer to the camera than the former one
-	glDepthFunc(GL_LESS); 
+	GGLState.DepthFunc(GL_LESS); 
 
 	// Cull triangles which normal is not towards the camera
-	glEnable(GL_CULL_FACE);
+	GGLState.Enable(GL_CULL_FACE);
 
 	// Create and compile our GLSL program from the shaders
-	GLuint programID = LoadShaders( "TransformVertexShader.glsl", "TextureFragmentShader.glsl" );
+	GLuint programID = LoadShaders( GEmbeddedShaders, "TransformVertexShader.glsl", "TextureFragmentShader.glsl" );
 
 	// Get a handle for our "MVP" uniform
 	GLuint MatrixID = glGetUniformLocation(programID, "MVP");
 
-	// Get a handle for our buffers
-	GLuint vertexPosition_modelspaceID = glGetAttribLocation(programID, "vertexPosition_modelspace");
-	GLuint vertexUVID = glGetAttribLocation(programID, "vertexUV");
+	// Describe our vertices (position, uv and normal interleaved in one buffer)
+	// and get a handle for the attributes we use, the normals are skipped over
+	VertexLayout layout;
+	describeMeshVertex(layout, "vertexPosition_modelspace", "vertexUV", NULL);
+	layout.Bind(programID);
 
     // Projection matrix : 45° Field of View, 4:3 ratio, display range : 0.1 unit <-> 100 units
     glm::mat4 Projection = glm::perspective(45.0f, 4.0f / 3.0f, 0.1f, 100.0f);
@@ -59,35 +64,29 @@ int main( void )
     glm::vec3 rotation = glm::vec3(0,0,0);
     glm::vec3 scale = glm::vec3(1,1,1);
 	
-	// Load the texture
-	GLuint Texture = loadBMP_custom("uvtemplate.bmp");
+	// Load the texture, compressed when the GPU takes ETC1
+	GLuint Texture = loadETC1("uvtemplate.ktx");
+	if (!Texture)
+		Texture = loadBMP_custom("uvtemplate.bmp");
 	
 	// Get a handle for our "myTextureSampler" uniform
 	GLuint TextureID  = glGetUniformLocation(programID, "myTextureSampler");
 
-	// Read our .obj file
-	std::vector<glm::vec3> vertices;
-	std::vector<glm::vec2> uvs;
-	std::vector<glm::vec3> normals; // Won't be used at the moment.
-	bool res = loadOBJ("suzanne.obj", vertices, uvs, normals);
+	// Read our .obj file (or its .mesh cache) into an interleaved VBO and an index buffer
+	MeshBuffers mesh;
+	bool res = loadMeshBuffers("suzanne.obj", mesh);
 
-	// Load it into a VBO
-	GLuint vertexbuffer;
-	glGenBuffers(1, &vertexbuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
-
-	GLuint uvbuffer;
-	glGenBuffers(1, &uvbuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-	glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), &uvs[0], GL_STATIC_DRAW);
+	// There is only the one mesh, so the attributes can be set up once, outside the loop.
+	// GLES2 has no vertex array objects, with more meshes this would move to before each draw.
+	layout.Enable(mesh.VertexBuffer);
+	GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ElementBuffer);
 
 	do{
 		// Clear the screen
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Use our shader
-		glUseProgram(programID);
+		GGLState.UseProgram(programID);
         
         // Rebuild the Model matrix
         rotation.y += 0.01f;
@@ -105,50 +104,28 @@ int main( void )
 		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
 
 		// Bind our texture in Texture Unit 0
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, Texture);
+		GGLState.ActiveTexture(GL_TEXTURE0);
+		GGLState.BindTexture(GL_TEXTURE_2D, Texture);
 		// Set our "myTextureSampler" sampler to user Texture Unit 0
 		glUniform1i(TextureID, 0);
 
-		// 1rst attribute buffer : vertices
-		glEnableVertexAttribArray(vertexPosition_modelspaceID);
-		glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-		glVertexAttribPointer(
-			vertexPosition_modelspaceID,  // The attribute we want to configure
-			3,                            // size
-			GL_FLOAT,                     // type
-			GL_FALSE,                     // normalized?
-			0,                            // stride
-			(void*)0                      // array buffer offset
-		);
-
-		// 2nd attribute buffer : UVs
-		glEnableVertexAttribArray(vertexUVID);
-		glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-		glVertexAttribPointer(
-			vertexUVID,                   // The attribute we want to configure
-			2,                            // size : U+V => 2
-			GL_FLOAT,                     // type
-			GL_FALSE,                     // normalized?
-			0,                            // stride
-			(void*)0                      // array buffer offset
-		);
-
 		// Draw the triangles !
-		glDrawArrays(GL_TRIANGLES, 0, vertices.size() );
-
-		glDisableVertexAttribArray(vertexPosition_modelspaceID);
-		glDisableVertexAttribArray(vertexUVID);
+		glDrawElements(
+			GL_TRIANGLES,      // mode
+			mesh.IndexCount,   // count
+			GL_UNSIGNED_SHORT, // type
+			(void*)0           // element array buffer offset
+		);
 
 		updateScreen();
 	}
 	while( 1 );
 
 	// Cleanup VBO and shader
-	glDeleteBuffers(1, &vertexbuffer);
-	glDeleteBuffers(1, &uvbuffer);
-	glDeleteProgram(programID);
-	glDeleteTextures(1, &TextureID);
+	layout.Disable();
+	deleteMeshBuffers(mesh);
+	GGLState.DeleteProgram(programID);
+	deleteTexture(Texture);
 
 	return 0;
 }
@@ -0,0 +1,80 @@
+// Same as TransformVertexShader.glsl, for meshes from loadQuantizedMeshBuffers.
+// The attributes arrive as normalized integers and are decoded here.
+
+// Input vertex data, different for all executions of this shader.
+attribute vec3 vertexPosition_modelspace;   // GL_SHORT, normalized to [-1,1]
+attribute vec2 vertexUV;                    // GL_UNSIGNED_SHORT, normalized to [0,1]
+attribute vec2 vertexNormal_modelspace;     // GL_BYTE x2, octahedral
+
+// Output data ; will be interpolated for each fragment.
+varying vec2 UV;
+varying vec3 Position_worldspace;
+varying vec3 Normal_cameraspace;
+varying vec3 EyeDirection_cameraspace;
+varying vec3 LightDirection_cameraspace;
+
+// Values that stay constant for the whole mesh.
+uniform mat4 MVP;
+uniform mat4 M;
+uniform vec3 LightPosition_worldspace;
+#ifdef PRECOMPUTED_MV
+// Multiplied once per draw on the CPU instead of for every vertex
+uniform mat4 MV;
+uniform mat3 NormalMatrix;                  // inverse transpose of MV, correct with scaling too
+uniform vec3 LightPosition_cameraspace;
+#else
+uniform mat4 V;
+#endif
+
+// Quantization of this mesh, see MeshQuantization
+uniform vec3 PositionScale;
+uniform vec3 PositionOffset;
+uniform vec2 UVScale;
+uniform vec2 UVOffset;
+
+// Unfolds an octahedral encoded normal
+vec3 decodeNormal(vec2 e){
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0) {
+		vec2 s = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+		n.xy = (1.0 - abs(e.yx)) * s;
+	}
+	return normalize(n);
+}
+
+void main(){
+
+vec3 position_modelspace = vertexPosition_modelspace * PositionScale + PositionOffset;
+vec3 normal_modelspace = decodeNormal(vertexNormal_modelspace);
+
+// Output position of the vertex, in clip space : MVP * position
+gl_Position = MVP * vec4(position_modelspace,1);
+
+// Position of the vertex, in worldspace : M * position
+Position_worldspace = (M * vec4(position_modelspace,1)).xyz;
+
+// Vector that goes from the vertex to the camera, in camera space.
+// In camera space, the camera is at the origin (0,0,0).
+#ifdef PRECOMPUTED_MV
+vec3 vertexPosition_cameraspace = ( MV * vec4(position_modelspace,1)).xyz;
+#else
+vec3 vertexPosition_cameraspace = ( V * M * vec4(position_modelspace,1)).xyz;
+#endif
+EyeDirection_cameraspace = vec3(0,0,0) - vertexPosition_cameraspace;
+
+// Vector that goes from the vertex to the light, in camera space. M is ommited because it's identity.
+#ifndef PRECOMPUTED_MV
+vec3 LightPosition_cameraspace = ( V * vec4(LightPosition_worldspace,1)).xyz;
+#endif
+LightDirection_cameraspace = LightPosition_cameraspace + EyeDirection_cameraspace;
+
+// Normal of the the vertex, in camera space
+#ifdef PRECOMPUTED_MV
+Normal_cameraspace = NormalMatrix * normal_modelspace;
+#else
+Normal_cameraspace = ( V * M * vec4(normal_modelspace,0)).xyz; // Only correct if ModelMatrix does not scale the model ! Use its inverse transpose if not.
+#endif
+
+// UV of the vertex. No special space for this one.
+UV = vertexUV * UVScale + UVOffset;
+}
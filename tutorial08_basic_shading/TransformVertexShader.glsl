@@ -12,9 +12,16 @@ varying vec3 LightDirection_cameraspace;
 
 // Values that stay constant for the whole mesh.
 uniform mat4 MVP;
-uniform mat4 V;
 uniform mat4 M;
 uniform vec3 LightPosition_worldspace;
+#ifdef PRECOMPUTED_MV
+// Multiplied once per draw on the CPU instead of for every vertex
+uniform mat4 MV;
+uniform mat3 NormalMatrix;                  // inverse transpose of MV, correct with scaling too
+uniform vec3 LightPosition_cameraspace;
+#else
+uniform mat4 V;
+#endif
 
 void main(){
 
@@ -26,15 +33,25 @@ Position_worldspace = (M * vec4(vertexPosition_modelspace,1)).xyz;
 
 // Vector that goes from the vertex to the camera, in camera space.
 // In camera space, the camera is at the origin (0,0,0).
+#ifdef PRECOMPUTED_MV
+vec3 vertexPosition_cameraspace = ( MV * vec4(vertexPosition_modelspace,1)).xyz;
+#else
 vec3 vertexPosition_cameraspace = ( V * M * vec4(vertexPosition_modelspace,1)).xyz;
+#endif
 EyeDirection_cameraspace = vec3(0,0,0) - vertexPosition_cameraspace;
 
 // Vector that goes from the vertex to the light, in camera space. M is ommited because it's identity.
+#ifndef PRECOMPUTED_MV
 vec3 LightPosition_cameraspace = ( V * vec4(LightPosition_worldspace,1)).xyz;
+#endif
 LightDirection_cameraspace = LightPosition_cameraspace + EyeDirection_cameraspace;
 
 // Normal of the the vertex, in camera space
+#ifdef PRECOMPUTED_MV
+Normal_cameraspace = NormalMatrix * vertexNormal_modelspace;
+#else
 Normal_cameraspace = ( V * M * vec4(vertexNormal_modelspace,0)).xyz; // Only correct if ModelMatrix does not scale the model ! Use its inverse transpose if not.
+#endif
 
 // UV of the vertex. No special space for this one.
 UV = vertexUV;
@@ -7,11 +7,44 @@ using namespace glm;
 // Include standard headers
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <vector>
 #include "../common/startScreen.h"
 #include "../common/LoadShaders.h"
+#include "../common/glstate.h"
+#include "embedded_shaders.h"
+#include "../common/programreflect.h"
 #include "../common/texture.h"
 #include "../common/objloader.h"
+#include "../common/meshloader.h"
+
+// 1 : 16 byte quantized vertices (see common/meshquantize.h), 0 : 32 byte float vertices
+#ifndef QUANTIZED_VERTICES
+#define QUANTIZED_VERTICES 0
+#endif
+
+// N : draw an N x N grid of models, each at the level of detail its size on screen needs,
+// and print triangles and milliseconds per frame. 0 : the one model at full detail
+#ifndef LOD_GRID
+#define LOD_GRID 0
+#endif
+// 1 : V * M, the normal matrix and the light in camera space worked out once per draw on
+// the CPU (the PRECOMPUTED_MV shader variant), 0 : per vertex in the shader
+#ifndef PRECOMPUTED_MV
+#define PRECOMPUTED_MV 1
+#endif
+
+#if LOD_GRID && QUANTIZED_VERTICES
+#error "the LOD chain is built from the float vertices, use LOD_GRID without QUANTIZED_VERTICES"
+#endif
+
+// MV and its normal matrix for the PRECOMPUTED_MV variant
+static void setModelView(ProgramReflection & uniforms, int mvID, int normalID, const glm::mat4 & MV)
+{
+glm::mat3 NormalMatrix = glm::transpose(glm::inverse(glm::mat3(MV)));
+uniforms.SetMat4(mvID, &MV[0][0]);
+uniforms.SetMat3(normalID, &NormalMatrix[0][0]);
+}
 
 int main( void )
 {
@@ -22,25 +55,47 @@ InitGraphics();
 // glClearColor(0.0f, 0.0f, 0.4f, 1.0f);
 
 // Enable depth test
-glEnable(GL_DEPTH_TEST);
+GGLState.Enable(GL_DEPTH_TEST);
 // Accept fragment if it closer to the camera than the former one
-glDepthFunc(GL_LESS);
+GGLState.DepthFunc(GL_LESS);
 
 // Cull triangles which normal is not towards the camera
-glEnable(GL_CULL_FACE);
-
-// Create and compile our GLSL program from the shaders
-GLuint programID = LoadShaders( "TransformVertexShader.glsl", "TextureFragmentShader.glsl" );
-
-// Get a handle for our "MVP" uniform
-GLuint MatrixID = glGetUniformLocation(programID, "MVP");
-GLuint ViewMatrixID = glGetUniformLocation(programID, "V");
-GLuint ModelMatrixID = glGetUniformLocation(programID, "M");
-
-// Get a handle for our buffers
-GLuint vertexPosition_modelspaceID = glGetAttribLocation(programID, "vertexPosition_modelspace");
-GLuint vertexUVID = glGetAttribLocation(programID, "vertexUV");
-GLuint vertexNormal_modelspaceID = glGetAttribLocation(programID, "vertexNormal_modelspace");
+GGLState.Enable(GL_CULL_FACE);
+
+// Create and compile our GLSL program from the shaders, with the features picked above
+ShaderVariants shaders;
+unsigned int precomputedMV = shaders.AddFeature("PRECOMPUTED_MV");
+#if QUANTIZED_VERTICES
+shaders.Load( GEmbeddedShaders, "QuantizedTransformVertexShader.glsl", "TextureFragmentShader.glsl" );
+#else
+shaders.Load( GEmbeddedShaders, "TransformVertexShader.glsl", "TextureFragmentShader.glsl" );
+#endif
+GfxProgram* program = shaders.Get( PRECOMPUTED_MV ? precomputedMV : 0 );
+if (!program)
+	return 1;
+GLuint programID = program->GetId();
+
+// The program's uniforms were listed once when it was made, the setters below skip
+// values it already holds
+ProgramReflection& uniforms = program->GetReflection();
+
+// Get a handle for our "MVP" uniform. A variant lacks some of these, their setters do nothing.
+int MatrixID = uniforms.FindUniform("MVP");
+int ViewMatrixID = uniforms.FindUniform("V");
+int ModelMatrixID = uniforms.FindUniform("M");
+int ModelViewMatrixID = uniforms.FindUniform("MV");
+int NormalMatrixID = uniforms.FindUniform("NormalMatrix");
+int LightCameraID = uniforms.FindUniform("LightPosition_cameraspace");
+
+// Describe our vertices (position, uv and normal interleaved in one buffer)
+// and get a handle for each attribute
+VertexLayout layout;
+#if QUANTIZED_VERTICES
+describeQuantizedVertex(layout, "vertexPosition_modelspace", "vertexUV", "vertexNormal_modelspace");
+#else
+describeMeshVertex(layout, "vertexPosition_modelspace", "vertexUV", "vertexNormal_modelspace");
+#endif
+layout.Bind(programID);
 
     // Projection matrix : 45° Field of View, 4:3 ratio, display range : 0.1 unit <-> 100 units
     glm::mat4 Projection = glm::perspective(45.0f, 4.0f / 3.0f, 0.1f, 100.0f);
@@ -62,44 +117,48 @@ GLuint vertexNormal_modelspaceID = glGetAttribLocation(programID, "vertexNormal_
     glm::vec3 rotation = glm::vec3(0,0,0);
     glm::vec3 scale = glm::vec3(1,1,1);
 
-// Load the texture
-GLuint Texture = loadBMP_custom("uvtemplate.bmp");
+// Load the texture, its mip chain is baked by tools/mipconvert
+GLuint Texture = loadKTX("uvtemplate.ktx");
+if (!Texture)
+	Texture = loadBMP_custom("uvtemplate.bmp");
 
 // Get a handle for our "myTextureSampler" uniform
-GLuint TextureID = glGetUniformLocation(programID, "myTextureSampler");
-
-// Read our .obj file
-std::vector<glm::vec3> vertices;
-std::vector<glm::vec2> uvs;
-std::vector<glm::vec3> normals;
-bool res = loadOBJ("suzanne.obj", vertices, uvs, normals);
-
-// Load it into a VBO
-GLuint vertexbuffer;
-glGenBuffers(1, &vertexbuffer);
-glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
-
-GLuint uvbuffer;
-glGenBuffers(1, &uvbuffer);
-glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), &uvs[0], GL_STATIC_DRAW);
-
-GLuint normalbuffer;
-glGenBuffers(1, &normalbuffer);
-glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
-glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), &normals[0], GL_STATIC_DRAW);
+int TextureID = uniforms.FindUniform("myTextureSampler");
+
+// Read our .obj file (or its .mesh cache) into an interleaved VBO and an index buffer
+MeshBuffers mesh;
+#if QUANTIZED_VERTICES
+MeshQuantization quantization;
+bool res = loadQuantizedMeshBuffers("suzanne.obj", mesh, quantization);
+// the decode parameters never change, set them once
+GGLState.UseProgram(programID);
+setQuantizationUniforms(uniforms, quantization);
+#elif LOD_GRID
+MeshLODChain lods;
+bool res = loadMeshLODBuffers("suzanne.obj", mesh, lods);
+unsigned int frames = 0;
+unsigned int triangles = 0;
+struct timespec lastReport;
+clock_gettime(CLOCK_MONOTONIC, &lastReport);
+#else
+bool res = loadMeshBuffers("suzanne.obj", mesh);
+#endif
+
+// There is only the one mesh, so the attributes can be set up once, outside the loop.
+// GLES2 has no vertex array objects, with more meshes this would move to before each draw.
+layout.Enable(mesh.VertexBuffer);
+GGLState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ElementBuffer);
 
 // Get a handle for our "LightPosition" uniform
-glUseProgram(programID);
-GLuint LightID = glGetUniformLocation(programID, "LightPosition_worldspace");
+GGLState.UseProgram(programID);
+int LightID = uniforms.FindUniform("LightPosition_worldspace");
 
 do{
 // Clear the screen
 glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 // Use our shader
-glUseProgram(programID);
+GGLState.UseProgram(programID);
         
         // Rebuild the Model matrix
         rotation.y += 0.01f;
@@ -114,72 +173,67 @@ Model = translationMatrix * rotationMatrix * scalingMatrix;
 
 // Send our transformation to the currently bound shader,
 // in the "MVP" uniform
-glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
-glUniformMatrix4fv(ModelMatrixID, 1, GL_FALSE, &Model[0][0]);
-glUniformMatrix4fv(ViewMatrixID, 1, GL_FALSE, &View[0][0]);
+uniforms.SetMat4(MatrixID, &MVP[0][0]);
+uniforms.SetMat4(ModelMatrixID, &Model[0][0]);
+uniforms.SetMat4(ViewMatrixID, &View[0][0]);
+setModelView(uniforms, ModelViewMatrixID, NormalMatrixID, View * Model);
 
 glm::vec3 lightPos = glm::vec3(4,4,4);
-glUniform3f(LightID, lightPos.x, lightPos.y, lightPos.z);
+uniforms.SetVec3(LightID, lightPos.x, lightPos.y, lightPos.z);
+glm::vec4 lightCamera = View * glm::vec4(lightPos, 1.0f);
+uniforms.SetVec3(LightCameraID, lightCamera.x, lightCamera.y, lightCamera.z);
 
 // Bind our texture in Texture Unit 0
-glActiveTexture(GL_TEXTURE0);
-glBindTexture(GL_TEXTURE_2D, Texture);
+GGLState.ActiveTexture(GL_TEXTURE0);
+GGLState.BindTexture(GL_TEXTURE_2D, Texture);
 // Set our "myTextureSampler" sampler to user Texture Unit 0
-glUniform1i(TextureID, 0);
-
-// 1rst attribute buffer : vertices
-glEnableVertexAttribArray(vertexPosition_modelspaceID);
-glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
-glVertexAttribPointer(
-vertexPosition_modelspaceID, // The attribute we want to configure
-3, // size
-GL_FLOAT, // type
-GL_FALSE, // normalized?
-0, // stride
-(void*)0 // array buffer offset
-);
-
-// 2nd attribute buffer : UVs
-glEnableVertexAttribArray(vertexUVID);
-glBindBuffer(GL_ARRAY_BUFFER, uvbuffer);
-glVertexAttribPointer(
-vertexUVID, // The attribute we want to configure
-2, // size : U+V => 2
-GL_FLOAT, // type
-GL_FALSE, // normalized?
-0, // stride
-(void*)0 // array buffer offset
-);
-
-// 3rd attribute buffer : normals
-glEnableVertexAttribArray(vertexNormal_modelspaceID);
-glBindBuffer(GL_ARRAY_BUFFER, normalbuffer);
-glVertexAttribPointer(
-vertexNormal_modelspaceID, // The attribute we want to configure
-3, // size
-GL_FLOAT, // type
-GL_FALSE, // normalized?
-0, // stride
-(void*)0 // array buffer offset
-);
+uniforms.SetInt(TextureID, 0);
 
+#if LOD_GRID
+// One model per grid cell, further back and to the left, each at its own level of detail
+for(int z = 0; z < LOD_GRID; z++)
+for(int x = 0; x < LOD_GRID; x++)
+{
+glm::mat4 InstanceModel = glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f * x, 0.0f, -3.0f * z)) * Model;
+glm::mat4 InstanceMVP = Projection * View * InstanceModel;
+const MeshLOD & lod = lods.Levels[ selectMeshLOD(lods, Projection, View * InstanceModel, (float)GScreenHeight) ];
+uniforms.SetMat4(MatrixID, &InstanceMVP[0][0]);
+uniforms.SetMat4(ModelMatrixID, &InstanceModel[0][0]);
+setModelView(uniforms, ModelViewMatrixID, NormalMatrixID, View * InstanceModel);
+glDrawElements(GL_TRIANGLES, lod.IndexCount, GL_UNSIGNED_SHORT, (void*)(lod.IndexOffset * sizeof(unsigned short)));
+triangles += lod.IndexCount / 3;
+}
+#else
 // Draw the triangles !
-glDrawArrays(GL_TRIANGLES, 0, vertices.size() );
-
-glDisableVertexAttribArray(vertexPosition_modelspaceID);
-glDisableVertexAttribArray(vertexUVID);
-glDisableVertexAttribArray(vertexNormal_modelspaceID);
+glDrawElements(
+GL_TRIANGLES, // mode
+mesh.IndexCount, // count
+GL_UNSIGNED_SHORT, // type
+(void*)0 // element array buffer offset
+);
+#endif
 
 updateScreen();
+
+#if LOD_GRID
+if( ++frames == 100 ){
+struct timespec now;
+clock_gettime(CLOCK_MONOTONIC, &now);
+double ms = ((now.tv_sec - lastReport.tv_sec) * 1000.0 + (now.tv_nsec - lastReport.tv_nsec) / 1000000.0) / frames;
+printf("%dx%d models: %u triangles, %.2f ms per frame\n", LOD_GRID, LOD_GRID, triangles / frames, ms);
+lastReport = now;
+frames = 0;
+triangles = 0;
+}
+#endif
 }
 while( 1 );
 
 // Cleanup VBO and shader
-glDeleteBuffers(1, &vertexbuffer);
-glDeleteBuffers(1, &uvbuffer);
-glDeleteBuffers(1, &normalbuffer);
-glDeleteProgram(programID);
-glDeleteTextures(1, &Texture);
+layout.Disable();
+deleteMeshBuffers(mesh);
+shaders.Release();
+deleteTexture(Texture);
 
 return 0;
 }